@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CACHING_PROPAGATION_LOSS_MODEL_H
+#define CACHING_PROPAGATION_LOSS_MODEL_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <ns3/propagation-loss-model.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup propagation
+ *
+ * \brief Remembers the receive power computed by another loss model
+ * for each pair of nodes which do not move.
+ *
+ * The wrapped model, set with the Model attribute, is evaluated once
+ * for each (transmitter, receiver) pair of mobility models, and its
+ * result is reused until either model changes course (which includes
+ * being moved with SetPosition) or the transmit power changes.  The
+ * pairs where either node has a non-zero velocity are not cached,
+ * since their loss changes without any course change.
+ *
+ * The mobility models are numbered as they are first seen, and the
+ * results are kept in a hash table indexed by the pair of numbers.
+ * A course change only bumps the generation of the model, which
+ * invalidates all of its pairs at once.
+ *
+ * Only the deterministic models, whose loss only depends on the
+ * positions of the nodes (such as LogDistancePropagationLossModel,
+ * OkumuraHataPropagationLossModel or HybridBuildingsPropagationLossModel),
+ * should be wrapped.  The stochastic models, such as
+ * NakagamiPropagationLossModel or JakesPropagationLossModel, must be
+ * chained after this model with SetNext, so that they are evaluated
+ * for every signal:
+ *
+ * \code
+ *   Ptr<CachingPropagationLossModel> loss = CreateObject<CachingPropagationLossModel> ();
+ *   loss->SetModel (CreateObject<LogDistancePropagationLossModel> ());
+ *   loss->SetNext (CreateObject<NakagamiPropagationLossModel> ());
+ * \endcode
+ */
+class CachingPropagationLossModel : public PropagationLossModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  CachingPropagationLossModel ();
+  virtual ~CachingPropagationLossModel ();
+
+  /**
+   * \param model the loss model whose results are cached; it may be
+   * the head of a chain of models.
+   */
+  void SetModel (Ptr<PropagationLossModel> model);
+  /**
+   * \return the loss model whose results are cached.
+   */
+  Ptr<PropagationLossModel> GetModel (void) const;
+
+  /**
+   * Forget all the cached results, for instance after the attributes
+   * of the wrapped model have been changed.
+   */
+  void Flush (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  CachingPropagationLossModel (const CachingPropagationLossModel &);
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  CachingPropagationLossModel &operator = (const CachingPropagationLossModel &);
+
+  virtual double DoCalcRxPower (double txPowerDbm,
+                                Ptr<MobilityModel> a,
+                                Ptr<MobilityModel> b) const;
+
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  /**
+   * \param mobility a mobility model.
+   * \return the number of the mobility model, which is registered
+   * the first time it is seen.
+   */
+  uint32_t GetNodeIndex (Ptr<MobilityModel> mobility) const;
+
+  /**
+   * Invalidate the cached results of a mobility model.
+   * \param mobility the mobility model which changed course.
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility) const;
+
+  /**
+   * Disconnect from the mobility models, and forget them.
+   */
+  void DoFlush (void) const;
+
+  /// A mobility model seen by the cache.
+  struct Node
+  {
+    Ptr<MobilityModel> mobility;  //!< the mobility model
+    uint32_t generation;          //!< the number of course changes of the model
+    bool moving;                  //!< true if the model has a non-zero velocity
+  };
+
+  /// A cached result.
+  struct Entry
+  {
+    uint32_t aGeneration;  //!< the generation of the transmitter
+    uint32_t bGeneration;  //!< the generation of the receiver
+    double txPowerDbm;     //!< the transmit power
+    double rxPowerDbm;     //!< the receive power computed by the model
+  };
+
+  Ptr<PropagationLossModel> m_model;  //!< the cached loss model
+  mutable std::vector<Node> m_nodes;  //!< the mobility models, by number
+  /// the number of each mobility model
+  mutable std::unordered_map<const MobilityModel *, uint32_t> m_nodeIndexes;
+  /// the cached results, by transmitter and receiver numbers
+  mutable std::unordered_map<uint64_t, Entry> m_entries;
+};
+
+} // namespace ns3
+
+#endif /* CACHING_PROPAGATION_LOSS_MODEL_H */
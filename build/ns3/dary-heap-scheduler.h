@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::DaryHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-aware 4-ary heap event scheduler
+ *
+ * This is an implicit heap in which every node has four children
+ * instead of two, which halves the depth of the heap compared to the
+ * HeapScheduler.
+ *
+ * The event timestamps are duplicated in a separate array whose
+ * storage is aligned on a cache line boundary and offset so that the
+ * four children of a node always share a single cache line: finding
+ * the smallest child then costs a single cache miss.  The full events
+ * are only looked at to break timestamp ties.
+ *
+ * Each event records its position in the heap through
+ * EventImpl::SetSchedulerIndex so that Remove does not have to search
+ * for the event: it runs in O(log n), like Insert and RemoveNext.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DaryHeapScheduler ();
+  /** Destructor. */
+  virtual ~DaryHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** The number of children of each node. */
+  static const std::size_t ARITY = 4;
+
+  /**
+   * Get the parent index of a given entry.
+   *
+   * \param [in] id The child index.
+   * \return The index of the parent of \p id.
+   */
+  inline std::size_t Parent (std::size_t id) const;
+  /**
+   * Get the first child of a given entry.
+   *
+   * \param [in] id The parent index.
+   * \returns The index of the first child.
+   */
+  inline std::size_t FirstChild (std::size_t id) const;
+  /**
+   * Compare (less than) an event with an item.
+   *
+   * \param [in] ev The event.
+   * \param [in] id The index of the item.
+   * \returns \c true if \c ev is earlier than the item.
+   */
+  inline bool IsLess (const Scheduler::Event &ev, std::size_t id) const;
+  /**
+   * Compare (less than) two items.
+   *
+   * \param [in] a The first item.
+   * \param [in] b The second item.
+   * \returns \c true if \c a < \c b
+   */
+  inline bool IsLessStrictly (std::size_t a, std::size_t b) const;
+  /**
+   * Store an event at some position and record it in the event.
+   *
+   * \param [in] id The position.
+   * \param [in] ev The event.
+   */
+  inline void Place (std::size_t id, const Scheduler::Event &ev);
+  /**
+   * Percolate an event up from a hole at some position.
+   *
+   * \param [in] start The position of the hole.
+   * \param [in] ev The event to store.
+   */
+  void BottomUp (std::size_t start, const Scheduler::Event &ev);
+  /**
+   * Percolate an event down from a hole at some position.
+   *
+   * \param [in] start The position of the hole.
+   * \param [in] ev The event to store.
+   */
+  void TopDown (std::size_t start, const Scheduler::Event &ev);
+  /** Double the capacity of the timestamp array. */
+  void Grow (void);
+
+  /** The event list, managed as a heap. */
+  std::vector<Scheduler::Event> m_heap;
+  /** The timestamps of the events in m_heap, at the same positions. */
+  uint64_t *m_ts;
+  /** The raw storage of m_ts. */
+  uint64_t *m_tsStorage;
+  /** The number of timestamps which fit in m_ts. */
+  std::size_t m_capacity;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
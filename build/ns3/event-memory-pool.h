@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_MEMORY_POOL_H
+#define EVENT_MEMORY_POOL_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventMemoryPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief A size-classed memory pool for the simulation events.
+ *
+ * Every EventImpl, including the closures built by MakeEvent, is
+ * allocated through Allocate.  When the calling thread has an attached
+ * pool, the small events are carved out of fixed-size slabs, one set
+ * of slabs per size class, and the blocks of the deleted events are
+ * kept on a free list of their size class to be recycled by the next
+ * events of the same size, without going through the global heap.
+ * The large events, and all the events allocated by a thread without
+ * a pool, come from the global heap.
+ *
+ * The simulator attaches its own pool to its main thread when it is
+ * created, and releases it when it is destroyed: the slabs are then
+ * returned to the heap all at once, as soon as the last event they
+ * hold has been deleted.
+ *
+ * A pool is not thread-safe: the events allocated from the pool must
+ * be deleted by the thread the pool is attached to.  This is why the
+ * pools are never attached when ns-3 is configured with --enable-mtp.
+ */
+class EventMemoryPool
+{
+public:
+  /** Constructor. */
+  EventMemoryPool ();
+
+  /**
+   * Allocate the memory of an event.
+   *
+   * \param [in] size The size of the event.
+   * \returns The event memory.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Free the memory of an event allocated with Allocate, possibly by
+   * a different pool.
+   *
+   * \param [in] p The event memory.
+   */
+  static void Deallocate (void *p);
+
+  /** Serve the allocations of the calling thread from this pool. */
+  void Attach (void);
+  /**
+   * Detach this pool from its thread and delete it, along with its
+   * slabs, as soon as none of its blocks is in use.
+   * The pool must not be used after this call.
+   */
+  void Release (void);
+
+  /**
+   * Get the number of event allocations served by the pool.
+   * \returns The number of allocations.
+   */
+  uint64_t GetAllocations (void) const;
+  /**
+   * Get the number of allocations which recycled the block of a
+   * deleted event.
+   * \returns The number of pool hits.
+   */
+  uint64_t GetHits (void) const;
+
+private:
+  /** Destructor, see Release. */
+  ~EventMemoryPool ();
+  /**
+   * Copy constructor, not implemented.
+   * \param [in] o The object to copy.
+   */
+  EventMemoryPool (const EventMemoryPool &o);
+  /**
+   * Assignment operator, not implemented.
+   * \param [in] o The object to copy.
+   * \returns This object.
+   */
+  EventMemoryPool & operator = (const EventMemoryPool &o);
+
+  /**
+   * Allocate a block from this pool.
+   *
+   * \param [in] size The size of the block, including its header.
+   * \returns The block.
+   */
+  void * DoAllocate (std::size_t size);
+  /**
+   * Put a block back on the free list of its size class.
+   *
+   * \param [in] block The block.
+   * \param [in] sizeClass The size class of the block.
+   */
+  void DoDeallocate (void *block, uint32_t sizeClass);
+
+  /** A free block of a size class. */
+  struct FreeBlock
+  {
+    FreeBlock *next;  /**< The next free block. */
+  };
+  /** The blocks of a size class. */
+  struct SizeClass
+  {
+    FreeBlock *free;  /**< The free list. */
+    char *next;       /**< The next block never used in the current slab. */
+    char *end;        /**< The end of the current slab. */
+  };
+
+  /** The number of size classes. */
+  static const uint32_t SIZE_CLASSES = 16;
+
+  /** The size classes; class i holds blocks of (i + 1) * 16 bytes. */
+  SizeClass m_classes[SIZE_CLASSES];
+  /** The slabs allocated so far. */
+  std::vector<char *> m_slabs;
+  /** The number of blocks in use. */
+  uint64_t m_used;
+  /** \c true when the pool must be deleted with its last block. */
+  bool m_released;
+  /** The number of allocations served by the pool. */
+  uint64_t m_allocations;
+  /** The number of allocations which recycled a free block. */
+  uint64_t m_hits;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_MEMORY_POOL_H */
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 The Georgia Institute of Technology 
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Josh Pelkey <jpelkey@gatech.edu>
+ */
+
+#ifndef IPV4_NIX_VECTOR_HELPER_H
+#define IPV4_NIX_VECTOR_HELPER_H
+
+#include "ns3/object-factory.h"
+#include "ns3/ipv4-routing-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief Helper class that adds Nix-vector routing to nodes.
+ *
+ * This class is expected to be used in conjunction with 
+ * ns3::InternetStackHelper::SetRoutingHelper
+ *
+ */
+class Ipv4NixVectorHelper : public Ipv4RoutingHelper
+{
+public:
+  /**
+   * Construct an Ipv4NixVectorHelper to make life easier while adding Nix-vector
+   * routing to nodes.
+   */
+  Ipv4NixVectorHelper ();
+
+  /**
+   * \brief Construct an Ipv4NixVectorHelper from another previously 
+   * initialized instance (Copy Constructor).
+   */
+  Ipv4NixVectorHelper (const Ipv4NixVectorHelper &);
+
+  /**
+   * \returns pointer to clone of this Ipv4NixVectorHelper 
+   * 
+   * This method is mainly for internal use by the other helpers;
+   * clients are expected to free the dynamic memory allocated by this method
+   */
+  Ipv4NixVectorHelper* Copy (void) const;
+
+  /**
+  * \param node the node on which the routing protocol will run
+  * \returns a newly-created routing protocol
+  *
+  * This method will be called by ns3::InternetStackHelper::Install
+  */
+  virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /**
+   * \brief Compute the paths of the nodes in advance, and keep them in a
+   * store shared by all the nodes instead of their caches.
+   *
+   * The paths are computed once per source node, as a tree of 4 bytes
+   * per node, and updated when the topology changes.  The trees of the
+   * first maxTrees nodes are computed by the given number of threads; the
+   * other ones are computed when needed, the tree used least recently
+   * being dropped to keep at most maxTrees of them.  This should be
+   * called after the addresses have been assigned.
+   *
+   * \param nThreads the number of threads computing the paths
+   * \param maxTrees the maximum number of trees kept, or 0 to keep the
+   * trees of all the nodes
+   */
+  static void PrecomputeNixVectors (uint32_t nThreads = 1, uint32_t maxTrees = 1024);
+
+private:
+  /**
+   * \brief Assignment operator declared private and not implemented to disallow
+   * assignment and prevent the compiler from happily inserting its own.
+   * \return Nothing useful.
+   */
+  Ipv4NixVectorHelper &operator = (const Ipv4NixVectorHelper &);
+
+  ObjectFactory m_agentFactory; //!< Object factory
+};
+} // namespace ns3
+
+#endif /* IPV4_NIX_VECTOR_HELPER_H */
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_NIX_VECTOR_STORE_H
+#define IPV4_NIX_VECTOR_STORE_H
+
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nix-vector.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief The paths of all the nodes, shared by their Ipv4NixVectorRouting.
+ *
+ * The store keeps, for a source node, the tree of the breadth-first
+ * search that Ipv4NixVectorRouting runs from this source, explored to
+ * the end instead of stopping at the destination: the path to a
+ * destination in the tree is the path found by the search to this
+ * destination, so that a single search per source gives the nix-vectors
+ * to all the destinations.  The tree is stored as the parent of each
+ * node, 4 bytes per node, the paths sharing their common hops, and the
+ * nix-vector of a packet is read from it hop by hop.
+ *
+ * At most a given number of trees are kept: when a tree is needed and
+ * the store is full, the tree used least recently is dropped.  The
+ * memory is thus bounded by 4 bytes per node and per kept tree, instead
+ * of growing with the square of the number of nodes.
+ *
+ * The searches run over a snapshot of the topology taken in the main
+ * thread, so that the first trees can be computed by several threads
+ * (see Precompute ()).  After a change of the topology, Update () takes
+ * a new snapshot, and only drops the trees which the change can affect:
+ * when links go down, the trees which did not use them are kept.
+ *
+ * The store is a SimulationSingleton, destroyed with the simulation.
+ */
+class Ipv4NixVectorStore
+{
+public:
+  Ipv4NixVectorStore ();
+  ~Ipv4NixVectorStore ();
+
+  /**
+   * \brief Enable the store and compute the trees of the first nodes.
+   *
+   * The trees of the first maxTrees nodes, or of all the nodes if there
+   * are fewer, are computed; the other ones are computed when needed.
+   *
+   * \param nThreads the number of threads running the searches
+   * \param maxTrees the maximum number of trees kept, or 0 to keep the
+   * trees of all the nodes
+   */
+  void Precompute (uint32_t nThreads, uint32_t maxTrees);
+
+  /**
+   * \returns true if the store is used by the Ipv4NixVectorRouting.
+   */
+  bool IsEnabled (void) const;
+
+  /**
+   * \brief Take a new snapshot of the topology, after a change, and drop
+   * the trees which the change can affect.
+   */
+  void Update (void);
+
+  /**
+   * \brief Get the nix-vector of a path, computing the tree of the
+   * source if it is not known.
+   * \param source the source node
+   * \param dest the destination address
+   * \returns the nix-vector, or 0 if there is no path to dest, or if
+   * dest is an address of the source
+   */
+  Ptr<NixVector> GetNixVector (Ptr<Node> source, Ipv4Address dest);
+
+  /**
+   * \returns the number of trees currently known.
+   */
+  uint32_t GetNTrees (void) const;
+
+private:
+  /// The topology, as seen by the breadth-first searches.
+  struct Graph
+  {
+    /// the neighbours of each node in search order, from m_start[i] to m_start[i + 1]
+    std::vector<uint32_t> m_neighbours;
+    std::vector<uint32_t> m_start; //!< the first neighbour of each node
+    /// the (neighbour, nix index) pairs of each node, sorted by neighbour, from m_nixStart[i] to m_nixStart[i + 1]
+    std::vector<std::pair<uint32_t, uint32_t> > m_nixIndexes;
+    std::vector<uint32_t> m_nixStart; //!< the first nix index of each node
+    std::vector<uint32_t> m_nixNeighbours; //!< the number of neighbours numbered by each node
+    /// the node of each address
+    std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_addresses;
+  };
+
+  /**
+   * \brief Take a snapshot of the topology.
+   * \param graph the snapshot
+   */
+  static void BuildGraph (Graph &graph);
+
+  /**
+   * \brief Run the breadth-first search from a source.
+   * \param source the index of the source node
+   */
+  void ComputeTree (uint32_t source);
+
+  /**
+   * \brief Compute the trees of the sources until there is none left.
+   * \param sources the sources
+   * \param next the index in sources of the next source to compute
+   */
+  void ComputeTrees (const std::vector<uint32_t> *sources, std::atomic<uint32_t> *next);
+
+  /**
+   * \brief Make room for a new tree, dropping the tree used least
+   * recently if the store is full.
+   */
+  void Evict (void);
+
+  /**
+   * \param tree a tree to check
+   * \param node a node whose neighbours changed
+   * \param oldNeighbours the neighbours of the node before the change
+   * \param newNeighbours the neighbours of the node after the change
+   * \returns true if the tree can be different after the change
+   */
+  static bool IsAffected (const std::vector<uint32_t> &tree, uint32_t node,
+                          const std::vector<uint32_t> &oldNeighbours,
+                          const std::vector<uint32_t> &newNeighbours);
+
+  bool m_enabled; //!< true if the store is used
+  Graph m_graph; //!< the current snapshot of the topology
+  /// the parent of each node, by source, or an empty vector if not known
+  std::vector<std::vector<uint32_t> > m_trees;
+  std::vector<uint64_t> m_lastUse; //!< when the tree of each source was last used
+  uint64_t m_uses; //!< the number of times a tree was used
+  uint32_t m_nTrees; //!< the number of trees known
+  uint32_t m_maxTrees; //!< the maximum number of trees known, or 0
+};
+
+} // namespace ns3
+
+#endif /* IPV4_NIX_VECTOR_STORE_H */
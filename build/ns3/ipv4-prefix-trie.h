@@ -0,0 +1,372 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of IPv4 prefixes.
+ *
+ * Each prefix of the trie, identified by a network address and a
+ * prefix length, holds a value of type T, typically the list of the
+ * routes to that prefix. The trie is used by the routing protocols
+ * as a forwarding index kept alongside their routing tables: Match
+ * returns the values of all the prefixes which contain an address in
+ * at most 32 steps, whatever the number of prefixes.
+ *
+ * The nodes which do not hold a value and have a single child are
+ * never kept, so that the trie has at most two nodes per prefix.
+ *
+ * The network masks are assumed to be contiguous: a prefix of length
+ * n only covers the n most significant bits of its network address.
+ *
+ * \tparam T \explicit The type of the values, which must be default
+ * constructible.
+ */
+template <typename T>
+class Ipv4PrefixTrie
+{
+public:
+  /** The maximum number of prefixes which can contain an address. */
+  static const uint32_t MAX_MATCHES = 33;
+
+  /** Constructor. */
+  Ipv4PrefixTrie ();
+  /** Destructor. */
+  ~Ipv4PrefixTrie ();
+
+  /**
+   * Get the value of a prefix, inserting the prefix with a default
+   * value if it is not in the trie yet.
+   *
+   * \param [in] network The network address of the prefix.
+   * \param [in] length The prefix length, from 0 to 32.
+   * \returns The value of the prefix.
+   */
+  T & Insert (Ipv4Address network, uint8_t length);
+  /**
+   * Find the value of a prefix.
+   *
+   * \param [in] network The network address of the prefix.
+   * \param [in] length The prefix length, from 0 to 32.
+   * \returns The value of the prefix, or 0 if the prefix is not in
+   * the trie.
+   */
+  T * Find (Ipv4Address network, uint8_t length) const;
+  /**
+   * Remove a prefix and its value.
+   *
+   * \param [in] network The network address of the prefix.
+   * \param [in] length The prefix length, from 0 to 32.
+   */
+  void Erase (Ipv4Address network, uint8_t length);
+  /** Remove all the prefixes. */
+  void Clear (void);
+  /**
+   * \returns \c true if the trie holds no prefix.
+   */
+  bool IsEmpty (void) const;
+
+  /**
+   * Find the prefixes which contain an address.
+   *
+   * \param [in] address The address.
+   * \param [out] matches The values of the matching prefixes, from the
+   * longest prefix to the shortest one.
+   * \returns The number of matching prefixes.
+   */
+  uint32_t Match (Ipv4Address address, T *matches[MAX_MATCHES]) const;
+
+private:
+  /**
+   * Copy constructor, not implemented.
+   * \param [in] o The object to copy.
+   */
+  Ipv4PrefixTrie (const Ipv4PrefixTrie &o);
+  /**
+   * Assignment operator, not implemented.
+   * \param [in] o The object to copy.
+   * \returns This object.
+   */
+  Ipv4PrefixTrie & operator = (const Ipv4PrefixTrie &o);
+
+  /** A node of the trie. */
+  struct Node
+  {
+    uint32_t prefix;   //!< The prefix bits, the other bits are zero.
+    uint8_t length;    //!< The prefix length.
+    bool hasValue;     //!< \c true if the node is a prefix of the trie.
+    T value;           //!< The value of the prefix.
+    Node *child[2];    //!< The subtries of the longer prefixes.
+  };
+
+  /**
+   * Create a node.
+   * \param [in] prefix The prefix bits.
+   * \param [in] length The prefix length.
+   * \returns The node.
+   */
+  static Node * CreateNode (uint32_t prefix, uint8_t length);
+  /**
+   * Delete a node and its subtries.
+   * \param [in] node The node.
+   */
+  static void DeleteNodes (Node *node);
+  /**
+   * \param [in] length A prefix length.
+   * \returns The mask of the prefix length.
+   */
+  static uint32_t GetMask (uint8_t length);
+  /**
+   * \param [in] bits The bits of an address.
+   * \param [in] index The index of a bit, from the most significant one.
+   * \returns The bit.
+   */
+  static uint32_t GetBit (uint32_t bits, uint8_t index);
+
+  Node *m_root;  //!< The root of the trie.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+Ipv4PrefixTrie<T>::Ipv4PrefixTrie ()
+  : m_root (0)
+{
+}
+
+template <typename T>
+Ipv4PrefixTrie<T>::~Ipv4PrefixTrie ()
+{
+  Clear ();
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::GetMask (uint8_t length)
+{
+  return (length == 0) ? 0 : 0xffffffff << (32 - length);
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::GetBit (uint32_t bits, uint8_t index)
+{
+  return (bits >> (31 - index)) & 0x1;
+}
+
+template <typename T>
+typename Ipv4PrefixTrie<T>::Node *
+Ipv4PrefixTrie<T>::CreateNode (uint32_t prefix, uint8_t length)
+{
+  Node *node = new Node ();
+  node->prefix = prefix;
+  node->length = length;
+  node->hasValue = false;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::DeleteNodes (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNodes (node->child[0]);
+      DeleteNodes (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T>
+T &
+Ipv4PrefixTrie<T>::Insert (Ipv4Address network, uint8_t length)
+{
+  NS_ASSERT (length <= 32);
+  uint32_t prefix = network.Get () & GetMask (length);
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = CreateNode (prefix, length);
+          node->hasValue = true;
+          *link = node;
+          return node->value;
+        }
+      // the length of the prefix common to node and the new prefix.
+      uint8_t common = 0;
+      uint8_t shortest = std::min (length, node->length);
+      while (common < shortest &&
+             GetBit (prefix, common) == GetBit (node->prefix, common))
+        {
+          common++;
+        }
+      if (common == node->length)
+        {
+          if (length == node->length)
+            {
+              node->hasValue = true;
+              return node->value;
+            }
+          // the new prefix is in the subtrie of node.
+          link = &node->child[GetBit (prefix, node->length)];
+          continue;
+        }
+      Node *inserted = CreateNode (prefix, length);
+      inserted->hasValue = true;
+      if (common == length)
+        {
+          // the new prefix contains the prefix of node.
+          inserted->child[GetBit (node->prefix, length)] = node;
+          *link = inserted;
+        }
+      else
+        {
+          // the prefixes diverge at bit common: branch there.
+          Node *branch = CreateNode (prefix & GetMask (common), common);
+          branch->child[GetBit (prefix, common)] = inserted;
+          branch->child[GetBit (node->prefix, common)] = node;
+          *link = branch;
+        }
+      return inserted->value;
+    }
+}
+
+template <typename T>
+T *
+Ipv4PrefixTrie<T>::Find (Ipv4Address network, uint8_t length) const
+{
+  NS_ASSERT (length <= 32);
+  uint32_t prefix = network.Get () & GetMask (length);
+  Node *node = m_root;
+  while (node != 0 && node->length <= length &&
+         (prefix & GetMask (node->length)) == node->prefix)
+    {
+      if (node->length == length)
+        {
+          return node->hasValue ? &node->value : 0;
+        }
+      node = node->child[GetBit (prefix, node->length)];
+    }
+  return 0;
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Erase (Ipv4Address network, uint8_t length)
+{
+  NS_ASSERT (length <= 32);
+  uint32_t prefix = network.Get () & GetMask (length);
+  // the links followed from the root to the node of the prefix.
+  Node **path[MAX_MATCHES + 1];
+  uint32_t depth = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length &&
+         (prefix & GetMask ((*link)->length)) == (*link)->prefix)
+    {
+      path[depth++] = link;
+      link = &(*link)->child[GetBit (prefix, (*link)->length)];
+    }
+  Node *node = *link;
+  if (node == 0 || node->length != length || node->prefix != prefix ||
+      !node->hasValue)
+    {
+      return;
+    }
+  node->hasValue = false;
+  node->value = T ();
+  path[depth++] = link;
+  // remove the nodes left without value and with less than two children.
+  while (depth > 0)
+    {
+      link = path[--depth];
+      node = *link;
+      if (node->hasValue || (node->child[0] != 0 && node->child[1] != 0))
+        {
+          break;
+        }
+      *link = (node->child[0] != 0) ? node->child[0] : node->child[1];
+      delete node;
+    }
+}
+
+template <typename T>
+void
+Ipv4PrefixTrie<T>::Clear (void)
+{
+  DeleteNodes (m_root);
+  m_root = 0;
+}
+
+template <typename T>
+bool
+Ipv4PrefixTrie<T>::IsEmpty (void) const
+{
+  return m_root == 0;
+}
+
+template <typename T>
+uint32_t
+Ipv4PrefixTrie<T>::Match (Ipv4Address address, T *matches[MAX_MATCHES]) const
+{
+  uint32_t bits = address.Get ();
+  uint32_t n = 0;
+  Node *node = m_root;
+  while (node != 0 && (bits & GetMask (node->length)) == node->prefix)
+    {
+      if (node->hasValue)
+        {
+          matches[n++] = &node->value;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[GetBit (bits, node->length)];
+    }
+  // longest prefix first.
+  for (uint32_t i = 0; i < n / 2; i++)
+    {
+      T *tmp = matches[i];
+      matches[i] = matches[n - 1 - i];
+      matches[n - 1 - i] = tmp;
+    }
+  return n;
+}
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
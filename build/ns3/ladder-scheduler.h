@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The events are spread across three tiers:
+ *  - Top: an unsorted array holding every event scheduled beyond
+ *    the range covered by the ladder.
+ *  - Ladder: a stack of rungs, each an array of buckets of identical
+ *    width.  Each rung covers a single bucket of the rung above it,
+ *    with a finer width.  Events in a bucket are not sorted.
+ *  - Bottom: a small sorted array holding the earliest events.
+ *
+ * When Bottom runs dry, the first non-empty bucket of the lowest rung
+ * is either sorted into Bottom or, if it holds more than Threshold
+ * events, spawned into a new, finer rung.  When the ladder runs dry,
+ * Top is spread into a new first rung whose width is derived from
+ * the span of the events it holds.  Every event is thus moved a bounded
+ * number of times, which gives O(1) amortized Insert and RemoveNext
+ * regardless of how the event times are distributed.
+ *
+ * Unlike the CalendarScheduler, buckets are contiguous arrays and
+ * the rungs and their buckets are recycled, so their storage is
+ * reused across ladder rebuilds.
+ *
+ * Remove is O(1) for events held in the ladder (the bucket is found
+ * from the timestamp), O(log n) for events held in Bottom, and linear
+ * in the size of Top for far-future events.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Ladder bucket type: an unsorted array of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    std::vector<Bucket> buckets; /**< Bucket storage, possibly larger than nBuckets. */
+    uint64_t start;              /**< Timestamp at the start of the first bucket. */
+    uint64_t width;              /**< Duration of a bucket, in dimensionless time units. */
+    uint32_t nBuckets;           /**< Number of buckets in use. */
+    uint32_t current;            /**< Index of the first bucket not yet dequeued. */
+    uint32_t nEvents;            /**< Number of events held by this rung. */
+  };
+
+  /**
+   * Get the start timestamp of the current bucket of a rung.
+   *
+   * Events with a timestamp at or above this value (and below the
+   * current bucket start of the rung above) belong to this rung.
+   *
+   * \param [in] rung The rung.
+   * \returns The dimensionless start time of the current bucket.
+   */
+  inline uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * Get the rung bucket matching a timestamp.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ts The dimensionless time.
+   * \returns The bucket index.
+   */
+  inline uint32_t BucketIndex (const Rung &rung, uint64_t ts) const;
+  /**
+   * Find the rung which should hold a timestamp below the Top threshold.
+   *
+   * \param [in] ts The dimensionless time.
+   * \returns The rung index, or m_nRungs if it belongs in Bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Push a new rung on the ladder, covering [start, end).
+   *
+   * \param [in] start The start of the range covered by the rung.
+   * \param [in] end The end of the range covered by the rung.
+   * \param [in] nEvents The number of events about to be stored.
+   * \returns The new rung.
+   */
+  Rung & SpawnRung (uint64_t start, uint64_t end, uint32_t nEvents);
+  /**
+   * Spread a set of events over the buckets of a rung.
+   *
+   * \param [in] rung The rung.
+   * \param [in] events The events to spread.
+   */
+  void Spread (Rung &rung, const Bucket &events);
+  /** Move every event in Top to a new rung, or straight to Bottom. */
+  void TransferTop (void);
+  /** Move Bottom to a new rung, if it has grown too large. */
+  void TransferBottom (void);
+  /**
+   * Sort a set of events into Bottom.
+   *
+   * \param [in] events The events to sort, Bottom must be empty.
+   */
+  void FillBottomFrom (const Bucket &events);
+  /** Make sure that Bottom holds the earliest event. */
+  void FillBottom (void);
+  /**
+   * Insert an event into Bottom, preserving its order.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Remove an event from an unsorted array.
+   *
+   * \param [in] bucket The array.
+   * \param [in] ev The event to remove.
+   * \returns \c true if the event was found.
+   */
+  bool RemoveFrom (Bucket &bucket, const Scheduler::Event &ev);
+
+  /** Top: unsorted far-future events. */
+  Bucket m_top;
+  /** Smallest timestamp held in Top (may be stale low after a Remove). */
+  uint64_t m_topMin;
+  /** Largest timestamp held in Top (may be stale high after a Remove). */
+  uint64_t m_topMax;
+  /** Events at or above this timestamp belong to Top. */
+  uint64_t m_topStart;
+  /** The ladder rungs; only the first m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Bottom: the earliest events, sorted in decreasing order. */
+  Bucket m_bottom;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+  /** Bucket size above which a bucket is spawned into a new rung. */
+  uint32_t m_threshold;
+  /** Maximum number of rungs. */
+  uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_RING_BUFFER_H
+#define MPSC_RING_BUFFER_H
+
+#include "assert.h"
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup thread
+ * ns3::MpscRingBuffer template declaration and implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup thread
+ * \brief A bounded, lock-free, multi-producer single-consumer queue.
+ *
+ * Any number of threads may Push items concurrently, while a single
+ * thread Pops them.  Neither side ever blocks or takes a lock: each
+ * slot of the ring carries a sequence number which tells whether it
+ * is free for the producers or ready for the consumer, so a producer
+ * only contends with the other producers, on a single atomic counter.
+ *
+ * The capacity is fixed at construction: Push fails, rather than
+ * blocking or allocating, when the ring is full.  The items pushed
+ * by a single thread are popped in the order they were pushed.
+ *
+ * \tparam T \explicit The type of the items; it must be copyable.
+ */
+template <typename T>
+class MpscRingBuffer
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] capacity The maximum number of items, a power of two.
+   */
+  explicit MpscRingBuffer (std::size_t capacity);
+  /** Destructor. */
+  ~MpscRingBuffer ();
+
+  /**
+   * Add an item at the back of the queue; may be called by any thread.
+   *
+   * \param [in] item The item.
+   * \returns \c false if the queue is full.
+   */
+  bool Push (const T &item);
+  /**
+   * Remove the item at the front of the queue; must only be called
+   * by the consumer thread.
+   *
+   * \param [out] item The item.
+   * \returns \c false if the queue is empty.
+   */
+  bool Pop (T &item);
+  /**
+   * Check whether an item is ready to be popped; must only be called
+   * by the consumer thread.
+   *
+   * \returns \c true if Pop would fail.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Get the capacity.
+   *
+   * \returns The maximum number of items in the queue.
+   */
+  std::size_t GetCapacity (void) const;
+
+private:
+  /** A slot of the ring. */
+  struct Cell
+  {
+    /**
+     * Equal to the push position when the slot is free, to the push
+     * position plus one when it holds an item.
+     */
+    std::atomic<std::size_t> sequence;
+    T item;                             /**< The item. */
+  };
+
+  /**
+   * Copy constructor, not implemented.
+   * \param [in] o The object to copy.
+   */
+  MpscRingBuffer (const MpscRingBuffer &o);
+  /**
+   * Assignment operator, not implemented.
+   * \param [in] o The object to copy.
+   * \returns This object.
+   */
+  MpscRingBuffer & operator = (const MpscRingBuffer &o);
+
+  /** The slots. */
+  Cell *m_cells;
+  /** The capacity minus one, to wrap the positions. */
+  std::size_t m_mask;
+  /** Padding to keep the producer and consumer positions apart. */
+  char m_pad0[64];
+  /** The next position to push to, shared by the producers. */
+  std::atomic<std::size_t> m_tail;
+  /** Padding to keep the producer and consumer positions apart. */
+  char m_pad1[64];
+  /** The next position to pop from, private to the consumer. */
+  std::size_t m_head;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscRingBuffer<T>::MpscRingBuffer (std::size_t capacity)
+  : m_cells (new Cell [capacity]),
+    m_mask (capacity - 1),
+    m_tail (0),
+    m_head (0)
+{
+  NS_ASSERT_MSG (capacity >= 2 && (capacity & (capacity - 1)) == 0,
+                 "MpscRingBuffer capacity must be a power of two");
+  for (std::size_t i = 0; i < capacity; ++i)
+    {
+      m_cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpscRingBuffer<T>::~MpscRingBuffer ()
+{
+  delete [] m_cells;
+  m_cells = 0;
+}
+
+template <typename T>
+bool
+MpscRingBuffer<T>::Push (const T &item)
+{
+  std::size_t pos = m_tail.load (std::memory_order_relaxed);
+  Cell *cell;
+  while (true)
+    {
+      cell = &m_cells[pos & m_mask];
+      std::size_t sequence = cell->sequence.load (std::memory_order_acquire);
+      intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+      if (diff == 0)
+        {
+          // the slot is free: try to claim it.
+          if (m_tail.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // the consumer has not freed this slot yet: full.
+          return false;
+        }
+      else
+        {
+          // another producer claimed the slot first.
+          pos = m_tail.load (std::memory_order_relaxed);
+        }
+    }
+  cell->item = item;
+  cell->sequence.store (pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool
+MpscRingBuffer<T>::Pop (T &item)
+{
+  Cell *cell = &m_cells[m_head & m_mask];
+  std::size_t sequence = cell->sequence.load (std::memory_order_acquire);
+  if (sequence != m_head + 1)
+    {
+      return false;
+    }
+  item = cell->item;
+  // free the slot for the push one lap ahead.
+  cell->sequence.store (m_head + m_mask + 1, std::memory_order_release);
+  m_head++;
+  return true;
+}
+
+template <typename T>
+bool
+MpscRingBuffer<T>::IsEmpty (void) const
+{
+  const Cell *cell = &m_cells[m_head & m_mask];
+  return cell->sequence.load (std::memory_order_acquire) != m_head + 1;
+}
+
+template <typename T>
+std::size_t
+MpscRingBuffer<T>::GetCapacity (void) const
+{
+  return m_mask + 1;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_RING_BUFFER_H */
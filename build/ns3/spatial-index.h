@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ * \brief A uniform grid of mobility models, to find the neighbors of
+ * a position without looking at every model.
+ *
+ * The channels use this index to skip the receivers which are out of
+ * the range of a transmitter.  The entries are numbered in the order
+ * they are added.  Each entry whose velocity was zero at its last
+ * course change is kept in the grid cell of its position.  The moving
+ * entries are kept in a second grid, in the cell of their position when
+ * they were placed, until they may have moved by one cell size: the
+ * lookups search that grid one cell size further, and the entries which
+ * have expired are placed again at the next lookup.  The entries without
+ * a mobility model are kept aside and returned by every lookup.  The
+ * index listens to the CourseChange trace of the models, and only moves
+ * the entries which have changed course at the next lookup.  A model
+ * must thus notify a course change whenever its speed increases.
+ *
+ * GetCandidates returns a superset of the entries in range: the caller
+ * is expected to check the distance of each of them.
+ */
+class SpatialIndex
+{
+public:
+  /**
+   * \param cellSize the length of the side of the grid cells, in meters.
+   */
+  SpatialIndex (double cellSize);
+  ~SpatialIndex ();
+
+  /**
+   * \param cellSize the length of the side of the grid cells, in meters.
+   *
+   * All the entries are placed again in the grid at the next lookup.
+   */
+  void SetCellSize (double cellSize);
+  /**
+   * \return the length of the side of the grid cells, in meters.
+   */
+  double GetCellSize (void) const;
+
+  /**
+   * \param mobility the mobility model of the new entry, or 0 if
+   * the entry must be returned by every lookup.
+   * \return the number of the entry, that is the number of entries
+   * added before it.
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \return the number of entries.
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Remove all the entries, and disconnect from their mobility models.
+   */
+  void Clear (void);
+
+  /**
+   * \param position the center of the search.
+   * \param range the distance of the search, in meters.
+   * \param candidates the numbers of the entries which may be within
+   * range of the position, in increasing order.
+   */
+  void GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates);
+
+private:
+  /**
+   * Copy constructor, not implemented.
+   * \param o the object to copy.
+   */
+  SpatialIndex (const SpatialIndex &o);
+  /**
+   * Assignment operator, not implemented.
+   * \param o the object to copy.
+   * \return this object.
+   */
+  SpatialIndex & operator = (const SpatialIndex &o);
+
+  /// The grid coordinates of a cell.
+  typedef int32_t CellCoordinate;
+  /// The key of a cell in the grid.
+  typedef uint64_t CellKey;
+  /// The entries of each cell of a grid.
+  typedef std::unordered_map<CellKey, std::vector<uint32_t> > Grid;
+  /// The expiry time of a moving entry, and its number.
+  typedef std::pair<Time, uint32_t> Expiry;
+
+  /// Where an entry is kept.
+  enum Location
+  {
+    OUTSIDE,       //!< kept aside, returned by every lookup.
+    STATIC_GRID,   //!< in m_cells.
+    MOVING_GRID    //!< in m_movingCells, until its expiry.
+  };
+
+  /// An entry of the index.
+  struct Entry
+  {
+    Ptr<MobilityModel> mobility;  //!< the mobility model, if any.
+    Location location;            //!< where the entry is kept.
+    bool dirty;                   //!< true if the entry must be placed again.
+    CellKey cell;                 //!< the cell of the entry, if in a grid.
+    Time expiry;                  //!< the time to place a moving entry again.
+  };
+
+  /**
+   * \param mobility the mobility model which changed course.
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
+  /**
+   * Place again the entries which changed course, and the moving
+   * entries which have expired.
+   */
+  void Update (void);
+  /**
+   * \param id the number of an entry to place in the grid or aside.
+   */
+  void Place (uint32_t id);
+  /**
+   * \param id the number of an entry to take out of the grid.
+   */
+  void Unplace (uint32_t id);
+  /**
+   * \param x a coordinate, in meters.
+   * \return the grid coordinate of the cell of x.
+   */
+  CellCoordinate GetCellCoordinate (double x) const;
+  /**
+   * \param x the grid coordinate along x.
+   * \param y the grid coordinate along y.
+   * \param z the grid coordinate along z.
+   * \return the key of the cell.
+   */
+  static CellKey GetCellKey (CellCoordinate x, CellCoordinate y, CellCoordinate z);
+  /**
+   * \param position the position.
+   * \return the key of the cell of the position.
+   */
+  CellKey GetCellKey (const Vector &position) const;
+  /**
+   * \param grid the grid to search.
+   * \param position the center of the search.
+   * \param range the distance of the search, in meters.
+   * \param candidates the vector to which the entries of the cells in
+   * range are appended.
+   */
+  void AddCandidates (const Grid &grid, const Vector &position, double range,
+                      std::vector<uint32_t> &candidates) const;
+
+  double m_cellSize;                          //!< the side of the cells.
+  std::vector<Entry> m_entries;               //!< the entries, by number.
+  Grid m_cells;                               //!< the static entries of each cell.
+  Grid m_movingCells;                         //!< the moving entries of each cell.
+  /// the expiry of the moving entries, the earliest first.
+  std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > m_expiries;
+  std::vector<uint32_t> m_outside;            //!< the entries kept aside.
+  std::vector<uint32_t> m_dirty;              //!< the entries to place again.
+  /// the entries of each mobility model.
+  std::multimap<const MobilityModel *, uint32_t> m_models;
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_INDEX_H */
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Network topology
+//
+//       n0 ----------- r ----------- n1
+//           10 Gbps        1 Gbps
+//            1 ms          10 ms
+//
+// - Bulk transfers from n0 to n1, with super-segments of up to tsoSegments
+//   segments (TcpSocketBase::TsoMaxSegments).
+// - With offload, both links send the super-segments as bursts of frames
+//   (PointToPointNetDevice::SegmentationOffload); otherwise, the super-segments
+//   are split into segments by Ipv4L3Protocol on n0.
+// - The goodput, the number of packets sent on the links (each super-segment
+//   counting as one) and the wall clock time of the simulation are reported.
+//
+// ./waf --run "tcp-segmentation-offload --tsoSegments=16 --offload=1"
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentationOffload");
+
+static uint64_t g_packetsSent = 0; //!< number of packets sent on the links
+
+/**
+ * Count a packet sent on a link.
+ * \param p the packet
+ */
+static void
+PhyTxEnd (Ptr<const Packet> p)
+{
+  g_packetsSent++;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t tsoSegments = 16;
+  bool offload = true;
+  uint32_t flows = 4;
+  double duration = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("tsoSegments", "Maximum number of segments of a super-segment (1 disables it)", tsoSegments);
+  cmd.AddValue ("offload", "Whether the links send the super-segments as bursts of frames", offload);
+  cmd.AddValue ("flows", "Number of bulk transfers", flows);
+  cmd.AddValue ("duration", "Simulated time (s)", duration);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocketBase::TsoMaxSegments", UintegerValue (tsoSegments));
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 22));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 22));
+  Config::SetDefault ("ns3::PointToPointNetDevice::SegmentationOffload", BooleanValue (offload));
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer accessDevices = access.Install (nodes.Get (0), nodes.Get (1));
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (nodes.Get (1), nodes.Get (2));
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (accessDevices);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (bottleneckDevices);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), 9));
+      source.SetAttribute ("MaxBytes", UintegerValue (0));
+      sources.Add (source.Install (nodes.Get (0)));
+    }
+  sources.Start (Seconds (0.0));
+
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  ApplicationContainer sink = sinkHelper.Install (nodes.Get (2));
+
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/PhyTxEnd",
+                                 MakeCallback (&PhyTxEnd));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t received = DynamicCast<PacketSink> (sink.Get (0))->GetTotalRx ();
+  std::cout << "goodput: " << received * 8 / duration / 1e6 << " Mbps" << std::endl;
+  std::cout << "packets sent on the links: " << g_packetsSent << std::endl;
+  std::cout << "wall clock time: " << elapsed << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
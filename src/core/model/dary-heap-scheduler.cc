@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "dary-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::DaryHeapScheduler class.
+ */
+
+namespace {
+
+/** Size of a cache line, in bytes. */
+const std::size_t CACHE_LINE = 64;
+
+} // unnamed namespace
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DaryHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (DaryHeapScheduler);
+
+TypeId
+DaryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DaryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<DaryHeapScheduler> ()
+  ;
+  return tid;
+}
+
+DaryHeapScheduler::DaryHeapScheduler ()
+  : m_ts (0),
+    m_tsStorage (0),
+    m_capacity (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+DaryHeapScheduler::~DaryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  delete [] m_tsStorage;
+  m_tsStorage = 0;
+  m_ts = 0;
+}
+
+std::size_t
+DaryHeapScheduler::Parent (std::size_t id) const
+{
+  return (id - 1) / ARITY;
+}
+
+std::size_t
+DaryHeapScheduler::FirstChild (std::size_t id) const
+{
+  return id * ARITY + 1;
+}
+
+bool
+DaryHeapScheduler::IsLess (const Scheduler::Event &ev, std::size_t id) const
+{
+  return ev.key.m_ts < m_ts[id]
+         || (ev.key.m_ts == m_ts[id] && ev.key.m_uid < m_heap[id].key.m_uid);
+}
+
+bool
+DaryHeapScheduler::IsLessStrictly (std::size_t a, std::size_t b) const
+{
+  return m_ts[a] < m_ts[b]
+         || (m_ts[a] == m_ts[b] && m_heap[a].key.m_uid < m_heap[b].key.m_uid);
+}
+
+void
+DaryHeapScheduler::Place (std::size_t id, const Scheduler::Event &ev)
+{
+  m_heap[id] = ev;
+  m_ts[id] = ev.key.m_ts;
+  ev.impl->SetSchedulerIndex (static_cast<uint32_t> (id));
+}
+
+void
+DaryHeapScheduler::Grow (void)
+{
+  NS_LOG_FUNCTION (this << m_capacity);
+  std::size_t capacity = std::max (m_capacity * 2, CACHE_LINE);
+  // Room for the alignment and for the offset of the root.
+  std::size_t padding = CACHE_LINE / sizeof (uint64_t) + ARITY - 1;
+  uint64_t *storage = new uint64_t [capacity + padding];
+  // Align the storage on a cache line, then shift it so that the
+  // children of each node, which start at index ARITY * id + 1,
+  // start on an ARITY-aligned slot.
+  uintptr_t address = reinterpret_cast<uintptr_t> (storage);
+  address = (address + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+  uint64_t *ts = reinterpret_cast<uint64_t *> (address) + ARITY - 1;
+  if (m_ts != 0)
+    {
+      std::memcpy (ts, m_ts, m_heap.size () * sizeof (uint64_t));
+    }
+  delete [] m_tsStorage;
+  m_tsStorage = storage;
+  m_ts = ts;
+  m_capacity = capacity;
+}
+
+bool
+DaryHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_heap.empty ();
+}
+
+void
+DaryHeapScheduler::BottomUp (std::size_t start, const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << start);
+  std::size_t index = start;
+  while (index > 0)
+    {
+      std::size_t parent = Parent (index);
+      if (!IsLess (ev, parent))
+        {
+          break;
+        }
+      Place (index, m_heap[parent]);
+      index = parent;
+    }
+  Place (index, ev);
+}
+
+void
+DaryHeapScheduler::TopDown (std::size_t start, const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << start);
+  std::size_t size = m_heap.size ();
+  std::size_t index = start;
+  while (true)
+    {
+      std::size_t first = FirstChild (index);
+      if (first >= size)
+        {
+          break;
+        }
+      std::size_t last = std::min (first + ARITY, size);
+      std::size_t smallest = first;
+      for (std::size_t child = first + 1; child < last; child++)
+        {
+          if (IsLessStrictly (child, smallest))
+            {
+              smallest = child;
+            }
+        }
+      if (IsLess (ev, smallest))
+        {
+          break;
+        }
+      Place (index, m_heap[smallest]);
+      index = smallest;
+    }
+  Place (index, ev);
+}
+
+void
+DaryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (m_heap.size () == m_capacity)
+    {
+      Grow ();
+    }
+  m_heap.push_back (ev);
+  BottomUp (m_heap.size () - 1, ev);
+}
+
+Scheduler::Event
+DaryHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_heap.front ();
+}
+
+Scheduler::Event
+DaryHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event next = m_heap.front ();
+  Scheduler::Event last = m_heap.back ();
+  m_heap.pop_back ();
+  if (!m_heap.empty ())
+    {
+      TopDown (0, last);
+    }
+  return next;
+}
+
+void
+DaryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  std::size_t index = ev.impl->GetSchedulerIndex ();
+  NS_ASSERT (index < m_heap.size ());
+  NS_ASSERT (m_heap[index].key.m_uid == ev.key.m_uid && m_heap[index].impl == ev.impl);
+  Scheduler::Event last = m_heap.back ();
+  m_heap.pop_back ();
+  if (index == m_heap.size ())
+    {
+      // the event was the last one.
+      return;
+    }
+  if (index > 0 && IsLess (last, Parent (index)))
+    {
+      BottomUp (index, last);
+    }
+  else
+    {
+      TopDown (index, last);
+    }
+}
+
+} // namespace ns3
@@ -46,6 +46,17 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+namespace {
+
+/**
+ * \ingroup simulator
+ * The number of events from a different context which can wait for
+ * the main thread without taking a lock.
+ */
+const std::size_t EVENTS_WITH_CONTEXT_RING_SIZE = 4096;
+
+} // unnamed namespace
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -58,6 +69,9 @@ DefaultSimulatorImpl::GetTypeId (void)
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl ()
+  : m_eventsWithContextRing (EVENTS_WITH_CONTEXT_RING_SIZE),
+    m_eventPoolAllocations (0),
+    m_eventPoolHits (0)
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
@@ -73,11 +87,18 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_eventPool = new EventMemoryPool ();
+  m_eventPool->Attach ();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_eventPool != 0)
+    {
+      m_eventPool->Release ();
+      m_eventPool = 0;
+    }
 }
 
 void
@@ -108,6 +129,17 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_eventPool != 0)
+    {
+      // the slabs go back to the heap along with the last pending event.
+      m_eventPoolAllocations = m_eventPool->GetAllocations ();
+      m_eventPoolHits = m_eventPool->GetHits ();
+      NS_LOG_INFO ("event pool hit rate " <<
+                   (m_eventPoolAllocations ? 100.0 * m_eventPoolHits / m_eventPoolAllocations : 0) <<
+                   "% of " << m_eventPoolAllocations << " allocations");
+      m_eventPool->Release ();
+      m_eventPool = 0;
+    }
 }
 
 void
@@ -158,9 +190,34 @@ DefaultSimulatorImpl::IsFinished (void) const
   return m_events->IsEmpty () || m_stop;
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  ev.key.m_ts = m_currentTs + event.timestamp;
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
+  // drain the ring in a single batch, but do not chase the producers
+  // forever: the rest waits for the next event.
+  EventWithContext event;
+  for (std::size_t i = 0; i < m_eventsWithContextRing.GetCapacity (); ++i)
+    {
+      if (!m_eventsWithContextRing.Pop (event))
+        {
+          break;
+        }
+      InsertEventWithContext (event);
+    }
+
   if (m_eventsWithContextEmpty)
     {
       return;
@@ -175,16 +232,8 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
   }
   while (!eventsWithContext.empty ())
     {
-       EventWithContext event = eventsWithContext.front ();
+       InsertEventWithContext (eventsWithContext.front ());
        eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
     }
 }
 
@@ -268,6 +317,11 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
+      if (m_eventsWithContextEmpty && m_eventsWithContextRing.Push (ev))
+        {
+          return;
+        }
+      // the ring is full, or was full a moment ago.
       {
         CriticalSection cs (m_eventsWithContextMutex);
         m_eventsWithContext.push_back(ev);
@@ -411,4 +465,16 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventPoolAllocations (void) const
+{
+  return m_eventPool != 0 ? m_eventPool->GetAllocations () : m_eventPoolAllocations;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetEventPoolHits (void) const
+{
+  return m_eventPool != 0 ? m_eventPool->GetHits () : m_eventPoolHits;
+}
+
 } // namespace ns3
@@ -26,9 +26,12 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "system-mutex.h"
+#include "mpsc-ring-buffer.h"
+#include "event-memory-pool.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -78,6 +81,21 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * Get the number of events allocated through the event memory pool
+   * of this simulator.
+   *
+   * \returns The number of event allocations.
+   */
+  uint64_t GetEventPoolAllocations (void) const;
+  /**
+   * Get the number of event allocations which recycled the memory of
+   * a deleted event, rather than going to the slabs or the heap.
+   *
+   * \returns The number of event pool hits.
+   */
+  uint64_t GetEventPoolHits (void) const;
+
 private:
   virtual void DoDispose (void);
 
@@ -95,15 +113,33 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Insert an event from a different context into the main event queue.
+   *
+   * \param [in] event The event.
+   */
+  void InsertEventWithContext (const EventWithContext &event);
+
+  /**
+   * The ring of events from a different context: other threads push
+   * events without taking any lock, and the main thread pops them.
+   */
+  MpscRingBuffer<struct EventWithContext> m_eventsWithContextRing;
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
+  /**
+   * The container of events from a different context which did not
+   * fit in m_eventsWithContextRing.
+   */
   EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * Flag \c true if all the events of m_eventsWithContext have been
+   * moved to the primary event queue.  While it is \c false, other
+   * threads keep adding to m_eventsWithContext rather than to the
+   * ring, so that the events which overflowed the ring are not
+   * overtaken by the next ones.
    */
-  bool m_eventsWithContextEmpty;
+  std::atomic<bool> m_eventsWithContextEmpty;
   /** Mutex to control access to the list of events with context. */
   SystemMutex m_eventsWithContextMutex;
 
@@ -132,6 +168,13 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The memory pool of the events, until Destroy. */
+  EventMemoryPool *m_eventPool;
+  /** The number of event pool allocations, as of Destroy. */
+  uint64_t m_eventPoolAllocations;
+  /** The number of event pool hits, as of Destroy. */
+  uint64_t m_eventPoolHits;
 };
 
 } // namespace ns3
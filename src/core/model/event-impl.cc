@@ -19,6 +19,7 @@
  */
 
 #include "event-impl.h"
+#include "event-memory-pool.h"
 #include "log.h"
 
 /**
@@ -37,7 +38,8 @@ EventImpl::~EventImpl ()
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_schedulerIndex (0),
+    m_cancel (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,4 +68,16 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return EventMemoryPool::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p)
+{
+  EventMemoryPool::Deallocate (p);
+}
+
 } // namespace ns3
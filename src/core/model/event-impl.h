@@ -20,6 +20,7 @@
 #ifndef EVENT_IMPL_H
 #define EVENT_IMPL_H
 
+#include <cstddef>
 #include <stdint.h>
 #include "simple-ref-count.h"
 
@@ -65,6 +66,35 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Record the position of this event in the event list.
+   *
+   * This is only meaningful to Scheduler implementations which
+   * record it, such as the DaryHeapScheduler, to find the event
+   * without searching for it.
+   *
+   * \param [in] index The position of the event.
+   */
+  inline void SetSchedulerIndex (uint32_t index);
+  /**
+   * \returns The position of this event in the event list, as last
+   *          recorded by SetSchedulerIndex().
+   */
+  inline uint32_t GetSchedulerIndex (void) const;
+
+  /**
+   * Allocate the memory of an event from the EventMemoryPool.
+   *
+   * \param [in] size The size of the event.
+   * \returns The event memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the memory of an event to the EventMemoryPool.
+   *
+   * \param [in] p The event memory.
+   */
+  static void operator delete (void *p);
 
 protected:
   /**
@@ -76,9 +106,22 @@ protected:
   virtual void Notify (void) = 0;
 
 private:
+  uint32_t m_schedulerIndex;  /**< Position in the event list. */
   bool m_cancel;  /**< Has this event been cancelled. */
 };
 
+void
+EventImpl::SetSchedulerIndex (uint32_t index)
+{
+  m_schedulerIndex = index;
+}
+
+uint32_t
+EventImpl::GetSchedulerIndex (void) const
+{
+  return m_schedulerIndex;
+}
+
 } // namespace ns3
 
 #endif /* EVENT_IMPL_H */
@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-memory-pool.h"
+#include "assert.h"
+#include "log.h"
+
+#include <new>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventMemoryPool implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventMemoryPool");
+
+namespace {
+
+/**
+ * \ingroup events
+ * The header in front of each event, aligned like any type.
+ */
+union BlockHeader
+{
+  struct
+  {
+    /** The pool of the block, or 0 if it comes from the heap. */
+    EventMemoryPool *pool;
+    /** The size class of the block in its pool. */
+    uint32_t sizeClass;
+  } info;                   /**< The block information. */
+  long double alignLong;    /**< Alignment for long double. */
+  void *alignPointer;       /**< Alignment for pointers. */
+  uint64_t alignInteger;    /**< Alignment for 64 bit integers. */
+};
+
+/** \ingroup events The granularity of the size classes. */
+const std::size_t SIZE_CLASS_STEP = 16;
+/** \ingroup events The size of a slab. */
+const std::size_t SLAB_SIZE = 16384;
+
+/**
+ * \ingroup events
+ * The pool attached to the calling thread, if any.
+ */
+thread_local EventMemoryPool *g_currentPool = 0;
+
+} // unnamed namespace
+
+
+EventMemoryPool::EventMemoryPool ()
+  : m_used (0),
+    m_released (false),
+    m_allocations (0),
+    m_hits (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < SIZE_CLASSES; ++i)
+    {
+      m_classes[i].free = 0;
+      m_classes[i].next = 0;
+      m_classes[i].end = 0;
+    }
+}
+
+EventMemoryPool::~EventMemoryPool ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_used == 0);
+  for (std::vector<char *>::iterator i = m_slabs.begin (); i != m_slabs.end (); ++i)
+    {
+      ::operator delete (*i);
+    }
+  m_slabs.clear ();
+}
+
+void *
+EventMemoryPool::Allocate (std::size_t size)
+{
+  std::size_t total = size + sizeof (BlockHeader);
+  EventMemoryPool *pool = g_currentPool;
+  BlockHeader *header;
+  if (pool != 0 && total <= SIZE_CLASSES * SIZE_CLASS_STEP)
+    {
+      header = static_cast<BlockHeader *> (pool->DoAllocate (total));
+    }
+  else
+    {
+      header = static_cast<BlockHeader *> (::operator new (total));
+      header->info.pool = 0;
+      if (pool != 0)
+        {
+          pool->m_allocations++;
+        }
+    }
+  return header + 1;
+}
+
+void
+EventMemoryPool::Deallocate (void *p)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  BlockHeader *header = static_cast<BlockHeader *> (p) - 1;
+  EventMemoryPool *pool = header->info.pool;
+  if (pool == 0)
+    {
+      ::operator delete (header);
+      return;
+    }
+  pool->DoDeallocate (header, header->info.sizeClass);
+}
+
+void *
+EventMemoryPool::DoAllocate (std::size_t size)
+{
+  uint32_t sizeClass = (size + SIZE_CLASS_STEP - 1) / SIZE_CLASS_STEP - 1;
+  SizeClass &c = m_classes[sizeClass];
+  BlockHeader *header;
+  m_allocations++;
+  m_used++;
+  if (c.free != 0)
+    {
+      m_hits++;
+      header = reinterpret_cast<BlockHeader *> (c.free);
+      c.free = c.free->next;
+    }
+  else
+    {
+      std::size_t blockSize = (sizeClass + 1) * SIZE_CLASS_STEP;
+      if (c.next + blockSize > c.end)
+        {
+          NS_LOG_LOGIC ("new slab for blocks of " << blockSize << " bytes");
+          char *slab = static_cast<char *> (::operator new (SLAB_SIZE));
+          m_slabs.push_back (slab);
+          c.next = slab;
+          c.end = slab + SLAB_SIZE;
+        }
+      header = reinterpret_cast<BlockHeader *> (c.next);
+      c.next += blockSize;
+    }
+  header->info.pool = this;
+  header->info.sizeClass = sizeClass;
+  return header;
+}
+
+void
+EventMemoryPool::DoDeallocate (void *block, uint32_t sizeClass)
+{
+  FreeBlock *freeBlock = static_cast<FreeBlock *> (block);
+  freeBlock->next = m_classes[sizeClass].free;
+  m_classes[sizeClass].free = freeBlock;
+  m_used--;
+  if (m_released && m_used == 0)
+    {
+      delete this;
+    }
+}
+
+void
+EventMemoryPool::Attach (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifndef NS3_MTP
+  g_currentPool = this;
+#endif
+}
+
+void
+EventMemoryPool::Release (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("allocations " << m_allocations << ", hits " << m_hits <<
+               ", slabs " << m_slabs.size () << ", blocks in use " << m_used);
+  if (g_currentPool == this)
+    {
+      g_currentPool = 0;
+    }
+  m_released = true;
+  if (m_used == 0)
+    {
+      delete this;
+    }
+}
+
+uint64_t
+EventMemoryPool::GetAllocations (void) const
+{
+  return m_allocations;
+}
+
+uint64_t
+EventMemoryPool::GetHits (void) const
+{
+  return m_hits;
+}
+
+} // namespace ns3
@@ -0,0 +1,390 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+#include "unused.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Compare (greater than) two events, to keep Bottom in decreasing order.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a > \c b
+ */
+bool
+EventGreater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("Threshold",
+                   "The number of events in a bucket above which the bucket "
+                   "is spread into a new, finer rung instead of being sorted.",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&LadderScheduler::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRungs",
+                   "The maximum number of rungs in the ladder.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&LadderScheduler::m_maxRungs),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (UINT64_MAX),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+uint32_t
+LadderScheduler::BucketIndex (const Rung &rung, uint64_t ts) const
+{
+  NS_ASSERT (ts >= rung.start);
+  uint64_t bucket = (ts - rung.start) / rung.width;
+  NS_ASSERT (bucket < rung.nBuckets);
+  return static_cast<uint32_t> (bucket);
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  NS_LOG_FUNCTION (this << ts);
+  // Each rung covers the part of the bucket it was spawned from which
+  // has not been dequeued yet, so the first rung whose current bucket
+  // starts at or before ts is the one holding it.
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= CurrentStart (m_rungs[i]))
+        {
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::SpawnRung (uint64_t start, uint64_t end, uint32_t nEvents)
+{
+  NS_LOG_FUNCTION (this << start << end << nEvents);
+  NS_ASSERT (end > start);
+  NS_ASSERT (nEvents > 0);
+  NS_ASSERT (m_nRungs < m_rungs.size ());
+
+  // aim at one event per bucket on average.
+  uint64_t span = end - start;
+  uint64_t width = std::max ((span + nEvents - 1) / nEvents, (uint64_t)1);
+  uint32_t nBuckets = static_cast<uint32_t> ((span + width - 1) / width);
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  rung.start = start;
+  rung.width = width;
+  rung.nBuckets = nBuckets;
+  rung.current = 0;
+  rung.nEvents = 0;
+  NS_LOG_LOGIC ("rung=" << m_nRungs - 1 << ", nBuckets=" << nBuckets << ", width=" << width);
+  return rung;
+}
+
+void
+LadderScheduler::Spread (Rung &rung, const Bucket &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[BucketIndex (rung, i->key.m_ts)].push_back (*i);
+    }
+  rung.nEvents += events.size ();
+}
+
+void
+LadderScheduler::FillBottomFrom (const Bucket &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  NS_ASSERT (m_bottom.empty ());
+  m_bottom.assign (events.begin (), events.end ());
+  // sort in decreasing order so that the earliest event sits at the back.
+  std::sort (m_bottom.begin (), m_bottom.end (), EventGreater);
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_nRungs == 0 && m_bottom.empty ());
+  NS_ASSERT (!m_top.empty ());
+
+  if (m_top.size () <= m_threshold || m_topMin == m_topMax)
+    {
+      FillBottomFrom (m_top);
+      m_topStart = m_topMax + 1;
+    }
+  else
+    {
+      Rung &rung = SpawnRung (m_topMin, m_topMax + 1, m_top.size ());
+      Spread (rung, m_top);
+      m_topStart = rung.start + rung.nBuckets * rung.width;
+    }
+  m_top.clear ();
+  m_topMin = UINT64_MAX;
+  m_topMax = 0;
+}
+
+void
+LadderScheduler::TransferBottom (void)
+{
+  NS_LOG_FUNCTION (this << m_bottom.size ());
+  if (m_bottom.size () <= m_threshold
+      || m_bottom.front ().key.m_ts == m_bottom.back ().key.m_ts)
+    {
+      return;
+    }
+  if (m_rungs.size () < m_maxRungs)
+    {
+      m_rungs.resize (m_maxRungs);
+    }
+  if (m_nRungs >= m_maxRungs)
+    {
+      return;
+    }
+  // the new rung must cover everything up to the rung above it so that
+  // later insertions below that rung still find a bucket.
+  uint64_t end = m_nRungs == 0 ? m_topStart : CurrentStart (m_rungs[m_nRungs - 1]);
+  Rung &rung = SpawnRung (m_bottom.back ().key.m_ts, end, m_bottom.size ());
+  Spread (rung, m_bottom);
+  m_bottom.clear ();
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_rungs.size () < m_maxRungs)
+    {
+      m_rungs.resize (m_maxRungs);
+    }
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          TransferTop ();
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.nEvents == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = CurrentStart (rung);
+      rung.current++;
+      rung.nEvents -= bucket.size ();
+      if (bucket.size () > m_threshold && rung.width > 1 && m_nRungs < m_maxRungs)
+        {
+          Rung &child = SpawnRung (bucketStart, bucketStart + rung.width, bucket.size ());
+          Spread (child, bucket);
+        }
+      else
+        {
+          FillBottomFrom (bucket);
+        }
+      bucket.clear ();
+    }
+}
+
+void
+LadderScheduler::InsertBottom (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  Bucket::iterator i = std::upper_bound (m_bottom.begin (), m_bottom.end (), ev,
+                                         EventGreater);
+  m_bottom.insert (i, ev);
+  TransferBottom ();
+}
+
+bool
+LadderScheduler::RemoveFrom (Bucket &bucket, const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << bucket.size ());
+  for (Bucket::iterator i = bucket.begin (); i != bucket.end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          // buckets are not sorted: fill the hole with the last event.
+          *i = bucket.back ();
+          bucket.pop_back ();
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          rung.buckets[BucketIndex (rung, ts)].push_back (ev);
+          rung.nEvents++;
+        }
+      else
+        {
+          InsertBottom (ev);
+        }
+    }
+  m_qSize++;
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // Moving events down the ladder does not change their order, so
+  // this is logically const.
+  const_cast<LadderScheduler *> (this)->FillBottom ();
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FillBottom ();
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      bool found = RemoveFrom (m_top, ev);
+      NS_ASSERT (found);
+      NS_UNUSED (found);
+      if (m_top.empty ())
+        {
+          m_topMin = UINT64_MAX;
+          m_topMax = 0;
+        }
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          bool found = RemoveFrom (rung.buckets[BucketIndex (rung, ts)], ev);
+          NS_ASSERT (found);
+          NS_UNUSED (found);
+          rung.nEvents--;
+        }
+      else
+        {
+          Bucket::iterator j = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev,
+                                                 EventGreater);
+          NS_ASSERT (j != m_bottom.end () && j->key.m_uid == ev.key.m_uid);
+          m_bottom.erase (j);
+        }
+    }
+  m_qSize--;
+}
+
+} // namespace ns3
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mpsc-ring-buffer.h"
+#include "ns3/system-thread.h"
+
+#include <list>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup thread-tests
+ * MpscRingBuffer test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup thread-tests
+ * Check the single-threaded behavior of MpscRingBuffer.
+ */
+class MpscRingBufferTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  MpscRingBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MpscRingBufferTestCase::MpscRingBufferTestCase ()
+  : TestCase ("Check push and pop on a single thread")
+{
+}
+
+void
+MpscRingBufferTestCase::DoRun (void)
+{
+  MpscRingBuffer<uint32_t> ring (8);
+  NS_TEST_ASSERT_MSG_EQ (ring.GetCapacity (), 8u, "Wrong capacity");
+  NS_TEST_ASSERT_MSG_EQ (ring.IsEmpty (), true, "New ring not empty");
+
+  uint32_t value = 0;
+  NS_TEST_ASSERT_MSG_EQ (ring.Pop (value), false, "Pop on an empty ring");
+
+  // go around the ring several times, with various fill levels.
+  uint32_t pushed = 0;
+  uint32_t popped = 0;
+  for (uint32_t lap = 0; lap < 10; ++lap)
+    {
+      for (uint32_t i = 0; i <= lap % 8; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (ring.Push (pushed), true, "Push failed");
+          pushed++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (ring.IsEmpty (), false, "Ring should not be empty");
+      while (ring.Pop (value))
+        {
+          NS_TEST_ASSERT_MSG_EQ (value, popped, "Items out of order");
+          popped++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (popped, pushed, "Items lost");
+      NS_TEST_ASSERT_MSG_EQ (ring.IsEmpty (), true, "Ring should be empty");
+    }
+
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring.Push (i), true, "Push failed");
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.Push (8), false, "Push on a full ring");
+  NS_TEST_ASSERT_MSG_EQ (ring.Pop (value), true, "Pop on a full ring failed");
+  NS_TEST_ASSERT_MSG_EQ (value, 0u, "Wrong item");
+  NS_TEST_ASSERT_MSG_EQ (ring.Push (8), true, "Push after a pop failed");
+  for (uint32_t i = 1; i <= 8; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring.Pop (value), true, "Pop failed");
+      NS_TEST_ASSERT_MSG_EQ (value, i, "Wrong item");
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.IsEmpty (), true, "Ring should be empty");
+}
+
+
+/**
+ * \ingroup thread-tests
+ * Check MpscRingBuffer with concurrent producers.
+ */
+class MpscRingBufferThreadsTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] producers The number of producer threads.
+   */
+  MpscRingBufferThreadsTestCase (uint32_t producers);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * The body of a producer thread.
+   *
+   * \param [in] context The test case and the producer index.
+   */
+  static void Produce (std::pair<MpscRingBufferThreadsTestCase *, uint32_t> context);
+
+  /** An item: the producer index and its sequence number. */
+  typedef std::pair<uint32_t, uint32_t> Item;
+
+  MpscRingBuffer<Item> m_ring;  //!< The ring under test.
+  uint32_t m_producers;         //!< The number of producer threads.
+  /** The number of items pushed by each producer. */
+  static const uint32_t ITEMS = 20000;
+};
+
+MpscRingBufferThreadsTestCase::MpscRingBufferThreadsTestCase (uint32_t producers)
+  : TestCase ("Check push and pop with " + std::to_string (producers) + " producer threads"),
+    m_ring (64),
+    m_producers (producers)
+{
+}
+
+void
+MpscRingBufferThreadsTestCase::Produce (std::pair<MpscRingBufferThreadsTestCase *, uint32_t> context)
+{
+  MpscRingBufferThreadsTestCase *me = context.first;
+  for (uint32_t i = 0; i < ITEMS; ++i)
+    {
+      while (!me->m_ring.Push (std::make_pair (context.second, i)))
+        {
+          // full: let the consumer run.
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MpscRingBufferThreadsTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_producers; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&MpscRingBufferThreadsTestCase::Produce,
+                                                                  std::make_pair (this, i))));
+    }
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Start ();
+    }
+
+  std::vector<uint32_t> next (m_producers, 0);
+  uint32_t errors = 0;
+  uint32_t popped = 0;
+  Item item;
+  while (popped < m_producers * ITEMS)
+    {
+      if (!m_ring.Pop (item))
+        {
+          std::this_thread::yield ();
+          continue;
+        }
+      popped++;
+      if (item.first >= m_producers || item.second != next[item.first])
+        {
+          errors++;
+          continue;
+        }
+      next[item.first]++;
+    }
+
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (errors, 0u, "Items lost, duplicated or out of order");
+  NS_TEST_ASSERT_MSG_EQ (m_ring.IsEmpty (), true, "Ring should be empty");
+}
+
+
+/**
+ * \ingroup thread-tests
+ * The MpscRingBuffer TestSuite.
+ */
+class MpscRingBufferTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  MpscRingBufferTestSuite ();
+};
+
+MpscRingBufferTestSuite::MpscRingBufferTestSuite ()
+  : TestSuite ("mpsc-ring-buffer", UNIT)
+{
+  AddTestCase (new MpscRingBufferTestCase (), TestCase::QUICK);
+  AddTestCase (new MpscRingBufferThreadsTestCase (1), TestCase::QUICK);
+  AddTestCase (new MpscRingBufferThreadsTestCase (4), TestCase::QUICK);
+}
+
+/**
+ * \ingroup thread-tests
+ * MpscRingBufferTestSuite instance variable.
+ */
+static MpscRingBufferTestSuite g_mpscRingBufferTestSuite;
+
+
+}  // namespace tests
+
+}  // namespace ns3
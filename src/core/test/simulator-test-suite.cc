@@ -23,6 +23,10 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -170,6 +174,124 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorEventOrderTestCase : public TestCase
+{
+public:
+  SimulatorEventOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+private:
+  uint32_t Random (void);
+  void ScheduleOne (void);
+  void Handle (uint32_t seq);
+  uint32_t m_state;
+  uint32_t m_toSchedule;
+  uint32_t m_executed;
+  uint32_t m_canceled;
+  Time m_last;
+  uint32_t m_lastSeq;
+  std::vector<Time> m_expected;
+  std::vector<EventId> m_ids;
+  std::vector<bool> m_isCanceled;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorEventOrderTestCase::SimulatorEventOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the event order over widely spread event times with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+uint32_t
+SimulatorEventOrderTestCase::Random (void)
+{
+  // a plain LCG: the same sequence for every scheduler.
+  m_state = m_state * 1664525 + 1013904223;
+  return m_state >> 8;
+}
+
+void
+SimulatorEventOrderTestCase::ScheduleOne (void)
+{
+  if (m_toSchedule == 0)
+    {
+      return;
+    }
+  m_toSchedule--;
+  Time delay;
+  switch (Random () % 4)
+    {
+    case 0:
+      // many events at the same time.
+      delay = NanoSeconds (Random () % 2);
+      break;
+    case 1:
+      delay = NanoSeconds (Random () % 1000);
+      break;
+    case 2:
+      delay = MicroSeconds (Random () % 1000);
+      break;
+    default:
+      delay = Seconds (Random () % 100);
+      break;
+    }
+  uint32_t seq = m_expected.size ();
+  m_expected.push_back (Simulator::Now () + delay);
+  m_isCanceled.push_back (false);
+  m_ids.push_back (Simulator::Schedule (delay, &SimulatorEventOrderTestCase::Handle, this, seq));
+}
+
+void
+SimulatorEventOrderTestCase::Handle (uint32_t seq)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_isCanceled[seq], false, "Canceled event " << seq << " did run");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), m_expected[seq], "Event " << seq << " ran at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ ((Simulator::Now () > m_last || seq > m_lastSeq), true,
+                         "Event " << seq << " ran out of order");
+  m_last = Simulator::Now ();
+  m_lastSeq = seq;
+  m_executed++;
+
+  ScheduleOne ();
+  ScheduleOne ();
+  // cancel or remove a pending event every now and then.
+  uint32_t victim = Random () % m_ids.size ();
+  uint32_t action = Random () % 8;
+  if (action < 2 && !m_ids[victim].IsExpired ())
+    {
+      m_isCanceled[victim] = true;
+      m_canceled++;
+      if (action == 0)
+        {
+          Simulator::Cancel (m_ids[victim]);
+        }
+      else
+        {
+          Simulator::Remove (m_ids[victim]);
+        }
+    }
+}
+
+void
+SimulatorEventOrderTestCase::DoRun (void)
+{
+  m_state = 1;
+  m_toSchedule = 20000;
+  m_executed = 0;
+  m_canceled = 0;
+  m_last = Seconds (-1);
+  m_lastSeq = 0;
+
+  Simulator::SetScheduler (m_schedulerFactory);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ScheduleOne ();
+    }
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_executed + m_canceled, m_expected.size (), "Some events were lost");
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -461,6 +583,60 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  void Chain (uint32_t left);
+  EventId m_pending;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the events recycle the memory of the event pool")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Chain (uint32_t left)
+{
+  if (left > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Chain, this, left - 1);
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not using the default simulator");
+  uint64_t allocations = impl->GetEventPoolAllocations ();
+  uint64_t hits = impl->GetEventPoolHits ();
+
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Chain, this, 1000);
+  // still pending when the simulator is destroyed.
+  m_pending = Simulator::Schedule (Seconds (10), &SimulatorEventPoolTestCase::Chain, this, 0);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  allocations = impl->GetEventPoolAllocations () - allocations;
+  hits = impl->GetEventPoolHits () - hits;
+#ifdef NS3_MTP
+  // the event pools are never attached with --enable-mtp.
+  NS_TEST_ASSERT_MSG_EQ (allocations, 0u, "Unexpected event pool allocations");
+#else
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (allocations, 1003u, "Missing event pool allocations");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (hits, 999u, "The events were not recycled");
+#endif
+
+  // the pending event outlives the simulator and its pool.
+  impl = 0;
+  NS_TEST_ASSERT_MSG_EQ (m_pending.PeekEventImpl ()->IsCancelled (), false, "Pending event should not be cancelled");
+  m_pending = EventId ();
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +653,22 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -188,7 +188,7 @@ CsmaChannel::TransmitStart (Ptr<const Packet> p, uint32_t srcId)
     }
 
   NS_LOG_LOGIC ("switch to TRANSMITTING");
-  m_currentPkt = p->Copy ();
+  m_currentPkt = p;
   m_currentSrc = srcId;
   m_state = TRANSMITTING;
   return true;
@@ -228,11 +228,12 @@ CsmaChannel::TransmitEnd ()
     {
       if (it->IsActive ())
         {
-          // schedule reception events
+          // schedule reception events; the receivers share the packet
+          // and only copy it if they need to change it
           Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
                                           m_delay,
                                           &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+                                          m_currentPkt, m_deviceList[m_currentSrc].devicePtr);
         }
       devId++;
     }
@@ -334,9 +334,10 @@ private:
   /**
    * The Packet that is currently being transmitted on the channel (or last
    * packet to have been transmitted on the channel if the channel is
-   * free.)
+   * free.)  It is shared, without a copy, by all the devices which
+   * receive it.
    */
-  Ptr<Packet> m_currentPkt;
+  Ptr<const Packet> m_currentPkt;
 
   /**
    * Device Id of the source that is currently transmitting on the
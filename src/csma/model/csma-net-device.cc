@@ -720,10 +720,10 @@ CsmaNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
 }
 
 void
-CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
+CsmaNetDevice::Receive (Ptr<const Packet> receivedPacket, Ptr<CsmaNetDevice> senderDevice)
 {
-  NS_LOG_FUNCTION (packet << senderDevice);
-  NS_LOG_LOGIC ("UID is " << packet->GetUid ());
+  NS_LOG_FUNCTION (receivedPacket << senderDevice);
+  NS_LOG_LOGIC ("UID is " << receivedPacket->GetUid ());
 
   //
   // We never forward up packets that we sent.  Real devices don't do this since
@@ -738,17 +738,23 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // Hit the trace hook.  This trace will fire on all packets received from the
   // channel except those originated by this device.
   //
-  m_phyRxEndTrace (packet);
+  m_phyRxEndTrace (receivedPacket);
 
   // 
   // Only receive if the send side of net device is enabled
   //
   if (IsReceiveEnabled () == false)
     {
-      m_phyRxDropTrace (packet);
+      m_phyRxDropTrace (receivedPacket);
       return;
     }
 
+  //
+  // The received packet is shared with the other devices on the channel,
+  // so we strip the headers off our own copy of it.
+  //
+  Ptr<Packet> packet = receivedPacket->Copy ();
+
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
     {
       NS_LOG_LOGIC ("Dropping pkt due to error model ");
@@ -758,9 +764,14 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
 
   //
   // Trace sinks will expect complete packets, not packets without some of the
-  // headers.
+  // headers.  Unless the error model has seen it, the shared packet is the
+  // complete packet.
   //
-  Ptr<Packet> originalPacket = packet->Copy ();
+  Ptr<const Packet> originalPacket = receivedPacket;
+  if (m_receiveErrorModel)
+    {
+      originalPacket = packet->Copy ();
+    }
 
   EthernetTrailer trailer;
   packet->RemoveTrailer (trailer);
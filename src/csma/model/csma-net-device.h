@@ -163,11 +163,15 @@ public:
    * used by the channel to indicate that the last bit of a packet has 
    * arrived at the device.
    *
+   * The packet is shared by all the devices attached to the channel:
+   * the device works on its own copy of the packet, which it only
+   * makes once it knows that it will process the packet.
+   *
    * \see CsmaChannel
    * \param p a reference to the received packet
    * \param sender the CsmaNetDevice that transmitted the packet in the first place
    */
-  void Receive (Ptr<Packet> p, Ptr<CsmaNetDevice> sender);
+  void Receive (Ptr<const Packet> p, Ptr<CsmaNetDevice> sender);
 
   /**
    * Is the send side of the network device enabled?
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the cost of the endpoint demultiplexing on a server with many
+ * open TCP connections.
+ *
+ * A client opens the connections to a PacketSink within 100 ms, and each
+ * connection sends its data at a low rate, so that all the connections are
+ * open at the same time.  Every segment received by the server or the client
+ * is demultiplexed among all the open connections.
+ *
+ * ./waf --run "tcp-many-connections-benchmark --connections=10000"
+ */
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t connections = 5000;
+  uint32_t bytes = 10000;
+  bool ipv6 = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("connections", "Number of TCP connections", connections);
+  cmd.AddValue ("bytes", "Number of bytes sent on each connection", bytes);
+  cmd.AddValue ("ipv6", "Use IPv6 instead of IPv4", ipv6);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1000));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  SimpleNetDeviceHelper link;
+  link.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  link.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  link.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("100000p"));
+  NetDeviceContainer devices = link.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  Address serverAddress;
+  Address anyAddress;
+  if (ipv6)
+    {
+      Ipv6AddressHelper address;
+      address.SetBase ("2001:1::", Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      serverAddress = Inet6SocketAddress (interfaces.GetAddress (1, 1), 80);
+      anyAddress = Inet6SocketAddress (Ipv6Address::GetAny (), 80);
+    }
+  else
+    {
+      Ipv4AddressHelper address;
+      address.SetBase ("10.1.1.0", "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      serverAddress = InetSocketAddress (interfaces.GetAddress (1), 80);
+      anyAddress = InetSocketAddress (Ipv4Address::GetAny (), 80);
+    }
+
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", anyAddress);
+  ApplicationContainer sink = sinkHelper.Install (nodes.Get (1));
+
+  OnOffHelper source ("ns3::TcpSocketFactory", serverAddress);
+  source.SetConstantRate (DataRate ("100kbps"), 1000);
+  source.SetAttribute ("MaxBytes", UintegerValue (bytes));
+  for (uint32_t i = 0; i < connections; i++)
+    {
+      ApplicationContainer app = source.Install (nodes.Get (0));
+      app.Start (MicroSeconds (100000.0 * i / connections));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  uint64_t received = DynamicCast<PacketSink> (sink.Get (0))->GetTotalRx ();
+  std::cout << "received: " << received << " bytes" << std::endl;
+  std::cout << "wall clock time: " << elapsed << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
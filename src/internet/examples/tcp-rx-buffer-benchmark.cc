@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Measure the cost of the TcpRxBuffer when the segments of a flow are
+ * sprayed over several paths of different delays, as with packet spraying
+ * over ECMP paths, so that they reach the receiver out of order.
+ *
+ * The segments are sent back to back, the segment i on the path i % paths,
+ * and are added to the buffer in the order of their arrival.  The
+ * application reads the available data every few segments.
+ *
+ * ./waf --run "tcp-rx-buffer-benchmark --segments=1000000 --maxPaths=64"
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/tcp-rx-buffer.h"
+
+using namespace ns3;
+
+/**
+ * Add the segments of a flow sprayed over several paths to a TcpRxBuffer.
+ * \param segments the number of segments
+ * \param segmentSize the size of the segments
+ * \param paths the number of paths
+ * \param readEvery the number of segments added between two reads
+ * \param sackBlocks the number of SACK blocks advertised
+ * \return the time taken (ms)
+ */
+int64_t
+Run (uint32_t segments, uint32_t segmentSize, uint32_t paths, uint32_t readEvery, uint64_t &sackBlocks)
+{
+  // the delay of each path, up to 200 segment transmission times more than
+  // the fastest one
+  Ptr<UniformRandomVariable> delay = CreateObject<UniformRandomVariable> ();
+  delay->SetStream (1);
+  std::vector<double> delays;
+  for (uint32_t i = 0; i < paths; i++)
+    {
+      delays.push_back (delay->GetValue (0, 200));
+    }
+  std::vector<std::pair<double, uint32_t> > arrivals;
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      arrivals.push_back (std::make_pair (i + delays[i % paths], i));
+    }
+  std::sort (arrivals.begin (), arrivals.end ());
+
+  // the packets are built beforehand, so that only the buffer is measured
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      packets.push_back (Create<Packet> (segmentSize));
+    }
+
+  TcpRxBuffer buffer;
+  buffer.SetNextRxSequence (SequenceNumber32 (1));
+  buffer.SetMaxBufferSize (1 << 30);
+  TcpHeader header;
+  uint64_t received = 0;
+  sackBlocks = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      uint32_t segment = arrivals[i].second;
+      header.SetSequenceNumber (SequenceNumber32 (1 + segment * segmentSize));
+      buffer.Add (packets[segment], header);
+      sackBlocks += buffer.GetSackList ().size ();
+      if (i % readEvery == 0)
+        {
+          Ptr<Packet> p = buffer.Extract (buffer.Available ());
+          received += p ? p->GetSize () : 0;
+        }
+    }
+  Ptr<Packet> p = buffer.Extract (buffer.Available ());
+  received += p ? p->GetSize () : 0;
+  int64_t elapsed = clock.End ();
+
+  NS_ABORT_MSG_UNLESS (received == static_cast<uint64_t> (segments) * segmentSize,
+                       "All the data should be received");
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t segments = 1000000;
+  uint32_t segmentSize = 1448;
+  uint32_t maxPaths = 64;
+  uint32_t readEvery = 16;
+
+  CommandLine cmd;
+  cmd.AddValue ("segments", "Number of segments of the flow", segments);
+  cmd.AddValue ("segmentSize", "Size of the segments (bytes)", segmentSize);
+  cmd.AddValue ("maxPaths", "Highest number of paths (1, 4, 16, ... up to maxPaths)", maxPaths);
+  cmd.AddValue ("readEvery", "Number of segments received between two reads", readEvery);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (8) << std::left << "paths"
+            << std::setw (12) << "time (ms)" << "SACK blocks" << std::endl;
+  for (uint32_t paths = 1; paths <= maxPaths; paths *= 4)
+    {
+      uint64_t sackBlocks;
+      int64_t elapsed = Run (segments, segmentSize, paths, readEvery, sackBlocks);
+      std::cout << std::setw (8) << paths
+                << std::setw (12) << elapsed << sackBlocks << std::endl;
+    }
+
+  return 0;
+}
@@ -84,6 +84,22 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes after a change of the topology, such as an
+   * interface brought down or up.
+   *
+   * The resulting routes are the ones of RecomputeRoutingTables(), which
+   * also removes the routes added by hand, but the shortest paths are
+   * only computed again for the nodes whose shortest-path tree the change
+   * can modify; the other nodes install their routes again from their
+   * tree.
+   *
+   * The trees are kept from the first update on, which computes all the
+   * routes again, as long as they fit in the
+   * "GlobalRoutingMaxSpfTreeMemory" global value (16 MiB by default); the
+   * nodes without a tree compute their routes again after any change.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
@@ -16,6 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <algorithm>
 #include <iostream>
 #include "ns3/log.h"
@@ -51,22 +52,26 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::Less);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_index (),
+    m_positions (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +99,12 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  Prioritize (c);
+  m_candidates.push_back (c);
+  m_index.insert (std::make_pair (vNew->GetVertexId (), vNew));
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +116,25 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  typedef std::unordered_multimap<Ipv4Address, SPFVertex *, Ipv4AddressHash>::iterator Iter_t;
+  std::pair<Iter_t, Iter_t> range = m_index.equal_range (v->GetVertexId ());
+  for (Iter_t i = range.first; i != range.second; i++)
+    {
+      if (i->second == v)
+        {
+          m_index.erase (i);
+          break;
+        }
+    }
+  m_positions.erase (v);
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +147,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,18 +168,20 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  typedef std::unordered_multimap<Ipv4Address, SPFVertex *, Ipv4AddressHash>::const_iterator CIter_t;
+  std::pair<CIter_t, CIter_t> range = m_index.equal_range (addr);
+  const Candidate *found = 0;
+  for (CIter_t i = range.first; i != range.second; i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      // the first one in the order of the queue
+      const Candidate &c = m_candidates[m_positions.find (i->second)->second];
+      if (found == 0 || Less (c, *found))
         {
-          return v;
+          found = &c;
         }
     }
 
-  return 0;
+  return found == 0 ? 0 : found->vertex;
 }
 
 void
@@ -164,11 +189,117 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // Sort the candidates in their current order, then by their new
+  // distance, keeping the current order between equal distances.
+  std::sort (m_candidates.begin (), m_candidates.end (), &CandidateQueue::Less);
+  std::vector<SPFVertex *> vertices;
+  vertices.reserve (m_candidates.size ());
+  for (CandidateList_t::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      vertices.push_back (i->vertex);
+    }
+  std::stable_sort (vertices.begin (), vertices.end (), &CandidateQueue::CompareSPFVertex);
+  // A sorted array is a heap.
+  for (uint32_t i = 0; i < vertices.size (); i++)
+    {
+      Candidate c;
+      c.vertex = vertices[i];
+      Prioritize (c);
+      Place (i, c);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::DecreaseKey (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::unordered_map<const SPFVertex *, uint32_t>::const_iterator it = m_positions.find (v);
+  NS_ASSERT_MSG (it != m_positions.end (), "CandidateQueue::DecreaseKey (): vertex not in the queue");
+  uint32_t index = it->second;
+  Candidate &c = m_candidates[index];
+  NS_ASSERT_MSG (v->GetDistanceFromRoot () <= c.distance,
+                 "CandidateQueue::DecreaseKey (): distance increased");
+  // The vertex now follows all the vertices at its new distance, as
+  // after a stable sort.
+  Prioritize (c);
+  SiftUp (index);
+}
+
+bool
+CandidateQueue::Less (const Candidate &c1, const Candidate &c2)
+{
+  if (c1.distance != c2.distance)
+    {
+      return c1.distance < c2.distance;
+    }
+  if (c1.network != c2.network)
+    {
+      return c1.network;
+    }
+  return c1.order < c2.order;
+}
+
+void
+CandidateQueue::Prioritize (Candidate &c)
+{
+  c.distance = c.vertex->GetDistanceFromRoot ();
+  c.network = c.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  c.order = m_order++;
+}
+
+void
+CandidateQueue::Place (uint32_t index, const Candidate &c)
+{
+  m_candidates[index] = c;
+  m_positions[c.vertex] = index;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t index)
+{
+  Candidate c = m_candidates[index];
+  while (index > 0)
+    {
+      uint32_t parent = (index - 1) / 2;
+      if (!Less (c, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (index, m_candidates[parent]);
+      index = parent;
+    }
+  Place (index, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t index)
+{
+  Candidate c = m_candidates[index];
+  uint32_t size = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * index + 1;
+      if (child >= size)
+        {
+          break;
+        }
+      if (child + 1 < size && Less (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!Less (m_candidates[child], c))
+        {
+          break;
+        }
+      Place (index, m_candidates[child]);
+      index = child;
+    }
+  Place (index, c);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,8 +46,15 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * requirement for a DecreaseKey () operation led us to implement this
+ * indexed binary heap.  The vertices are also indexed by vertex ID, so
+ * that Find () does not scan the queue, and the position of each vertex
+ * in the heap is kept up to date, so that a vertex whose distance has
+ * decreased can be moved up without reordering the whole queue.
+ *
+ * The vertices at the same distance, and of the same type, are popped in
+ * the order they were pushed (or their distance last decreased), as they
+ * would be from a sorted list.
  */
 class CandidateQueue
 {
@@ -154,6 +162,17 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Moves a vertex of the Candidate Queue up, after its distance
+ * from the root has decreased.
+ *
+ * This is equivalent to Reorder (), when only the distance of this vertex
+ * has changed, but it takes a time logarithmic in the size of the queue.
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance has decreased.
+ */
+  void DecreaseKey (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +203,55 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /// A vertex in the heap, with its priority.
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< the vertex
+    uint32_t distance;  //!< the distance of the vertex when it was last ordered
+    bool network;       //!< true if the vertex is a network vertex
+    uint64_t order;     //!< the order of the vertex among the ones at the same distance
+  };
+
+/**
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool Less (const Candidate &c1, const Candidate &c2);
+
+/**
+ * \brief Fill the priority of a candidate with the distance and type of
+ * its vertex, and a new order.
+ * \param c the candidate
+ */
+  void Prioritize (Candidate &c);
+
+/**
+ * \brief Store a candidate at a position of the heap.
+ * \param index the position in the heap
+ * \param c the candidate
+ */
+  void Place (uint32_t index, const Candidate &c);
+
+/**
+ * \brief Move the candidate at a position of the heap up to its place.
+ * \param index the position in the heap
+ */
+  void SiftUp (uint32_t index);
+
+/**
+ * \brief Move the candidate at a position of the heap down to its place.
+ * \param index the position in the heap
+ */
+  void SiftDown (uint32_t index);
+
+  typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  /// the candidates, by vertex ID
+  std::unordered_multimap<Ipv4Address, SPFVertex *, Ipv4AddressHash> m_index;
+  /// the position of each candidate in the heap
+  std::unordered_map<const SPFVertex *, uint32_t> m_positions;
+  uint64_t m_order;  //!< the order of the next vertex pushed
 
   /**
    * \brief Stream insertion operator.
@@ -24,12 +24,20 @@
 
 #include <utility>
 #include <vector>
+#include <set>
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif /* HAVE_PTHREAD_H */
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -44,6 +52,27 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/// The number of threads running the SPF calculations of InitializeRoutes.
+static GlobalValue g_spfThreads = GlobalValue ("GlobalRoutingSpfThreads",
+                                               "The number of threads computing the global routes "
+                                               "of the nodes concurrently.",
+                                               UintegerValue (1),
+                                               MakeUintegerChecker<uint32_t> (1));
+
+/// The largest memory taken by the shortest-path trees kept for UpdateRoutes.
+static GlobalValue g_spfTreeMemory = GlobalValue ("GlobalRoutingMaxSpfTreeMemory",
+                                                  "The largest memory, in bytes, taken by the "
+                                                  "shortest-path trees of the nodes kept to update the "
+                                                  "global routes after a topology change. The nodes "
+                                                  "without a tree compute their routes again after any "
+                                                  "change; 0 keeps no tree.",
+                                                  UintegerValue (16 * 1024 * 1024),
+                                                  MakeUintegerChecker<uint64_t> ());
+
+/// About the memory taken by each vertex of a kept shortest-path tree:
+/// its record, its index entry, a parent and a root exit direction.
+static const uint32_t SPF_TREE_VERTEX_MEMORY = 40;
+
 /**
  * \brief Stream insertion operator.
  *
@@ -423,7 +452,8 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
-    m_extdatabase ()
+    m_extdatabase (),
+    m_linkDataValid (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -471,6 +501,7 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
   else
     {
       m_database.insert (LSDBPair_t (addr, lsa));
+      m_linkDataValid = false;
     }
 }
 
@@ -488,6 +519,13 @@ GlobalRouteManagerLSDB::GetNumExtLSAs () const
   return m_extdatabase.size ();
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_database.size ();
+}
+
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 {
@@ -495,13 +533,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,26 +546,433 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of its transit network records.  The
+// index is built at the first lookup after an insertion; when several LSAs
+// have the same link data, the first one in the database is kept.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  if (!m_linkDataValid)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      m_linkData.clear ();
+      LSDBMap_t::const_iterator i;
+      for (i= m_database.begin (); i!= m_database.end (); i++)
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          GlobalRoutingLSA* temp = i->second;
+// Iterate among temp's Link Records
+          for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
             {
-              return temp;
+              GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  m_linkData.insert (std::make_pair (lr->GetLinkData (), temp));
+                }
             }
         }
+      m_linkDataValid = true;
+    }
+  LinkDataMap_t::const_iterator i = m_linkData.find (addr);
+  if (i != m_linkData.end ())
+    {
+      return i->second;
     }
   return 0;
 }
 
+GlobalRouteManagerLSDB*
+GlobalRouteManagerLSDB::Copy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB* lsdb = new GlobalRouteManagerLSDB ();
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsdb->m_database.insert (LSDBPair_t (i->first, new GlobalRoutingLSA (*i->second)));
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      lsdb->m_extdatabase.push_back (new GlobalRoutingLSA (*m_extdatabase[j]));
+    }
+  return lsdb;
+}
+
+/**
+ * \param a a Link State Advertisement
+ * \param b another Link State Advertisement
+ * \returns true if the SPF calculations can not tell a from b
+ */
+static bool
+IsSameLSA (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (j);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (j);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t j = 0; j < a->GetNAttachedRouters (); j++)
+    {
+      if (a->GetAttachedRouter (j) != b->GetAttachedRouter (j))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerLSDB::Diff (const GlobalRouteManagerLSDB* lsdb, std::set<Ipv4Address>& changed) const
+{
+  NS_LOG_FUNCTION (this << lsdb);
+  LSDBMap_t::const_iterator i = m_database.begin ();
+  LSDBMap_t::const_iterator j = lsdb->m_database.begin ();
+  while (i != m_database.end () || j != lsdb->m_database.end ())
+    {
+      if (j == lsdb->m_database.end () || (i != m_database.end () && i->first < j->first))
+        {
+          changed.insert (i->first);
+          i++;
+        }
+      else if (i == m_database.end () || j->first < i->first)
+        {
+          changed.insert (j->first);
+          j++;
+        }
+      else
+        {
+          if (!IsSameLSA (i->second, j->second))
+            {
+              changed.insert (i->first);
+            }
+          i++;
+          j++;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//
+// SPFTree Implementation
+//
+// ---------------------------------------------------------------------------
+
+SPFTree::SPFTree ()
+  : m_stub (false)
+{
+}
+
+void
+SPFTree::Clear (void)
+{
+  m_vertices.clear ();
+  m_parents.clear ();
+  m_exits.clear ();
+  m_index.clear ();
+  m_stub = false;
+}
+
+void
+SPFTree::Add (const SPFVertex* v)
+{
+  Vertex vertex;
+  vertex.id = v->GetVertexId ();
+  vertex.distance = v->GetDistanceFromRoot ();
+  vertex.parents = m_parents.size ();
+  vertex.exits = m_exits.size ();
+  m_vertices.push_back (vertex);
+  for (uint32_t i = 0; v->GetParent (i) != 0; i++)
+    {
+      m_parents.push_back (v->GetParent (i)->GetVertexId ());
+    }
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      m_exits.push_back (v->GetRootExitDirection (i));
+    }
+}
+
+void
+SPFTree::Index (void)
+{
+  m_index.clear ();
+  m_index.reserve (m_vertices.size ());
+  for (uint32_t i = 0; i < m_vertices.size (); i++)
+    {
+      m_index.push_back (std::make_pair (m_vertices[i].id, i));
+    }
+  std::sort (m_index.begin (), m_index.end ());
+}
+
+void
+SPFTree::SetStub (bool stub)
+{
+  m_stub = stub;
+}
+
+bool
+SPFTree::IsStub (void) const
+{
+  return m_stub;
+}
+
+uint32_t
+SPFTree::GetNVertices (void) const
+{
+  return m_vertices.size ();
+}
+
+uint32_t
+SPFTree::Find (Ipv4Address id) const
+{
+  std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator i =
+    std::lower_bound (m_index.begin (), m_index.end (), std::make_pair (id, uint32_t (0)));
+  if (i != m_index.end () && i->first == id)
+    {
+      return i->second;
+    }
+  return m_vertices.size ();
+}
+
+Ipv4Address
+SPFTree::GetVertexId (uint32_t i) const
+{
+  return m_vertices[i].id;
+}
+
+uint32_t
+SPFTree::GetDistanceFromRoot (uint32_t i) const
+{
+  return m_vertices[i].distance;
+}
+
+uint32_t
+SPFTree::GetNParents (uint32_t i) const
+{
+  uint32_t end = i + 1 < m_vertices.size () ? m_vertices[i + 1].parents : m_parents.size ();
+  return end - m_vertices[i].parents;
+}
+
+Ipv4Address
+SPFTree::GetParent (uint32_t i, uint32_t j) const
+{
+  return m_parents[m_vertices[i].parents + j];
+}
+
+bool
+SPFTree::HasParent (uint32_t i, Ipv4Address parent) const
+{
+  for (uint32_t j = 0; j < GetNParents (i); j++)
+    {
+      if (GetParent (i, j) == parent)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint32_t
+SPFTree::GetNRootExitDirections (uint32_t i) const
+{
+  uint32_t end = i + 1 < m_vertices.size () ? m_vertices[i + 1].exits : m_exits.size ();
+  return end - m_vertices[i].exits;
+}
+
+SPFVertex::NodeExit_t
+SPFTree::GetRootExitDirection (uint32_t i, uint32_t j) const
+{
+  return m_exits[m_vertices[i].exits + j];
+}
+
+/**
+ * @brief An edge of the link state graph, as followed by SPFNext.
+ */
+struct SPFEdge
+{
+  Ipv4Address target;   //!< the link state ID of the vertex the edge leads to
+  Ipv4Address linkData; //!< the link data of the record, or the attached router
+  uint32_t metric;      //!< the cost of the edge
+  uint32_t linkType;    //!< the type of the record, 0 for an attached router
+
+  /**
+   * @param o another edge
+   * @returns true if the edges are the same
+   */
+  bool operator== (const SPFEdge &o) const
+  {
+    return target == o.target && linkData == o.linkData && metric == o.metric && linkType == o.linkType;
+  }
+};
+
+/**
+ * @brief The edges of a vertex whose LSA changed, or which lead to a
+ * router whose transit records changed, before and after the change.
+ */
+struct SPFChange
+{
+  Ipv4Address id;      //!< the link state ID of the vertex
+  bool lsaChanged;     //!< true if the LSA of the vertex changed
+  bool vertexChanged;  //!< true if the LSA appeared, disappeared or changed of type
+  std::vector<SPFEdge> oldEdges; //!< the edges before the change
+  std::vector<SPFEdge> newEdges; //!< the edges after the change
+};
+
+/**
+ * @brief Get the edges followed by SPFNext from a vertex.
+ * @param lsdb the database of the LSA
+ * @param lsa the LSA of the vertex
+ * @param edges filled with the edges, in the order of SPFNext
+ */
+static void
+GetSPFEdges (const GlobalRouteManagerLSDB* lsdb, const GlobalRoutingLSA* lsa, std::vector<SPFEdge>& edges)
+{
+  if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+              || l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              SPFEdge edge = { l->GetLinkId (), l->GetLinkData (), l->GetMetric (), l->GetLinkType () };
+              edges.push_back (edge);
+            }
+        }
+    }
+  else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+    {
+      for (uint32_t i = 0; i < lsa->GetNAttachedRouters (); i++)
+        {
+          GlobalRoutingLSA *w_lsa = lsdb->GetLSAByLinkData (lsa->GetAttachedRouter (i));
+          if (w_lsa)
+            {
+              SPFEdge edge = { w_lsa->GetLinkStateId (), lsa->GetAttachedRouter (i), 0, 0 };
+              edges.push_back (edge);
+            }
+        }
+    }
+}
+
+/**
+ * @param edges some edges
+ * @param edge an edge
+ * @returns true if edge is one of edges
+ */
+static bool
+HasSPFEdge (const std::vector<SPFEdge>& edges, const SPFEdge& edge)
+{
+  return std::find (edges.begin (), edges.end (), edge) != edges.end ();
+}
+
+//
+// Tell whether the SPF calculation of a root can give another tree after a
+// change, from the tree of the previous calculation.  Following the
+// Dijkstra algorithm, the vertices join the tree in the same order, with
+// the same parents and root exit directions, unless:
+//  - the LSA of the root changed;
+//  - a vertex of the tree lost an edge to one of its children, which it
+//    was a parent of through this edge;
+//  - a vertex of the tree got an edge to a vertex out of the tree, or to a
+//    vertex of the tree which is not closer through another path;
+//  - the edges which a vertex of the tree kept are examined in another
+//    order, which can change the order between vertices at equal distance;
+//  - the LSA of a vertex whose root exit directions are computed from its
+//    LSA changed, that is, of a child of the root or of a child of a
+//    network attached to the root;
+//  - the LSA of a vertex of the tree disappeared or changed of type.
+// The changes of the vertices out of the tree do not matter: a new edge to
+// them comes from a vertex of the tree.
+//
+static bool
+IsSPFTreeTouched (Ipv4Address root, const SPFTree& tree, const std::vector<SPFChange>& changes,
+                  const GlobalRouteManagerLSDB* lsdb)
+{
+  uint32_t none = tree.GetNVertices ();
+  for (std::vector<SPFChange>::const_iterator c = changes.begin (); c != changes.end (); c++)
+    {
+      if (c->id == root)
+        {
+          return true;
+        }
+      uint32_t i = tree.Find (c->id);
+      if (i == none)
+        {
+          continue;
+        }
+      if (c->vertexChanged)
+        {
+          return true;
+        }
+      if (c->lsaChanged)
+        {
+          for (uint32_t j = 0; j < tree.GetNParents (i); j++)
+            {
+              Ipv4Address parent = tree.GetParent (i, j);
+              if (parent == root)
+                {
+                  return true;
+                }
+              GlobalRoutingLSA* parentLsa = lsdb->GetLSA (parent);
+              if ((parentLsa == 0 || parentLsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+                  && tree.HasParent (tree.Find (parent), root))
+                {
+                  return true;
+                }
+            }
+        }
+      uint32_t distance = tree.GetDistanceFromRoot (i);
+      std::vector<SPFEdge> oldKept;
+      for (std::vector<SPFEdge>::const_iterator e = c->oldEdges.begin (); e != c->oldEdges.end (); e++)
+        {
+          if (HasSPFEdge (c->newEdges, *e))
+            {
+              oldKept.push_back (*e);
+              continue;
+            }
+          uint32_t w = tree.Find (e->target);
+          if (w != none && distance + e->metric == tree.GetDistanceFromRoot (w)
+              && tree.HasParent (w, c->id))
+            {
+              return true;
+            }
+        }
+      std::vector<SPFEdge> newKept;
+      for (std::vector<SPFEdge>::const_iterator e = c->newEdges.begin (); e != c->newEdges.end (); e++)
+        {
+          if (HasSPFEdge (c->oldEdges, *e))
+            {
+              newKept.push_back (*e);
+              continue;
+            }
+          if (e->target == root)
+            {
+              continue;
+            }
+          uint32_t w = tree.Find (e->target);
+          if (w == none || distance + e->metric <= tree.GetDistanceFromRoot (w))
+            {
+              return true;
+            }
+        }
+      if (!(oldKept == newKept))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,7 +981,10 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_routesValid (false),
+    m_keepTrees (false),
+    m_spfTree (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -563,6 +1008,8 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  m_routesValid = false;
+  m_spfTrees.clear ();
 }
 
 void
@@ -578,19 +1025,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (node, router);
     }
   if (m_lsdb)
     {
@@ -598,6 +1033,27 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
       delete m_lsdb;
       m_lsdb = new GlobalRouteManagerLSDB ();
     }
+  m_routesValid = false;
+  m_spfTrees.clear ();
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node, Ptr<GlobalRouter> router)
+{
+  NS_LOG_FUNCTION (this << node << router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
 }
 
 //
@@ -613,6 +1069,7 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  m_routesValid = false;
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -659,6 +1116,135 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
     }
 }
 
+//
+// After a change, the LSAs are gathered again and compared with the ones of
+// the previous calculation.  The shortest-path tree of a root may have been
+// kept by the previous calculation; IsSPFTreeTouched tells from the tree and from
+// the edges of the changed vertices whether the Dijkstra algorithm could
+// build another tree.  Only these roots run the SPF calculation again.  The
+// routes of the other roots only depend on the tree, which did not change,
+// and on the LSAs of its vertices: they are installed again from the tree.
+// Every root deletes its routes first, as DeleteGlobalRoutes does, so that
+// the routes added by hand are removed as by a full recompute.  The roots
+// without a tree run the calculation again.
+//
+// The trees are only kept once UpdateRoutes was called, so that the
+// simulations which never update their routes do not pay for them: the
+// first update computes all the routes again.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  m_keepTrees = true;
+  if (!m_routesValid)
+    {
+      NS_LOG_LOGIC ("No routes to update, computing all of them");
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB* oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+
+  std::set<Ipv4Address> changed;
+  m_lsdb->Diff (oldLsdb, changed);
+  NS_LOG_LOGIC (changed.size () << " LSAs changed");
+//
+// The edges of a network to its routers are found through the transit
+// records of the routers: the networks named by the changed transit records
+// can have other edges too.
+//
+  std::set<Ipv4Address> vertices (changed);
+  for (std::set<Ipv4Address>::const_iterator i = changed.begin (); i != changed.end (); i++)
+    {
+      GlobalRoutingLSA* lsas[2] = { oldLsdb->GetLSA (*i), m_lsdb->GetLSA (*i) };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          if (lsas[k] == 0 || lsas[k]->GetLSType () != GlobalRoutingLSA::RouterLSA)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < lsas[k]->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsas[k]->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  vertices.insert (l->GetLinkId ());
+                }
+            }
+        }
+    }
+  std::vector<SPFChange> changes;
+  for (std::set<Ipv4Address>::const_iterator i = vertices.begin (); i != vertices.end (); i++)
+    {
+      GlobalRoutingLSA* oldLsa = oldLsdb->GetLSA (*i);
+      GlobalRoutingLSA* newLsa = m_lsdb->GetLSA (*i);
+      SPFChange change;
+      change.id = *i;
+      change.lsaChanged = changed.count (*i) > 0;
+      change.vertexChanged = oldLsa == 0 || newLsa == 0 || oldLsa->GetLSType () != newLsa->GetLSType ();
+      if (oldLsa)
+        {
+          GetSPFEdges (oldLsdb, oldLsa, change.oldEdges);
+        }
+      if (newLsa)
+        {
+          GetSPFEdges (m_lsdb, newLsa, change.newEdges);
+        }
+      changes.push_back (change);
+    }
+  delete oldLsdb;
+
+  std::vector<Ipv4Address> roots;
+  std::vector<Ipv4Address> installed;
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr || node->GetSystemId () != systemId)
+        {
+          continue;
+        }
+      Ipv4Address routerId = rtr->GetRouterId ();
+      DeleteRoutes (node, rtr);
+      SPFTreeMap_t::iterator tree = m_spfTrees.find (routerId);
+      if (tree != m_spfTrees.end () && !tree->second.IsStub ()
+          && !IsSPFTreeTouched (routerId, tree->second, changes, m_lsdb))
+        {
+          NS_LOG_LOGIC ("Installing the routes of node " << node->GetId () << " from its tree");
+          installed.push_back (routerId);
+          continue;
+        }
+      NS_LOG_LOGIC ("The tree of node " << node->GetId () << " can change");
+      if (tree != m_spfTrees.end ())
+        {
+          m_spfTrees.erase (tree);
+        }
+      if (rtr->GetNumLSAs ())
+        {
+          roots.push_back (routerId);
+        }
+    }
+
+  NS_LOG_INFO ("About to install the routes of " << installed.size () << " roots from their trees");
+  IndexRouters ();
+  for (uint32_t i = 0; i < installed.size (); i++)
+    {
+      SPFInstallTree (installed[i], m_spfTrees[installed[i]]);
+    }
+  m_routers.clear ();
+  NS_LOG_INFO ("About to update the SPF calculation of " << roots.size () << " roots");
+  CalculateRoutes (roots);
+  m_routesValid = true;
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
 //
 // For each node that is a global router (which is determined by the presence
 // of an aggregated GlobalRouter interface), run the Dijkstra SPF calculation
@@ -696,10 +1282,12 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  m_spfTrees.clear ();
 //
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<Ipv4Address> roots;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,10 +1312,137 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (rtr->GetRouterId ());
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  CalculateRoutes (roots);
+  m_routesValid = true;
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::CalculateRoutes (const std::vector<Ipv4Address> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  IndexRouters ();
+//
+// The calculations of the different roots only read the LSDB and each
+// writes the routes of its own root, so that they can run concurrently.
+// Each thread gets its own copy of the LSDB, whose status flags are
+// changed by the calculations.  Once UpdateRoutes was called, the trees of
+// the first roots are kept, as long as the trees fit in the
+// GlobalRoutingMaxSpfTreeMemory bound; a tree has a vertex per router and
+// network LSA.
+//
+  uint32_t nTrees = 0;
+  if (m_keepTrees)
+    {
+      UintegerValue maxMemory;
+      g_spfTreeMemory.GetValue (maxMemory);
+      uint64_t memory = 0;
+      for (SPFTreeMap_t::const_iterator i = m_spfTrees.begin (); i != m_spfTrees.end (); i++)
+        {
+          memory += static_cast<uint64_t> (i->second.GetNVertices ()) * SPF_TREE_VERTEX_MEMORY;
+        }
+      uint64_t treeMemory = static_cast<uint64_t> (std::max<uint32_t> (m_lsdb->GetNumLSAs (), 1)) * SPF_TREE_VERTEX_MEMORY;
+      if (maxMemory.Get () > memory)
+        {
+          nTrees = std::min<uint64_t> ((maxMemory.Get () - memory) / treeMemory, roots.size ());
+        }
+    }
+  std::vector<SPFTree> trees (nTrees);
+  UintegerValue spfThreads;
+  g_spfThreads.GetValue (spfThreads);
+  uint32_t nThreads = std::min<uint32_t> (spfThreads.Get (), roots.size ());
+#ifndef HAVE_PTHREAD_H
+  nThreads = 1;
+#endif /* HAVE_PTHREAD_H */
+  if (nThreads <= 1)
+    {
+      for (uint32_t i = 0; i < roots.size (); i++)
+        {
+          m_spfTree = i < trees.size () ? &trees[i] : 0;
+          SPFCalculate (roots[i]);
+        }
+      m_spfTree = 0;
+    }
+#ifdef HAVE_PTHREAD_H
+  else
+    {
+      NS_LOG_INFO ("Running SPF calculation of " << roots.size () << " roots in " << nThreads << " threads");
+      std::vector<GlobalRouteManagerImpl *> workers;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+          delete worker->m_lsdb;
+          worker->m_lsdb = m_lsdb->Copy ();
+          worker->m_routers = m_routers;
+          workers.push_back (worker);
+        }
+      std::atomic<uint32_t> next (0);
+      std::vector<std::thread> threads;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads.push_back (std::thread (&GlobalRouteManagerImpl::SPFCalculateRoots, workers[t], &roots,
+                                          &trees, &next));
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads[t].join ();
+          delete workers[t];
+        }
+    }
+#endif /* HAVE_PTHREAD_H */
+  m_routers.clear ();
+  for (uint32_t i = 0; i < trees.size (); i++)
+    {
+      m_spfTrees[roots[i]] = std::move (trees[i]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots (const std::vector<Ipv4Address> *roots, std::vector<SPFTree> *trees,
+                                           std::atomic<uint32_t> *next)
+{
+  NS_LOG_FUNCTION (this << roots << trees << next);
+  for (uint32_t i = (*next)++; i < roots->size (); i = (*next)++)
+    {
+      m_spfTree = i < trees->size () ? &(*trees)[i] : 0;
+      SPFCalculate ((*roots)[i]);
+    }
+  m_spfTree = 0;
+}
+
+void
+GlobalRouteManagerImpl::IndexRouters (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routers.clear ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr == 0)
+        {
+          NS_LOG_LOGIC ("No GlobalRouter interface on node " << (*i)->GetId ());
+          continue;
+        }
+      // the lookups used to walk the NodeList and stop at the first match
+      m_routers.insert (std::make_pair (rtr->GetRouterId (), *i));
+    }
+}
+
+Ptr<Node>
+GlobalRouteManagerImpl::GetRouterNode (Ipv4Address routerId) const
+{
+  NS_LOG_FUNCTION (this << routerId);
+  RouterMap_t::const_iterator i = m_routers.find (routerId);
+  if (i != m_routers.end ())
+    {
+      return i->second;
+    }
+  NS_LOG_LOGIC ("No node with router ID " << routerId);
+  return 0;
 }
 
 //
@@ -958,9 +1673,9 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
                 {
 //
 // If we've changed the cost to get to the vertex represented by <w>, we 
-// must reorder the priority queue keyed to that cost.
+// must move it up in the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.DecreaseKey (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,7 +1962,9 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  IndexRouters ();
   SPFCalculate (root);
+  m_routers.clear ();
 }
 
 //
@@ -1320,7 +2037,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
+                  Ptr<GlobalRouter> router = m_spfrootNode->GetObject<GlobalRouter> ();
                   NS_ASSERT (router);
                   Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
                   NS_ASSERT (gr);
@@ -1366,9 +2083,15 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+  m_spfrootNode = GetRouterNode (root);
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
+  if (m_spfTree)
+    {
+      m_spfTree->Clear ();
+      m_spfTree->Add (v);
+    }
 
 //
 // Optimize SPF calculation, for ns-3.
@@ -1377,10 +2100,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrootNode != 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (m_spfTree)
+        {
+          m_spfTree->SetStub (true);
+          m_spfTree->Index ();
+        }
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootNode = 0;
       return;
     }
 
@@ -1437,6 +2167,10 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // to now.
 //
       SPFVertexAddParent (v);
+      if (m_spfTree)
+        {
+          m_spfTree->Add (v);
+        }
 //
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
@@ -1485,6 +2219,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
     }  // end for loop
 
+  if (m_spfTree)
+    {
+      m_spfTree->Index ();
+    }
+  SPFProcessTree ();
+}
+
+void
+GlobalRouteManagerImpl::SPFProcessTree (void)
+{
+  NS_LOG_FUNCTION (this);
 // Second stage of SPF calculation procedure
   SPFProcessStubs (m_spfroot);
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
@@ -1502,6 +2247,65 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootNode = 0;
+}
+
+//
+// Replay the first stage of SPFCalculate from the kept tree: the vertices
+// join the tree in the same order, with the same distances, parents and
+// root exit directions, so that the routes are added in the same order.
+// The root exit directions and the parents of a vertex with several of
+// them are merged as in SPFNext.
+//
+void
+GlobalRouteManagerImpl::SPFInstallTree (Ipv4Address root, const SPFTree &tree)
+{
+  NS_LOG_FUNCTION (this << root);
+  NS_ASSERT (tree.GetNVertices () > 0 && tree.GetVertexId (0) == root);
+  std::vector<SPFVertex*> vertices;
+  m_spfroot = new SPFVertex (m_lsdb->GetLSA (root));
+  m_spfrootNode = GetRouterNode (root);
+  m_spfroot->SetDistanceFromRoot (0);
+  vertices.push_back (m_spfroot);
+  for (uint32_t i = 1; i < tree.GetNVertices (); i++)
+    {
+      SPFVertex* v = new SPFVertex (m_lsdb->GetLSA (tree.GetVertexId (i)));
+      v->SetDistanceFromRoot (tree.GetDistanceFromRoot (i));
+      for (uint32_t j = 0; j < tree.GetNRootExitDirections (i); j++)
+        {
+          if (j == 0)
+            {
+              v->SetRootExitDirection (tree.GetRootExitDirection (i, j));
+              continue;
+            }
+          SPFVertex exit;
+          exit.SetRootExitDirection (tree.GetRootExitDirection (i, j));
+          v->MergeRootExitDirections (&exit);
+        }
+      for (uint32_t j = 0; j < tree.GetNParents (i); j++)
+        {
+          SPFVertex* parent = vertices[tree.Find (tree.GetParent (i, j))];
+          if (j == 0)
+            {
+              v->SetParent (parent);
+              continue;
+            }
+          SPFVertex other;
+          other.SetParent (parent);
+          v->MergeParent (&other);
+        }
+      vertices.push_back (v);
+      SPFVertexAddParent (v);
+      if (v->GetVertexType () == SPFVertex::VertexRouter)
+        {
+          SPFIntraAddRouter (v);
+        }
+      else
+        {
+          SPFIntraAddTransit (v);
+        }
+    }
+  SPFProcessTree ();
 }
 
 void
@@ -1560,58 +2364,35 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node that has the router ID corresponding to the root vertex was
+// looked up when the calculation started.  This is the one we're going to
+// write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node != 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+      NS_ASSERT_MSG (v->GetLSA (), 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "Expected valid LSA in SPFVertex* v");
+      Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+      Ipv4Address tempip = extlsa->GetLinkStateId ();
+      tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2407,38 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          return;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all next-hop-IPs and out-going-interfaces for reaching
+      // the stub network gateway 'v' from the root node
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
             {
-              continue;
+              gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " add external network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " via interface " << outIf);
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+          else
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative");
             }
-          return;
-        } // if
-    } // for
+        }
+      return;
+    }
 }
 
 
@@ -1729,60 +2509,35 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node that has the router ID corresponding to the root vertex was
+// looked up when the calculation started.  This is the one we're going to
+// write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node != 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+      NS_ASSERT_MSG (v->GetLSA (), 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "Expected valid LSA in SPFVertex* v");
+      Ipv4Mask tempmask (l->GetLinkData ().Get ());
+      Ipv4Address tempip = l->GetLinkId ();
+      tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1797,39 +2552,38 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          return;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all next-hop-IPs and out-going-interfaces for reaching
+      // the stub network gateway 'v' from the root node
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
             {
-              continue;
+              gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " via interface " << outIf);
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+          else
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative");
             }
-          return;
-        } // if
-    } // for
+        }
+      return;
+    }
 }
 
 //
@@ -1853,55 +2607,37 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// The node at the root of the SPF tree was looked up when the calculation
+// started.  This is the node for which we are building the routing table.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node != 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                     "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+      int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+      if (interface < 0)
+        {
+          NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                          "Expected an interface associated with address a:" << a);
         }
+#endif 
+      return interface;
     }
 //
 // Couldn't find it.
@@ -1944,60 +2680,35 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node that has the router ID corresponding to the root vertex was
+// looked up when the calculation started.  This is the one we're going to
+// write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node != 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+      GlobalRoutingLSA *lsa = v->GetLSA ();
+      NS_ASSERT_MSG (lsa, 
+                     "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                     "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+      uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2717,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+      NS_LOG_LOGIC (" Node " << node->GetId () <<
+                    " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+      for (uint32_t j = 0; j < nLinkRecords; ++j)
+        {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+            {
+              continue;
+            }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,44 +2742,43 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
+          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+          if (router == 0)
+            {
+              continue;
+            }
+          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+          NS_ASSERT (gr);
+          // walk through all available exit directions due to ECMP,
+          // and add host route for each of the exit direction toward
+          // the vertex 'v'
+          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+            {
+              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+              Ipv4Address nextHop = exit.first;
+              int32_t outIf = exit.second;
+              if (outIf >= 0)
                 {
-                  continue;
+                  gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                      outIf);
+                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                                " adding host route to " << lr->GetLinkData () <<
+                                " using next hop " << nextHop <<
+                                " and outgoing interface " << outIf);
                 }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+              else
                 {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
+                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                                " NOT able to add host route to " << lr->GetLinkData () <<
+                                " using next hop " << nextHop <<
+                                " since outgoing interface id is negative " << outIf);
+                }
+            } // for all routes from the root the vertex 'v'
+        }
 //
 // Done adding the routes for the selected node.
 //
-          return;
-        }
+      return;
     }
 }
 void
@@ -2089,95 +2799,69 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node that has the router ID corresponding to the root vertex was
+// looked up when the calculation started.  This is the one we're going to
+// write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node != 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      NS_ASSERT_MSG (ipv4, 
+                     "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                     "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
+      GlobalRoutingLSA *lsa = v->GetLSA ();
+      NS_ASSERT_MSG (lsa, 
+                     "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                     "Expected valid LSA in SPFVertex* v");
+      Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+      Ipv4Address tempip = lsa->GetLinkStateId ();
+      tempip = tempip.CombineMask (tempmask);
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          return;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+
+          if (outIf >= 0)
             {
-              continue;
+              gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " via interface " << outIf);
             }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+          else
             {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add network route to " << tempip <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
             }
         }
-    } 
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -26,7 +26,10 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <vector>
+#include <atomic>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
@@ -38,6 +41,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -673,14 +677,49 @@ public:
    * @returns the number of External Link State Advertisements.
    */
   uint32_t GetNumExtLSAs () const;
+  /**
+   * @brief Get the number of Link State Advertisements, other than the
+   * External ones.
+   *
+   * @see GlobalRoutingLSA
+   * @returns the number of Link State Advertisements.
+   */
+  uint32_t GetNumLSAs () const;
+
+  /**
+   * @brief Make a deep copy of the database.
+   *
+   * The copy holds its own copies of the Link State Advertisements, whose
+   * status flags can be changed by an SPF calculation without disturbing
+   * the ones of this database.
+   *
+   * @returns the copy, to be deleted by the caller.
+   */
+  GlobalRouteManagerLSDB* Copy (void) const;
+
+  /**
+   * @brief Compare the Link State Advertisements of this database with the
+   * ones of another database.
+   *
+   * The External Link State Advertisements are not compared.
+   *
+   * @param lsdb the other database
+   * @param changed filled with the link state IDs of the LSAs which differ,
+   * or which are in a single database
+   */
+  void Diff (const GlobalRouteManagerLSDB* lsdb, std::set<Ipv4Address>& changed) const;
 
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
+  /// container of the Link State Advertisements by the link data of their transit network records
+  typedef std::unordered_map<Ipv4Address, GlobalRoutingLSA*, Ipv4AddressHash> LinkDataMap_t;
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  mutable LinkDataMap_t m_linkData; //!< index of m_database by link data, built by GetLSAByLinkData
+  mutable bool m_linkDataValid; //!< true if m_linkData matches m_database
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -698,6 +737,125 @@ private:
   GlobalRouteManagerLSDB& operator= (GlobalRouteManagerLSDB& lsdb);
 };
 
+/**
+ * @brief The shortest-path tree of an SPF calculation, kept after the
+ * calculation.
+ *
+ * The vertices are recorded in the order in which they joined the tree,
+ * with their distance from the root, their parents and their root exit
+ * directions.  This is enough to tell whether a change of the Link State
+ * Advertisements can change the tree, and to install the routes of the
+ * root again from the tree without running the calculation.
+ */
+class SPFTree
+{
+public:
+  SPFTree ();
+
+/**
+ * @brief Remove all the vertices.
+ */
+  void Clear (void);
+
+/**
+ * @brief Add a vertex which joined the tree; its parents must have been
+ * added before it.
+ * @param v the vertex
+ */
+  void Add (const SPFVertex* v);
+
+/**
+ * @brief Index the vertices by ID, once all of them were added.
+ */
+  void Index (void);
+
+/**
+ * @brief Set whether the root is a stub node, whose routes are not
+ * computed from the tree.
+ * @param stub true if the root is a stub node
+ */
+  void SetStub (bool stub);
+
+/**
+ * @returns true if the root is a stub node
+ */
+  bool IsStub (void) const;
+
+/**
+ * @returns the number of vertices, the root included
+ */
+  uint32_t GetNVertices (void) const;
+
+/**
+ * @brief Find a vertex.
+ * @param id the vertex ID
+ * @returns the index of the vertex, or GetNVertices () if it is not in
+ * the tree
+ */
+  uint32_t Find (Ipv4Address id) const;
+
+/**
+ * @param i the index of a vertex
+ * @returns the ID of the vertex
+ */
+  Ipv4Address GetVertexId (uint32_t i) const;
+
+/**
+ * @param i the index of a vertex
+ * @returns the distance of the vertex from the root
+ */
+  uint32_t GetDistanceFromRoot (uint32_t i) const;
+
+/**
+ * @param i the index of a vertex
+ * @returns the number of parents of the vertex
+ */
+  uint32_t GetNParents (uint32_t i) const;
+
+/**
+ * @param i the index of a vertex
+ * @param j the index of a parent of the vertex
+ * @returns the ID of the parent
+ */
+  Ipv4Address GetParent (uint32_t i, uint32_t j) const;
+
+/**
+ * @param i the index of a vertex
+ * @param parent the ID of another vertex
+ * @returns true if parent is a parent of the vertex
+ */
+  bool HasParent (uint32_t i, Ipv4Address parent) const;
+
+/**
+ * @param i the index of a vertex
+ * @returns the number of root exit directions of the vertex
+ */
+  uint32_t GetNRootExitDirections (uint32_t i) const;
+
+/**
+ * @param i the index of a vertex
+ * @param j the index of a root exit direction of the vertex
+ * @returns the root exit direction
+ */
+  SPFVertex::NodeExit_t GetRootExitDirection (uint32_t i, uint32_t j) const;
+
+private:
+  /// a vertex of the tree
+  struct Vertex
+  {
+    Ipv4Address id;    //!< the vertex ID
+    uint32_t distance; //!< the distance from the root
+    uint32_t parents;  //!< the index of the first parent in m_parents
+    uint32_t exits;    //!< the index of the first root exit direction in m_exits
+  };
+
+  std::vector<Vertex> m_vertices; //!< the vertices, in the order they joined the tree
+  std::vector<Ipv4Address> m_parents; //!< the parents of the vertices
+  std::vector<SPFVertex::NodeExit_t> m_exits; //!< the root exit directions of the vertices
+  std::vector<std::pair<Ipv4Address, uint32_t> > m_index; //!< the indexes of the vertices, sorted by ID
+  bool m_stub; //!< true if the root is a stub node
+};
+
 /**
  * @brief A global router implementation.
  *
@@ -735,6 +893,23 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Update the routes after a change of the topology.
+ *
+ * The Link State Advertisements are gathered again and compared with the
+ * ones of the previous calculation.  The SPF calculation is only run
+ * again for the roots whose shortest-path tree can be changed by the
+ * changed LSAs; the routes of the other roots are installed again from
+ * their kept tree.  The forwarding tables are the same as the ones
+ * computed by DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes (), without the routes added by hand.
+ *
+ * The trees are kept from the first call on, as long as they fit in the
+ * "GlobalRoutingMaxSpfTreeMemory" bound: the first call and the roots
+ * without a tree run the SPF calculation again.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -767,7 +942,81 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot; //!< the root node
+  Ptr<Node> m_spfrootNode; //!< the node whose routes are computed, if any
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  /// container of the nodes by router ID
+  typedef std::unordered_map<Ipv4Address, Ptr<Node>, Ipv4AddressHash> RouterMap_t;
+  RouterMap_t m_routers; //!< the nodes of the routers, while routes are computed
+  bool m_routesValid; //!< true if the routes were computed from the LSDB
+  bool m_keepTrees; //!< true if the SPF calculations keep their trees, once UpdateRoutes was called
+  /// container of the shortest-path trees by router ID of their root
+  typedef std::unordered_map<Ipv4Address, SPFTree, Ipv4AddressHash> SPFTreeMap_t;
+  SPFTreeMap_t m_spfTrees; //!< the kept trees of the routes installed
+  SPFTree* m_spfTree; //!< where SPFCalculate records its tree, if not 0
+
+  /**
+   * \brief Delete the routes of a node.
+   * \param node the node
+   * \param router the GlobalRouter interface of the node
+   */
+  void DeleteRoutes (Ptr<Node> node, Ptr<GlobalRouter> router);
+
+  /**
+   * \brief Run the SPF calculations of some roots.
+   *
+   * Once UpdateRoutes was called, the trees of the first roots are kept,
+   * up to the "GlobalRoutingMaxSpfTreeMemory" bound.
+   *
+   * \param roots the router IDs of the roots
+   */
+  void CalculateRoutes (const std::vector<Ipv4Address> &roots);
+
+  /**
+   * \brief Install the routes of a root from its kept shortest-path tree.
+   *
+   * The routes are the ones that SPFCalculate would install if the tree
+   * did not change: the vertices join the tree in the same order, with
+   * the same root exit directions, and their current LSAs give the routes.
+   *
+   * \param root the router ID of the root
+   * \param tree the tree of the root
+   */
+  void SPFInstallTree (Ipv4Address root, const SPFTree &tree);
+
+  /**
+   * \brief Install the routes to the stub networks and to the external
+   * destinations, once the shortest-path tree of m_spfroot is complete,
+   * and delete the tree.
+   */
+  void SPFProcessTree (void);
+
+  /**
+   * \brief Index the nodes which have a GlobalRouter interface by router ID.
+   *
+   * The SPF calculations look up the node of their root here instead of
+   * walking the NodeList.  This is always done in the main thread, the
+   * reference counts of the nodes not being thread-safe.
+   */
+  void IndexRouters (void);
+
+  /**
+   * \brief Look up the node of a router.
+   * \param routerId the router ID
+   * \returns the first node of the NodeList with this router ID, or 0
+   */
+  Ptr<Node> GetRouterNode (Ipv4Address routerId) const;
+
+  /**
+   * \brief Run SPF calculations until all the roots are done.
+   *
+   * This is the body of the threads started by InitializeRoutes; each
+   * thread has its own GlobalRouteManagerImpl and copy of the LSDB.
+   *
+   * \param roots the roots of the SPF calculations
+   * \param trees where the trees of the first roots are recorded
+   * \param next the index in roots of the next root to compute
+   */
+  void SPFCalculateRoots (const std::vector<Ipv4Address> *roots, std::vector<SPFTree> *trees, std::atomic<uint32_t> *next);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
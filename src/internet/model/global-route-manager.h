@@ -65,6 +65,13 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Update the Link State Advertisements and the per-node forwarding
+ * tables after a change of the topology, running the SPF computation only
+ * for the nodes whose shortest-path tree the change can modify
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -22,12 +22,42 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+Ipv4EndPointDemux::FourTuple::FourTuple (Ipv4Address localAddress, uint16_t localPort,
+                                         Ipv4Address peerAddress, uint16_t peerPort)
+  : m_localAddress (localAddress),
+    m_localPort (localPort),
+    m_peerAddress (peerAddress),
+    m_peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::FourTuple::operator == (const FourTuple &other) const
+{
+  return m_localPort == other.m_localPort
+         && m_peerPort == other.m_peerPort
+         && m_localAddress == other.m_localAddress
+         && m_peerAddress == other.m_peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator () (const FourTuple &tuple) const
+{
+  Ipv4AddressHash addressHash;
+  size_t hash = addressHash (tuple.m_localAddress);
+  hash = hash * 31 + tuple.m_localPort;
+  hash = hash * 31 + addressHash (tuple.m_peerAddress);
+  hash = hash * 31 + tuple.m_peerPort;
+  return hash;
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -40,34 +70,91 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_exactIndex.clear ();
+  m_localIndex.clear ();
 }
 
-bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  NS_LOG_FUNCTION (this << endPoint);
+  m_endPoints.push_back (endPoint);
+  endPoint->m_demux = this;
+  AddToIndexes (--m_endPoints.end ());
+}
+
+void
+Ipv4EndPointDemux::AddToIndexes (EndPointsI i)
+{
+  Ipv4EndPoint *endPoint = *i;
+  FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  m_exactIndex[tuple].push_back (i);
+  m_localIndex[std::make_pair (endPoint->GetLocalPort (), endPoint->GetLocalAddress ())].insert (endPoint);
+}
+
+Ipv4EndPointDemux::EndPointsI
+Ipv4EndPointDemux::RemoveFromIndexes (Ipv4EndPoint *endPoint)
+{
+  FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  auto bucket = m_exactIndex.find (tuple);
+  if (bucket == m_exactIndex.end ())
     {
-      if ((*i)->GetLocalPort  () == port) 
+      return m_endPoints.end ();
+    }
+  EndPointsI position = m_endPoints.end ();
+  for (auto i = bucket->second.begin (); i != bucket->second.end (); i++)
+    {
+      if (**i == endPoint)
         {
-          return true;
+          position = *i;
+          bucket->second.erase (i);
+          break;
         }
     }
-  return false;
+  if (position == m_endPoints.end ())
+    {
+      return position;
+    }
+  if (bucket->second.empty ())
+    {
+      m_exactIndex.erase (bucket);
+    }
+
+  auto local = m_localIndex.find (std::make_pair (endPoint->GetLocalPort (), endPoint->GetLocalAddress ()));
+  local->second.erase (endPoint);
+  if (local->second.empty ())
+    {
+      m_localIndex.erase (local);
+    }
+  return position;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  auto i = m_localIndex.lower_bound (std::make_pair (port, Ipv4Address::GetZero ()));
+  return i != m_localIndex.end () && i->first.first == port;
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  auto local = m_localIndex.find (std::make_pair (port, addr));
+  if (local == m_localIndex.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
+      return false;
+    }
+  for (auto i = local->second.begin (); i != local->second.end (); i++)
+    {
+      if ((*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
         }
@@ -86,7 +173,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -102,7 +189,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -125,7 +212,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,21 +223,21 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  auto bucket = m_exactIndex.find (FourTuple (localAddress, localPort, peerAddress, peerPort));
+  if (bucket != m_exactIndex.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      for (auto i = bucket->second.begin (); i != bucket->second.end (); i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if ((**i)->GetBoundNetDevice () == boundNetDevice || (**i)->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -161,14 +248,12 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointsI i = RemoveFromIndexes (endPoint);
+  if (i != m_endPoints.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      m_endPoints.erase (i);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -190,32 +275,18 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
 }
 
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv4EndPointDemux::EndPoints
-Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
-                           Ipv4Address saddr, uint16_t sport,
-                           Ptr<Ipv4Interface> incomingInterface)
+void
+Ipv4EndPointDemux::AddMatches (const FourTuple &tuple, Ptr<Ipv4Interface> incomingInterface,
+                               EndPoints &matches)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-  
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  auto bucket = m_exactIndex.find (tuple);
+  if (bucket == m_exactIndex.end ())
     {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
+      return;
+    }
+  for (auto i = bucket->second.begin (); i != bucket->second.end (); i++)
+    {
+      Ipv4EndPoint* endP = **i;
 
       if (!endP->IsRxEnabled ())
         {
@@ -223,15 +294,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
                         << " because endpoint can not receive packets");
           continue;
         }
-
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -243,94 +305,90 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
+      matches.push_back (endP);
+    }
+}
+
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ *
+ * Rather than testing every endpoint, the four-tuples which can match the
+ * packet are looked up in the index, from the most exact to the most generic.
+ */
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
+                           Ipv4Address saddr, uint16_t sport,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
 
-      bool localAddressMatchesExact = false;
-      bool localAddressIsAny = false;
-      bool localAddressIsSubnetAny = false;
+  EndPoints retval;
 
-      // We have 3 cases:
-      // 1) Exact local / destination address match
-      // 2) Local endpoint bound to Any -> matches anything
-      // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  // Exact match on all 4 - this is the case of an open TCP connection, for example.
+  AddMatches (FourTuple (daddr, dport, saddr, sport), incomingInterface, retval);
+  if (!retval.empty ())
+    {
+      NS_LOG_LOGIC ("Found an endpoint for case 4, " << daddr << ":" << dport);
+    }
 
-      if (endP->GetLocalAddress () == daddr)
-        {
-          // Case 1:
-          localAddressMatchesExact = true;
-        }
-      else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
+  // The local addresses matching the destination as a wildcard:
+  // 1) Local endpoint bound to Any -> matches anything
+  // 2) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  // An exact match of the local address takes precedence.
+  std::vector<Ipv4Address> wildcards;
+  if (retval.empty ())
+    {
+      if (daddr != Ipv4Address::GetAny ())
         {
-          // Case 2:
-          localAddressIsAny = true;
+          wildcards.push_back (Ipv4Address::GetAny ());
         }
-      else
+      for (uint32_t i = 0; incomingInterface && i < incomingInterface->GetNAddresses (); i++)
         {
-          // Case 3:
-          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (addrNetpart != daddr && addrNetpart == daddr.CombineMask (addr.GetMask ())
+              && std::find (wildcards.begin (), wildcards.end (), addrNetpart) == wildcards.end ())
             {
-              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-
-              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
-              if (endP->GetLocalAddress () == addrNetpart)
-                {
-                  NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
-
-                  Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
-                  if (addrNetpart == daddrNetPart)
-                    {
-                      localAddressIsSubnetAny = true;
-                    }
-                }
+              wildcards.push_back (addrNetpart);
             }
-
-          // if no match here, keep looking
-          if (!localAddressIsSubnetAny)
-            continue;
         }
 
-      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
-
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
-
-      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
-
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
+      // All but local address - no idea what this case could be.
+      for (auto i = wildcards.begin (); i != wildcards.end (); i++)
+        {
+          AddMatches (FourTuple (*i, dport, saddr, sport), incomingInterface, retval);
         }
-      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-          NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval3.push_back (endP);
+      if (!retval.empty ())
+        {
+          NS_LOG_LOGIC ("Found an endpoint for case 3, " << daddr << ":" << dport);
         }
-      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-          NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval2.push_back (endP);
+    }
+  if (retval.empty ())
+    {
+      // Only local port and local address matches exactly - Not yet opened connection
+      AddMatches (FourTuple (daddr, dport, Ipv4Address::GetAny (), 0), incomingInterface, retval);
+      if (!retval.empty ())
+        {
+          NS_LOG_LOGIC ("Found an endpoint for case 2, " << daddr << ":" << dport);
         }
-      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-          NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval1.push_back (endP);
+    }
+  if (retval.empty ())
+    {
+      // Only local port matches exactly - Endpoint open to "any" connection
+      for (auto i = wildcards.begin (); i != wildcards.end (); i++)
+        {
+          AddMatches (FourTuple (*i, dport, Ipv4Address::GetAny (), 0), incomingInterface, retval);
+        }
+      if (!retval.empty ())
+        {
+          NS_LOG_LOGIC ("Found an endpoint for case 1, " << daddr << ":" << dport);
         }
     }
 
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
   NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
   return retval;  // might be empty if no matches
 }
@@ -343,6 +401,13 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  // a single exact match is returned without going through the endpoints
+  auto bucket = m_exactIndex.find (FourTuple (daddr, dport, saddr, sport));
+  if (bucket != m_exactIndex.end () && bucket->second.size () == 1)
+    {
+      return *bucket->second.front ();
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
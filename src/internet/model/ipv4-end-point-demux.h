@@ -23,6 +23,10 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +44,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by four-tuple, so that a lookup costs a few
+ * hash table searches whatever the number of connections, and by local port
+ * and local address.  The endpoints update the indexes when their address
+ * or port changes.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +175,86 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of an endpoint, key of the exact match index.
+   */
+  struct FourTuple
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    FourTuple (Ipv4Address localAddress, uint16_t localPort,
+               Ipv4Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Comparison operator.
+     * \param other the four-tuple to compare with
+     * \return true if both four-tuples are equal
+     */
+    bool operator == (const FourTuple &other) const;
+
+    Ipv4Address m_localAddress; //!< local address
+    uint16_t m_localPort;       //!< local port
+    Ipv4Address m_peerAddress;  //!< peer address
+    uint16_t m_peerPort;        //!< peer port
+  };
+
+  /**
+   * \brief Hash function of the four-tuples.
+   */
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator () (const FourTuple &tuple) const;
+  };
+
+  /**
+   * \brief Add an endpoint to the list and to the indexes.
+   * \param endPoint the endpoint
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the indexes.
+   *
+   * Called when the endpoint is allocated, and when its address or port
+   * changes.
+   *
+   * \param i the position of the endpoint in the list of endpoints
+   */
+  void AddToIndexes (EndPointsI i);
+
+  /**
+   * \brief Remove an endpoint from the indexes.
+   *
+   * Called when the endpoint is deallocated, and before its address or port
+   * changes.
+   *
+   * \param endPoint the endpoint
+   * \return the position of the endpoint in the list of endpoints, or the end
+   * of the list if the endpoint is unknown
+   */
+  EndPointsI RemoveFromIndexes (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add the endpoints with a four-tuple which can receive a packet
+   * from an interface to a list.
+   * \param tuple the four-tuple
+   * \param incomingInterface the incoming interface
+   * \param matches the list of matching endpoints
+   */
+  void AddMatches (const FourTuple &tuple, Ptr<Ipv4Interface> incomingInterface,
+                   EndPoints &matches);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +281,20 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The positions of the endpoints in the list, by four-tuple.
+   *
+   * Several endpoints share a four-tuple when they are bound to different
+   * NetDevices, and the listening and unconnected endpoints are found under
+   * their wildcard peer (any address, port 0).
+   */
+  std::unordered_map<FourTuple, std::vector<EndPointsI>, FourTupleHash> m_exactIndex;
+
+  /**
+   * \brief The endpoints, by local port and local address.
+   */
+  std::map<std::pair<uint16_t, Ipv4Address>, std::set<Ipv4EndPoint *> > m_localIndex;
 };
 
 } // namespace ns3
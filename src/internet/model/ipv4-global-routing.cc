@@ -16,6 +16,7 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <algorithm>
 #include <vector>
 #include <iomanip>
 #include "ns3/names.h"
@@ -59,7 +60,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_routeSequence (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +82,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteIndex, route);
 }
 
 void 
@@ -90,6 +93,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRouteIndex, route);
 }
 
 void 
@@ -105,6 +109,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteIndex, route);
 }
 
 void 
@@ -118,6 +123,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRouteIndex, route);
 }
 
 void 
@@ -133,6 +139,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalRouteIndex, route);
 }
 
 
@@ -146,72 +153,69 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  // The forwarding indexes only return the routes whose destination
+  // contains dest, in the order of the routing tables.
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  IndexedRoutes *hostRoutes = m_hostRouteIndex.Find (dest, 32);
+  if (hostRoutes != 0)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (IndexedRoutes::const_iterator i = hostRoutes->begin (); 
+           i != hostRoutes->end (); 
+           i++) 
         {
+          NS_ASSERT (i->second->IsHost ());
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (i->second->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (i->second);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->second); 
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
+      IndexedRoutes networkRoutes;
+      MatchRoutes (m_networkRouteIndex, dest, networkRoutes);
+      for (IndexedRoutes::const_iterator j = networkRoutes.begin (); 
+           j != networkRoutes.end (); 
            j++) 
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          if (oif != 0)
             {
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice (j->second->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
+          allRoutes.push_back (j->second);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << j->second);
         }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
+      IndexedRoutes externalRoutes;
+      MatchRoutes (m_ASexternalRouteIndex, dest, externalRoutes);
+      for (IndexedRoutes::const_iterator k = externalRoutes.begin ();
+           k != externalRoutes.end ();
            k++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_LOG_LOGIC ("Found external route" << k->second);
+          if (oif != 0)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              if (oif != m_ipv4->GetNetDevice (k->second->GetInterface ()))
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
+          allRoutes.push_back (k->second);
+          break;
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
@@ -245,6 +249,53 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::IndexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  index.Insert (route->GetDestNetwork (),
+                route->GetDestNetworkMask ().GetPrefixLength ()).push_back (std::make_pair (m_routeSequence++, route));
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  Ipv4Address network = route->GetDestNetwork ();
+  uint8_t length = route->GetDestNetworkMask ().GetPrefixLength ();
+  IndexedRoutes *routes = index.Find (network, length);
+  NS_ASSERT (routes != 0);
+  for (IndexedRoutes::iterator i = routes->begin (); i != routes->end (); i++)
+    {
+      if (i->second == route)
+        {
+          routes->erase (i);
+          break;
+        }
+    }
+  if (routes->empty ())
+    {
+      index.Erase (network, length);
+    }
+}
+
+void
+Ipv4GlobalRouting::MatchRoutes (const RouteIndex &index, Ipv4Address dest, IndexedRoutes &routes) const
+{
+  NS_LOG_FUNCTION (this << dest);
+  IndexedRoutes *matches[RouteIndex::MAX_MATCHES];
+  uint32_t nMatches = index.Match (dest, matches);
+  for (uint32_t i = 0; i < nMatches; i++)
+    {
+      routes.insert (routes.end (), matches[i]->begin (), matches[i]->end ());
+    }
+  if (nMatches > 1)
+    {
+      // back to the table order, which the prefixes do not follow.
+      std::sort (routes.begin (), routes.end ());
+    }
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -319,6 +370,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostRouteIndex, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +388,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkRouteIndex, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +405,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalRouteIndex, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +446,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteIndex.Clear ();
+  m_networkRouteIndex.Clear ();
+  m_ASexternalRouteIndex.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -260,6 +263,13 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// a route with its insertion sequence number, which gives its table order
+  typedef std::pair<uint32_t, Ipv4RoutingTableEntry *> IndexedRoute;
+  /// list of routes with their insertion sequence numbers
+  typedef std::vector<IndexedRoute> IndexedRoutes;
+  /// forwarding index of a routing table, by destination prefix
+  typedef Ipv4PrefixTrie<IndexedRoutes> RouteIndex;
+
   /**
    * \brief Lookup in the forwarding table for destination.
    * \param dest destination address
@@ -268,10 +278,38 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Add a route to a forwarding index.
+   * \param index the forwarding index
+   * \param route the route, which has just been appended to its table
+   */
+  void IndexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove a route from a forwarding index.
+   * \param index the forwarding index
+   * \param route the route
+   */
+  void UnindexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Find all the routes of a forwarding index whose destination
+   * network contains an address.
+   * \param index the forwarding index
+   * \param dest the address
+   * \param routes the matching routes, in table order
+   */
+  void MatchRoutes (const RouteIndex &index, Ipv4Address dest, IndexedRoutes &routes) const;
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  RouteIndex m_hostRouteIndex;           //!< Index of the routes to hosts
+  RouteIndex m_networkRouteIndex;        //!< Index of the routes to networks
+  RouteIndex m_ASexternalRouteIndex;     //!< Index of the external routes
+  uint32_t m_routeSequence;              //!< Sequence number of the next route
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
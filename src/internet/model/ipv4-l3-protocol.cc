@@ -33,6 +33,7 @@
 #include "ns3/boolean.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/gso-tag.h"
 
 #include "loopback-net-device.h"
 #include "arp-l3-protocol.h"
@@ -41,6 +42,8 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
 
 namespace ns3 {
 
@@ -925,12 +928,27 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  GsoTag gsoTag;
+  bool isSuperSegment = packet->PeekPacketTag (gsoTag);
+  if (isSuperSegment && !IsSegmentationOffload (outDev))
+    {
+      // Software segmentation of a super-segment, before a device which
+      // cannot send it as a burst of frames
+      std::list<Ipv4PayloadHeaderPair> listSegments;
+      DoSegmentation (packet, ipHeader, listSegments);
+      for (std::list<Ipv4PayloadHeaderPair>::iterator it = listSegments.begin (); it != listSegments.end (); it++)
+        {
+          SendRealOut (route, it->first, it->second);
+        }
+      return;
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!isSuperSegment && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -957,7 +975,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if (!isSuperSegment && packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ())
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -982,6 +1000,56 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
     }
 }
 
+bool
+Ipv4L3Protocol::IsSegmentationOffload (Ptr<NetDevice> device)
+{
+  BooleanValue offload;
+  return device->GetAttributeFailSafe ("SegmentationOffload", offload) && offload.Get ();
+}
+
+void
+Ipv4L3Protocol::DoSegmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, std::list<Ipv4PayloadHeaderPair>& listSegments)
+{
+  NS_LOG_FUNCTION (this << *packet << ipv4Header << &listSegments);
+  NS_ASSERT_MSG (ipv4Header.GetProtocol () == TcpL4Protocol::PROT_NUMBER, "Only TCP builds super-segments");
+
+  Ptr<Packet> p = packet->Copy ();
+  GsoTag gsoTag;
+  p->RemovePacketTag (gsoTag);
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+  uint32_t segmentSize = gsoTag.GetSegmentSize ();
+  uint32_t size = p->GetSize ();
+  uint8_t flags = tcpHeader.GetFlags ();
+
+  for (uint32_t offset = 0, i = 0; offset < size; offset += segmentSize, i++)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = p->CreateFragment (offset, length);
+
+      // as in Linux, FIN and PSH are only set in the last segment, and the
+      // IP identification is incremented for each segment
+      TcpHeader header = tcpHeader;
+      header.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      if (offset + length < size)
+        {
+          header.SetFlags (flags & ~(TcpHeader::FIN | TcpHeader::PSH));
+        }
+      if (Node::ChecksumEnabled ())
+        {
+          header.EnableChecksums ();
+        }
+      header.InitializeChecksum (ipv4Header.GetSource (), ipv4Header.GetDestination (), TcpL4Protocol::PROT_NUMBER);
+      segment->AddHeader (header);
+
+      Ipv4Header segmentHeader = ipv4Header;
+      segmentHeader.SetIdentification (ipv4Header.GetIdentification () + i);
+      segmentHeader.SetPayloadSize (segment->GetSize ());
+      listSegments.push_back (Ipv4PayloadHeaderPair (segment, segmentHeader));
+    }
+  NS_LOG_LOGIC ("Split a super-segment of " << size << " bytes in " << listSegments.size () << " segments");
+}
+
 // This function analogous to Linux ip_mr_forward()
 void
 Ipv4L3Protocol::IpMulticastForward (Ptr<Ipv4MulticastRoute> mrtentry, Ptr<const Packet> p, const Ipv4Header &header)
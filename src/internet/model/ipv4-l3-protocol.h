@@ -405,6 +405,21 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Split a TCP super-segment (see GsoTag) into its segments
+   * \param packet the super-segment, starting with its TCP header
+   * \param ipv4Header the IPv4 header
+   * \param listSegments the list of segments
+   */
+  void DoSegmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, std::list<Ipv4PayloadHeaderPair>& listSegments);
+
+  /**
+   * \param device a net device
+   * \returns true if the device accepts the super-segments (see GsoTag),
+   * i.e., if its SegmentationOffload attribute is set
+   */
+  static bool IsSegmentationOffload (Ptr<NetDevice> device);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
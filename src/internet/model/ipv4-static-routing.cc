@@ -23,6 +23,7 @@
       std::clog << Simulator::Now ().GetSeconds () \
                 << " [node " << m_ipv4->GetObject<Node> ()->GetId () << "] "; }
 
+#include <algorithm>
 #include <iomanip>
 #include "ns3/log.h"
 #include "ns3/names.h"
@@ -72,7 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  InsertNetworkRoute (route, metric);
 }
 
 void 
@@ -86,7 +87,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  InsertNetworkRoute (route, metric);
 }
 
 void 
@@ -143,7 +144,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  InsertNetworkRoute (route, 0);
 }
 
 uint32_t 
@@ -239,54 +240,63 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
-
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // Only the routes of the prefixes which contain dest are looked at,
+  // longest prefix first, each prefix's routes in table order: the
+  // first prefix with a usable route holds the route that a scan of
+  // the whole table would select.
+  std::vector<NetworkRoutesI> *matches[NetworkRouteIndex::MAX_MATCHES];
+  uint32_t nMatches = m_networkRouteIndex.Match (dest, matches);
+  for (uint32_t k = 0; k < nMatches && rtentry == 0; k++)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      for (std::vector<NetworkRoutesI>::const_iterator it = matches[k]->begin (); 
+           it != matches[k]->end (); 
+           it++) 
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
+          NetworkRoutesI i = *it;
+          Ipv4RoutingTableEntry *j=i->first;
+          uint32_t metric =i->second;
+          Ipv4Mask mask = (j)->GetDestNetworkMask ();
+          uint16_t masklen = mask.GetPrefixLength ();
+          Ipv4Address entry = (j)->GetDestNetwork ();
+          NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
+          if (mask.IsMatch (dest, entry)) 
             {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+              if (oif != 0)
                 {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+                    {
+                      NS_LOG_LOGIC ("Not on requested interface, skipping");
+                      continue;
+                    }
+                }
+              if (masklen < longest_mask) // Not interested if got shorter mask
+                {
+                  NS_LOG_LOGIC ("Previous match longer, skipping");
                   continue;
                 }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
-            {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
-            }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
+              if (masklen > longest_mask) // Reset metric if longer masklen
+                {
+                  shortest_metric = 0xffffffff;
+                }
+              longest_mask = masklen;
+              if (metric > shortest_metric)
+                {
+                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                  continue;
+                }
+              shortest_metric = metric;
+              Ipv4RoutingTableEntry* route = (j);
+              uint32_t interfaceIdx = route->GetInterface ();
+              rtentry = Create<Ipv4Route> ();
+              rtentry->SetDestination (route->GetDest ());
+              rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+              rtentry->SetGateway (route->GetGateway ());
+              rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+              if (masklen == 32)
+                {
+                  break;
+                }
             }
         }
     }
@@ -447,8 +457,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          EraseNetworkRoute (j);
           return;
         }
       tmp++;
@@ -456,6 +465,32 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+void
+Ipv4StaticRouting::InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  NetworkRoutesI i = m_networkRoutes.insert (m_networkRoutes.end (), make_pair (route, metric));
+  m_networkRouteIndex.Insert (route->GetDestNetwork (),
+                              route->GetDestNetworkMask ().GetPrefixLength ()).push_back (i);
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute (NetworkRoutesI i)
+{
+  NS_LOG_FUNCTION (this << i->first);
+  Ipv4Address network = i->first->GetDestNetwork ();
+  uint8_t length = i->first->GetDestNetworkMask ().GetPrefixLength ();
+  std::vector<NetworkRoutesI> *routes = m_networkRouteIndex.Find (network, length);
+  NS_ASSERT (routes != 0);
+  routes->erase (std::find (routes->begin (), routes->end (), i));
+  if (routes->empty ())
+    {
+      m_networkRouteIndex.Erase (network, length);
+    }
+  delete i->first;
+  return m_networkRoutes.erase (i);
+}
+
 Ptr<Ipv4Route> 
 Ipv4StaticRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
@@ -575,6 +610,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteIndex.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,8 +649,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -660,8 +695,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
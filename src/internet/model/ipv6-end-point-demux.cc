@@ -26,6 +26,33 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 
+Ipv6EndPointDemux::FourTuple::FourTuple (Ipv6Address localAddress, uint16_t localPort,
+                                         Ipv6Address peerAddress, uint16_t peerPort)
+  : m_localAddress (localAddress),
+    m_localPort (localPort),
+    m_peerAddress (peerAddress),
+    m_peerPort (peerPort)
+{
+}
+
+bool Ipv6EndPointDemux::FourTuple::operator == (const FourTuple &other) const
+{
+  return m_localPort == other.m_localPort
+         && m_peerPort == other.m_peerPort
+         && m_localAddress == other.m_localAddress
+         && m_peerAddress == other.m_peerAddress;
+}
+
+size_t Ipv6EndPointDemux::FourTupleHash::operator () (const FourTuple &tuple) const
+{
+  Ipv6AddressHash addressHash;
+  size_t hash = addressHash (tuple.m_localAddress);
+  hash = hash * 31 + tuple.m_localPort;
+  hash = hash * 31 + addressHash (tuple.m_peerAddress);
+  hash = hash * 31 + tuple.m_peerPort;
+  return hash;
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
@@ -40,32 +67,86 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_exactIndex.clear ();
+  m_localIndex.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  NS_LOG_FUNCTION (this << endPoint);
+  m_endPoints.push_back (endPoint);
+  endPoint->m_demux = this;
+  AddToIndexes (--m_endPoints.end ());
+}
+
+void Ipv6EndPointDemux::AddToIndexes (EndPointsI i)
+{
+  Ipv6EndPoint *endPoint = *i;
+  FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  m_exactIndex[tuple].push_back (i);
+  m_localIndex[std::make_pair (endPoint->GetLocalPort (), endPoint->GetLocalAddress ())].insert (endPoint);
+}
+
+Ipv6EndPointDemux::EndPointsI Ipv6EndPointDemux::RemoveFromIndexes (Ipv6EndPoint *endPoint)
+{
+  FourTuple tuple (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                   endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  auto bucket = m_exactIndex.find (tuple);
+  if (bucket == m_exactIndex.end ())
+    {
+      return m_endPoints.end ();
+    }
+  EndPointsI position = m_endPoints.end ();
+  for (auto i = bucket->second.begin (); i != bucket->second.end (); i++)
     {
-      if ((*i)->GetLocalPort  () == port)
+      if (**i == endPoint)
         {
-          return true;
+          position = *i;
+          bucket->second.erase (i);
+          break;
         }
     }
-  return false;
+  if (position == m_endPoints.end ())
+    {
+      return position;
+    }
+  if (bucket->second.empty ())
+    {
+      m_exactIndex.erase (bucket);
+    }
+
+  auto local = m_localIndex.find (std::make_pair (endPoint->GetLocalPort (), endPoint->GetLocalAddress ()));
+  local->second.erase (endPoint);
+  if (local->second.empty ())
+    {
+      m_localIndex.erase (local);
+    }
+  return position;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  auto i = m_localIndex.lower_bound (std::make_pair (port, Ipv6Address::GetZero ()));
+  return i != m_localIndex.end () && i->first.first == port;
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  auto local = m_localIndex.find (std::make_pair (port, addr));
+  if (local == m_localIndex.end ())
+    {
+      return false;
+    }
+  for (auto i = local->second.begin (); i != local->second.end (); i++)
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
+      if ((*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
         }
@@ -83,7 +164,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -98,7 +179,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -119,7 +200,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,21 +210,21 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  auto bucket = m_exactIndex.find (FourTuple (localAddress, localPort, peerAddress, peerPort));
+  if (bucket != m_exactIndex.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      for (auto i = bucket->second.begin (); i != bucket->second.end (); i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if ((**i)->GetBoundNetDevice () == boundNetDevice || (**i)->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -153,42 +234,26 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPointsI i = RemoveFromIndexes (endPoint);
+  if (i != m_endPoints.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      m_endPoints.erase (i);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
-                                                        Ipv6Address saddr, uint16_t sport,
-                                                        Ptr<Ipv6Interface> incomingInterface)
+void Ipv6EndPointDemux::AddMatches (const FourTuple &tuple, Ptr<Ipv6Interface> incomingInterface,
+                                    EndPoints &matches)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-
-  EndPoints retval1; /* Matches exact on local port, wildcards on others */
-  EndPoints retval2; /* Matches exact on local port/adder, wildcards on others */
-  EndPoints retval3; /* Matches all but local address */
-  EndPoints retval4; /* Exact match on all 4 */
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  auto bucket = m_exactIndex.find (tuple);
+  if (bucket == m_exactIndex.end ())
     {
-      Ipv6EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
+      return;
+    }
+  for (auto i = bucket->second.begin (); i != bucket->second.end (); i++)
+    {
+      Ipv6EndPoint* endP = **i;
 
       if (!endP->IsRxEnabled ())
         {
@@ -197,15 +262,6 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
           continue;
         }
 
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
       if (endP->GetBoundNetDevice ())
         {
           if (!incomingInterface)
@@ -221,68 +277,44 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
               continue;
             }
         }
+      matches.push_back (endP);
+    }
+}
 
-      /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-      NS_LOG_DEBUG ("dest addr " << daddr);
-
-      bool localAddressMatchesWildCard = endP->GetLocalAddress () == Ipv6Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
-      bool localAddressMatchesAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ *
+ * Rather than testing every endpoint, the four-tuples which can match the
+ * packet are looked up in the index, from the most exact to the most generic.
+ */
+Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
+                                                        Ipv6Address saddr, uint16_t sport,
+                                                        Ptr<Ipv6Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
 
-      /* if no match here, keep looking */
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-          continue;
-        }
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv6Address::GetAny ();
-
-      /* If remote does not match either with exact or wildcard,i
-         skip this one */
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-          continue;
-        }
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-          continue;
-        }
+  EndPoints retval;
 
-      /* Now figure out which return list to add this one to */
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (localAddressMatchesAllRouters))
-          && remotePeerMatchesWildCard
-          && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All but local address */
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
+  /* All 4 match */
+  AddMatches (FourTuple (daddr, dport, saddr, sport), incomingInterface, retval);
+  if (retval.empty ())
+    {
+      /* All but local address */
+      AddMatches (FourTuple (Ipv6Address::GetAny (), dport, saddr, sport), incomingInterface, retval);
+    }
+  if (retval.empty ())
+    {
+      /* Only local port and local address matches exactly */
+      AddMatches (FourTuple (daddr, dport, Ipv6Address::GetAny (), 0), incomingInterface, retval);
+    }
+  if (retval.empty ())
+    {
+      /* Only local port matches exactly */
+      AddMatches (FourTuple (Ipv6Address::GetAny (), dport, Ipv6Address::GetAny (), 0), incomingInterface, retval);
     }
-
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
 
   NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
   return retval;  // might be empty if no matches
@@ -290,6 +322,13 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  /* a single exact match is returned without going through the endpoints */
+  auto bucket = m_exactIndex.find (FourTuple (dst, dport, src, sport));
+  if (bucket != m_exactIndex.end () && bucket->second.size () == 1)
+    {
+      return *bucket->second.front ();
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
@@ -21,6 +21,7 @@
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ipv6-end-point-demux.h"
 
 #include "ipv6-end-point.h"
 
@@ -30,7 +31,8 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPoint");
 
 Ipv6EndPoint::Ipv6EndPoint (Ipv6Address addr, uint16_t port)
-  : m_localAddr (addr),
+  : m_demux (0),
+    m_localAddr (addr),
     m_localPort (port),
     m_peerAddr (Ipv6Address::GetAny ()),
     m_peerPort (0),
@@ -56,7 +58,14 @@ Ipv6Address Ipv6EndPoint::GetLocalAddress ()
 
 void Ipv6EndPoint::SetLocalAddress (Ipv6Address addr)
 {
+  if (m_demux == 0)
+    {
+      m_localAddr = addr;
+      return;
+    }
+  Ipv6EndPointDemux::EndPointsI i = m_demux->RemoveFromIndexes (this);
   m_localAddr = addr;
+  m_demux->AddToIndexes (i);
 }
 
 uint16_t Ipv6EndPoint::GetLocalPort ()
@@ -66,7 +75,14 @@ uint16_t Ipv6EndPoint::GetLocalPort ()
 
 void Ipv6EndPoint::SetLocalPort (uint16_t port)
 {
+  if (m_demux == 0)
+    {
+      m_localPort = port;
+      return;
+    }
+  Ipv6EndPointDemux::EndPointsI i = m_demux->RemoveFromIndexes (this);
   m_localPort = port;
+  m_demux->AddToIndexes (i);
 }
 
 Ipv6Address Ipv6EndPoint::GetPeerAddress ()
@@ -92,8 +108,16 @@ Ptr<NetDevice> Ipv6EndPoint::GetBoundNetDevice (void)
 
 void Ipv6EndPoint::SetPeer (Ipv6Address addr, uint16_t port)
 {
+  if (m_demux == 0)
+    {
+      m_peerAddr = addr;
+      m_peerPort = port;
+      return;
+    }
+  Ipv6EndPointDemux::EndPointsI i = m_demux->RemoveFromIndexes (this);
   m_peerAddr = addr;
   m_peerPort = port;
+  m_demux->AddToIndexes (i);
 }
 
 void Ipv6EndPoint::SetRxCallback (Callback<void, Ptr<Packet>, Ipv6Header, uint16_t, Ptr<Ipv6Interface> > callback)
@@ -29,6 +29,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv6-route.h"
+#include "ns3/gso-tag.h"
 
 #include "tcp-l4-protocol.h"
 #include "tcp-header.h"
@@ -575,6 +576,14 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
 
   packet->AddHeader (outgoingHeader);
 
+  GsoTag gsoTag;
+  if (packet->RemovePacketTag (gsoTag))
+    {
+      // each segment of the super-segment repeats the TCP and IPv4 headers
+      gsoTag.SetHeaderSize (outgoingHeader.GetSerializedSize () + Ipv4Header ().GetSerializedSize ());
+      packet->AddPacketTag (gsoTag);
+    }
+
   Ptr<Ipv4> ipv4 =
     m_node->GetObject<Ipv4> ();
   if (ipv4 != 0)
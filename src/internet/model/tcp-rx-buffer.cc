@@ -18,6 +18,8 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
+
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -113,9 +115,9 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
-  else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
+  else if (m_data.size () && m_nextRxSeq > m_data.front ().m_seq)
     { // No data allowed beyond Rx window allowed
-      return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      return m_data.front ().m_seq + SequenceNumber32 (m_maxBuffer);
     }
   return m_nextRxSeq + SequenceNumber32 (m_maxBuffer);
 }
@@ -136,6 +138,43 @@ TcpRxBuffer::Finished (void)
   return (m_gotFin && m_finSeq < m_nextRxSeq);
 }
 
+TcpRxBuffer::BufIterator
+TcpRxBuffer::FindSegment (const SequenceNumber32 &seq)
+{
+  BufIterator i = std::upper_bound (m_data.begin (), m_data.end (), seq,
+                                    [] (const SequenceNumber32 &s, const Segment &segment)
+                                    { return s < segment.m_seq; });
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
+  return i;
+}
+
+TcpOptionSack::SackBlock
+TcpRxBuffer::AddInterval (const SequenceNumber32 &head, const SequenceNumber32 &tail)
+{
+  NS_LOG_FUNCTION (this << head << tail);
+
+  // The first interval which ends at or after head, and the ones after it
+  // which start at or before tail, are merged with the block
+  std::vector<TcpOptionSack::SackBlock>::iterator first =
+    std::lower_bound (m_intervals.begin (), m_intervals.end (), head,
+                      [] (const TcpOptionSack::SackBlock &interval, const SequenceNumber32 &s)
+                      { return interval.second < s; });
+  std::vector<TcpOptionSack::SackBlock>::iterator last = first;
+  TcpOptionSack::SackBlock merged (head, tail);
+  while (last != m_intervals.end () && last->first <= tail)
+    {
+      merged.first = std::min (merged.first, last->first);
+      merged.second = std::max (merged.second, last->second);
+      ++last;
+    }
+  first = m_intervals.erase (first, last);
+  m_intervals.insert (first, merged);
+  return merged;
+}
+
 bool
 TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 {
@@ -151,30 +190,31 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
   if (m_data.size ())
     {
-      SequenceNumber32 maxSeq = m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
+      SequenceNumber32 maxSeq = m_data.front ().m_seq + SequenceNumber32 (m_maxBuffer);
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end () && i->first <= tailSeq)
+  // Remove overlapped bytes from packet. The segments before the one
+  // holding headSeq end before it, and cannot overlap.
+  BufIterator i = FindSegment (headSeq);
+  while (i != m_data.end () && i->m_seq <= tailSeq)
     {
-      SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+      SequenceNumber32 lastByteSeq = i->m_seq + SequenceNumber32 (i->m_packet->GetSize ());
       if (lastByteSeq > headSeq)
         {
-          if (i->first > headSeq && lastByteSeq < tailSeq)
+          if (i->m_seq > headSeq && lastByteSeq < tailSeq)
             { // Rare case: Existing packet is embedded fully in the new packet
-              m_size -= i->second->GetSize ();
-              m_data.erase (i++);
+              m_size -= i->m_packet->GetSize ();
+              i = m_data.erase (i);
               continue;
             }
-          if (i->first <= headSeq)
+          if (i->m_seq <= headSeq)
             { // Incoming head is overlapped
               headSeq = lastByteSeq;
             }
           if (lastByteSeq >= tailSeq)
             { // Incoming tail is overlapped
-              tailSeq = i->first;
+              tailSeq = i->m_seq;
             }
         }
       ++i;
@@ -192,31 +232,30 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       p = p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
-  // Insert packet into buffer
-  NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
-  m_data [ headSeq ] = p;
+  // Insert packet into buffer, after the segments starting before it
+  i = FindSegment (headSeq);
+  if (i != m_data.end () && i->m_seq < headSeq)
+    {
+      ++i;
+    }
+  NS_ASSERT (i == m_data.end () || i->m_seq != headSeq); // Shouldn't be there yet
+  m_data.insert (i, Segment {headSeq, p});
+  TcpOptionSack::SackBlock interval = AddInterval (headSeq, tailSeq);
 
   if (headSeq > m_nextRxSeq)
     {
       // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      UpdateSackList (interval.first, interval.second);
     }
 
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  if (interval.first <= m_nextRxSeq && m_nextRxSeq < interval.second)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
+      // The block filled the hole at the head: the interval is now in order
+      m_availBytes += static_cast<uint32_t> (interval.second - m_nextRxSeq);
+      m_nextRxSeq = interval.second;
       ClearSackList (m_nextRxSeq);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
@@ -273,50 +312,20 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
 
   m_sackList.push_front (current);
 
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // The block is the whole contiguous block of buffered data containing the
+  // segment, so the blocks already reported which were merged into it are
+  // subsets of it, and should be removed.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
-  ++it;
-
-  // Iterates until we examined all blocks in the list (maximum 4)
-  while (it != m_sackList.end ())
+  for (++it; it != m_sackList.end (); )
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
+      if (it->first >= current.first && it->second <= current.second)
         {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
-        {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          ++it;
         }
-
-      ++it;
     }
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
@@ -327,9 +336,8 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     }
 
   // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
+  // to b is received, the reported block covers b too, since it is built
+  // from the buffered data and not from the blocks previously reported.
 }
 
 void
@@ -370,31 +378,43 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
-  BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
-      i = m_data.begin ();
-      NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
+      Segment &segment = m_data.front ();
+      NS_ASSERT (segment.m_seq <= m_nextRxSeq); // in-sequence data expected
       // Check if we send the whole pkt or just a partial
-      uint32_t pktSize = i->second->GetSize ();
+      uint32_t pktSize = segment.m_packet->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
-          m_data.erase (i);
+          outPkt->AddAtEnd (segment.m_packet);
+          m_data.pop_front ();
           m_size -= pktSize;
           m_availBytes -= pktSize;
           extractSize -= pktSize;
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
-          m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
-          m_data.erase (i);
+          outPkt->AddAtEnd (segment.m_packet->CreateFragment (0, extractSize));
+          segment.m_packet = segment.m_packet->CreateFragment (extractSize, pktSize - extractSize);
+          segment.m_seq += extractSize;
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
         }
     }
+  // The extracted bytes leave the first interval
+  if (m_data.empty ())
+    {
+      m_intervals.clear ();
+    }
+  else if (m_intervals.front ().second <= m_data.front ().m_seq)
+    {
+      m_intervals.erase (m_intervals.begin ());
+    }
+  else
+    {
+      m_intervals.front ().first = m_data.front ().m_seq;
+    }
   if (outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
@@ -21,7 +21,8 @@
 #ifndef TCP_RX_BUFFER_H
 #define TCP_RX_BUFFER_H
 
-#include <map>
+#include <deque>
+#include <vector>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -53,6 +54,15 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The segments are stored in a double-ended queue ordered by sequence number,
+ * where the segment holding a sequence number is found with a binary search:
+ * the segments received in order are appended at the end, and the ones
+ * extracted are removed from the front, without allocating a node for each
+ * segment. The buffer also keeps the list of the contiguous blocks of data it
+ * holds (the intervals), which are merged when a hole is filled. The interval
+ * starting at or before NextRxSequence gives the in-order data, and the other
+ * ones are the out-of-order blocks reported in the SACK list.
+ *
  * SACK list
  * ---------
  *
@@ -185,6 +195,10 @@ private:
   /**
    * \brief Update the sack list, with the block seq starting at the beginning
    *
+   * The block is the interval of contiguous data holding the segment which
+   * has just been received: the blocks reported before which are part of
+   * it are removed from the list.
+   *
    * Note: the maximum size of the block list is 4. Caller is free to
    * drop blocks at the end to accommodate header size; from RFC 2018:
    *
@@ -215,17 +229,42 @@ private:
    */
   void ClearSackList (const SequenceNumber32 &seq);
 
+  /**
+   * \brief Add a block of data to the intervals, merging it with the
+   * intervals it overlaps or touches
+   *
+   * \param head sequence number of the first byte of the block
+   * \param tail sequence number of the byte after the block
+   * \return the interval holding the block
+   */
+  TcpOptionSack::SackBlock AddInterval (const SequenceNumber32 &head, const SequenceNumber32 &tail);
+
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
+  /// A segment stored in the buffer
+  struct Segment
+  {
+    SequenceNumber32 m_seq; //!< Sequence number of the first byte
+    Ptr<Packet> m_packet;   //!< The data
+  };
   /// container for data stored in the buffer
-  typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
+  typedef std::deque<Segment>::iterator BufIterator;
+
+  /**
+   * \brief Find the segment holding a sequence number
+   * \param seq the sequence number
+   * \return the last segment starting at or before seq, or the first segment
+   * if there is none
+   */
+  BufIterator FindSegment (const SequenceNumber32 &seq);
   TracedValue<SequenceNumber32> m_nextRxSeq; //!< Seqnum of the first missing byte in data (RCV.NXT)
   SequenceNumber32 m_finSeq;                 //!< Seqnum of the FIN packet
   bool m_gotFin;                             //!< Did I received FIN packet?
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
-  std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+  std::deque<Segment> m_data;                //!< Corresponding data, ordered by sequence number
+  std::vector<TcpOptionSack::SackBlock> m_intervals; //!< Contiguous blocks of data in the buffer, ordered
 };
 
 } //namespace ns3
@@ -43,6 +43,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
 #include "ns3/object.h"
+#include "ns3/gso-tag.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
 #include "ipv4-end-point.h"
@@ -141,6 +142,15 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsoMaxSegments",
+                   "Maximum number of segments of new data sent in a single "
+                   "super-segment over IPv4 (1 disables segmentation offload). "
+                   "IPv6 connections always send single segments, and the "
+                   "receiver does not merge the segments split before a device "
+                   "without SegmentationOffload (no receive offload)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1, 64))
     .AddAttribute ("EcnMode", "Determines the mode of ECN",
                    EnumValue (EcnMode_t::NoEcn),
                    MakeEnumAccessor (&TcpSocketBase::m_ecnMode),
@@ -329,6 +339,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_tsoMaxSegments (sock.m_tsoMaxSegments),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -1873,7 +1884,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
       else if (ackNumber < m_recover && m_tcb->m_congState == TcpSocketState::CA_LOSS)
         {
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_tcb->m_lastRtt);
-          m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+          IncreaseWindow (segsAcked);
 
           NS_LOG_DEBUG (" Cong Control Called, cWnd=" << m_tcb->m_cWnd <<
                         " ssTh=" << m_tcb->m_ssThresh);
@@ -1966,7 +1977,7 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
             }
           else
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              IncreaseWindow (segsAcked);
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -2840,8 +2851,29 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
+  Ptr<Packet> p = m_txBuffer->CopyFromSequence (std::min (maxSize, m_tcb->m_segmentSize), seq);
   uint32_t sz = p->GetSize (); // Size of packet
+  if (maxSize > m_tcb->m_segmentSize)
+    {
+      // Super-segment: the data is taken one segment at a time, so that the
+      // scoreboard of m_txBuffer still tracks single segments
+      while (sz % m_tcb->m_segmentSize == 0 && sz < maxSize)
+        {
+          Ptr<Packet> segment = m_txBuffer->CopyFromSequence (std::min (maxSize - sz, m_tcb->m_segmentSize),
+                                                              seq + SequenceNumber32 (sz));
+          if (segment->GetSize () == 0)
+            {
+              break;
+            }
+          p->AddAtEnd (segment);
+          sz += segment->GetSize ();
+        }
+      if (sz > m_tcb->m_segmentSize)
+        {
+          // split at the device, or before it (see GsoTag)
+          p->AddPacketTag (GsoTag (m_tcb->m_segmentSize));
+        }
+    }
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
@@ -2992,6 +3024,22 @@ TcpSocketBase::UpdateRttHistory (const SequenceNumber32 &seq, uint32_t sz,
     }
 }
 
+void
+TcpSocketBase::IncreaseWindow (uint32_t segmentsAcked)
+{
+  NS_LOG_FUNCTION (this << segmentsAcked);
+  uint32_t delAckCount = std::max<uint32_t> (m_delAckMaxCount, 1);
+  if (m_tsoMaxSegments == 1 || segmentsAcked <= delAckCount)
+    {
+      m_congestionControl->IncreaseWindow (m_tcb, segmentsAcked);
+      return;
+    }
+  for (uint32_t acked = 0; acked < segmentsAcked; acked += delAckCount)
+    {
+      m_congestionControl->IncreaseWindow (m_tcb, std::min (delAckCount, segmentsAcked - acked));
+    }
+}
+
 // Note that this function did not implement the PSH flag
 uint32_t
 TcpSocketBase::SendPendingData (bool withAck)
@@ -3076,6 +3124,13 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_tsoMaxSegments > 1 && m_endPoint != nullptr && next == m_tcb->m_highTxMark)
+            {
+              // Segmentation offload: new data is sent in a super-segment of
+              // whole segments
+              uint32_t tso = std::min (availableWindow, m_tsoMaxSegments * m_tcb->m_segmentSize);
+              s = std::max (s, tso - tso % m_tcb->m_segmentSize);
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -3283,7 +3338,17 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      // A super-segment counts as all its segments
+      GsoTag gsoTag;
+      if (p->RemovePacketTag (gsoTag))
+        {
+          m_delAckCount += (p->GetSize () + gsoTag.GetSegmentSize () - 1) / gsoTag.GetSegmentSize ();
+        }
+      else
+        {
+          ++m_delAckCount;
+        }
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
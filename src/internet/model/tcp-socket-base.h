@@ -198,6 +198,25 @@ public:
  * available to build them) are scattered around the code. For instance,
  * the SACK option is built in SendEmptyPacket only under certain conditions.
  *
+ * Segmentation offload
+ * --------------------
+ *
+ * When the attribute "TsoMaxSegments" is greater than 1, new data is sent
+ * over IPv4 in super-segments of up to TsoMaxSegments segments, tagged with
+ * a GsoTag, which cross TCP, IP and the traffic control layer as a single
+ * packet. IPv6 connections always send single segments. The super-segment
+ * is split into its segments by Ipv4L3Protocol before a device which does
+ * not set the SegmentationOffload attribute, or sent as a burst of frames
+ * by a device which does (e.g., the PointToPointNetDevice), and then
+ * reaches the receiver as a single packet, whose delayed ACK counts it as
+ * all its segments. Retransmissions are always sent in single segments,
+ * but a super-segment is lost or acknowledged as a whole, so the loss
+ * detail is coarser than with single segments.
+ *
+ * There is no receive offload: the receiver does not merge the segments
+ * which arrive separately, so a super-segment split by Ipv4L3Protocol
+ * costs the receiver as much as the same segments sent one by one.
+ *
  * SACK
  * ----
  *
@@ -998,6 +1017,17 @@ protected:
    */
   virtual void NewAck (SequenceNumber32 const& seq, bool resetRTO);
 
+  /**
+   * \brief Ask the congestion control to increase the window after an ACK
+   *
+   * The congestion controls grow the window per ACK: with super-segments,
+   * the ACK is passed to them as the delayed ACKs of the segments would
+   * have been, one every DelAckCount segments.
+   *
+   * \param segmentsAcked the number of segments acknowledged
+   */
+  void IncreaseWindow (uint32_t segmentsAcked);
+
   /**
    * \brief Dupack management
    */
@@ -1246,6 +1276,7 @@ protected:
   SequenceNumber32       m_recover    {0};   //!< Previous highest Tx seqnum for fast recovery (set it to initial seq number)
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
+  uint32_t               m_tsoMaxSegments {1}; //!< Maximum number of segments of a super-segment
 
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
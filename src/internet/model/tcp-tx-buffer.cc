@@ -96,7 +96,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostFrontier (n), m_highestLost (n), m_nextSegHint (n)
 {
 }
 
@@ -168,7 +169,51 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_isHighestSackValid = false;
+  m_highestSack = SequenceNumber32 (0);
+  ResetLossFrontiers ();
+}
+
+void
+TcpTxBuffer::ResetLossFrontiers ()
+{
+  NS_LOG_FUNCTION (this);
+  m_lostFrontier = m_firstByteSeq;
+  m_highestLost = m_firstByteSeq + m_sentSize;
+  m_nextSegHint = m_firstByteSeq;
+}
+
+/**
+ * \brief Find the last item starting at or before a sequence number
+ * \param begin the first item of a sent list
+ * \param end the end of the sent list
+ * \param seq the sequence number
+ * \return the last item starting at or before seq, or begin if there is none
+ */
+template <class Iterator>
+static Iterator
+FindItem (Iterator begin, Iterator end, const SequenceNumber32 &seq)
+{
+  Iterator it = std::upper_bound (begin, end, seq,
+                                  [] (const SequenceNumber32 &s, const TcpTxItem *item)
+                                  { return s < item->m_startSeq; });
+  if (it != begin)
+    {
+      --it;
+    }
+  return it;
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq)
+{
+  return FindItem (m_sentList.begin (), m_sentList.end (), seq);
+}
+
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  return FindItem (m_sentList.begin (), m_sentList.end (), seq);
 }
 
 bool
@@ -308,36 +353,32 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  auto it = FindSentItem (seq);
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if ((*it)->m_startSeq == seq)
     {
-      if ((*it)->m_startSeq == seq)
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -352,29 +393,6 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   return item;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-TcpTxBuffer::FindHighestSacked () const
-{
-  NS_LOG_FUNCTION (this);
-
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
-    {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          ret = std::make_pair (it, beginOfCurrentPacket);
-        }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
-    }
-
-  return ret;
-}
-
-
 void
 TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 {
@@ -435,11 +453,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  // The items of the sent list know their sequence number: start from the
+  // one holding seq instead of walking the list from the head
+  if (&list == &m_sentList && !list.empty ())
+    {
+      it = FindItem (list.begin (), list.end (), seq);
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (&list != &m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -615,6 +641,12 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
           self->m_retrans -= t2->m_packet->GetSize ();
           t2->m_retrans = false;
         }
+      // Only sent items are retransmitted: a lost byte of the merged item
+      // may have to be retransmitted again
+      if (t1->m_startSeq < m_nextSegHint)
+        {
+          m_nextSegHint = t1->m_startSeq;
+        }
     }
 
   if (t1->m_lastSent < t2->m_lastSent)
@@ -735,6 +767,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          m_lostFrontier = m_firstByteSeq;
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -745,9 +778,24 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
                      m_firstByteSeq << " this is the result: " << *this);
     }
 
-  if (m_highestSack.second <= m_firstByteSeq)
+  if (m_highestSack <= m_firstByteSeq)
     {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_isHighestSackValid = false;
+      m_highestSack = SequenceNumber32 (0);
+    }
+
+  // Keep the frontiers inside the window, where the sequence numbers compare
+  if (m_lostFrontier < m_firstByteSeq)
+    {
+      m_lostFrontier = m_firstByteSeq;
+    }
+  if (m_highestLost < m_firstByteSeq)
+    {
+      m_highestLost = m_firstByteSeq;
+    }
+  if (m_nextSegHint < m_firstByteSeq)
+    {
+      m_nextSegHint = m_firstByteSeq;
     }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
@@ -768,14 +816,20 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
+      if (m_sentList.empty ())
+        {
+          continue;
+        }
+
+      // Start from the item holding the beginning of the block: the items
+      // before it cannot be covered by the block
+      PacketList::iterator item_it = FindSentItem ((*option_it).first);
+      SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
 
       while (item_it != m_sentList.end ())
         {
@@ -807,16 +861,17 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
                   (*item_it)->m_sacked = true;
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
 
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
+                  if (!m_isHighestSackValid
+                      || m_highestSack <= beginOfCurrentPacket + pktSize)
                     {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+                      m_isHighestSackValid = true;
+                      m_highestSack = beginOfCurrentPacket;
                     }
 
                   NS_LOG_INFO ("Received block " << *option_it <<
                                ", checking sentList for block " << *(*item_it) <<
                                ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
+                               m_highestSack);
                 }
               modified = true;
             }
@@ -836,7 +891,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   if (modified)
     {
-      NS_ASSERT_MSG (modified && m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
+      NS_ASSERT_MSG (modified && m_isHighestSackValid, "Buffer status: " << *this);
       UpdateLostCount ();
     }
 
@@ -852,46 +907,62 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_isHighestSackValid);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
-    }
+  PacketList::iterator it = FindSentItem (m_highestSack);
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *(*it));
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // Find the highest item with dupThresh sacked items at or above it (the
+  // head is never sacked, and is not counted)
+  for (; it != m_sentList.begin (); --it)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
+      if ((*it)->m_sacked)
         {
           sacked++;
         }
-
       if (sacked >= m_dupAckThresh)
         {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
+          break;
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
     }
 
-  if (sacked >= m_dupAckThresh)
+  if (sacked < m_dupAckThresh)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      NS_LOG_INFO ("Less than " << m_dupAckThresh << " items sacked, nothing is lost");
+      return;
+    }
+
+  // Every item from there down to the head is lost, unless sacked. The items
+  // below m_lostFrontier are already sacked or lost.
+  SequenceNumber32 lossPoint = (*it)->m_startSeq + (*it)->m_packet->GetSize ();
+  NS_LOG_INFO ("Marking as lost the items from " << m_lostFrontier << " to " << lossPoint);
+  while ((*it)->m_startSeq >= m_lostFrontier)
+    {
+      TcpTxItem *item = *it;
+      if (!item->m_sacked && !item->m_lost)
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          if (item->m_startSeq < m_nextSegHint)
+            {
+              m_nextSegHint = item->m_startSeq;
+            }
+          if (m_highestLost < item->m_startSeq + item->m_packet->GetSize ())
+            {
+              m_highestLost = item->m_startSeq + item->m_packet->GetSize ();
+            }
         }
+      if (it == m_sentList.begin ())
+        {
+          break;
+        }
+      --it;
+    }
+
+  if (m_lostFrontier < lossPoint)
+    {
+      m_lostFrontier = lossPoint;
     }
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
@@ -902,35 +973,31 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
-  if (seq >= m_highestSack.second)
+  if (seq >= m_highestSack || m_sentList.empty ())
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Look at the items starting at or after seq, up to the first one which
+  // is lost or sacked (the highest sacked item at most)
+  PacketList::const_iterator it = FindSentItem (seq);
+  if ((*it)->m_startSeq < seq)
+    {
+      ++it;
+    }
+  for (; it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it)->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -956,33 +1023,26 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    */
   PacketList::const_iterator it;
   TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // No byte below m_nextSegHint, nor at or above m_highestLost, meets the
+  // three criteria: only look at the items in between
+  if (m_nextSegHint < m_highestLost && !m_sentList.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      for (it = FindSentItem (m_nextSegHint);
+           it != m_sentList.end () && (*it)->m_startSeq < m_highestLost; ++it)
         {
-          if (item->m_lost)
+          item = *it;
+
+          // Condition 1.a , 1.b , and 1.c
+          if (item->m_retrans == false && item->m_sacked == false && item->m_lost)
             {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
+              NS_LOG_INFO("IsLost, returning" << item->m_startSeq);
+              m_nextSegHint = item->m_startSeq;
+              *seq = item->m_startSeq;
               return true;
             }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      m_nextSegHint = m_highestLost;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,6 +1068,23 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
+  SequenceNumber32 seqPerRule3;
+  bool isSeqPerRule3Valid = false;
+
+  for (it = m_sentList.begin ();
+       isRecovery && it != m_sentList.end () && seqPerRule3.GetValue () == 0; ++it)
+    {
+      item = *it;
+
+      // Condition 1.a and 1.b
+      if (item->m_retrans == false && item->m_sacked == false && !item->m_lost)
+        {
+          NS_LOG_INFO ("Saving for rule 3 the seq " << item->m_startSeq);
+          isSeqPerRule3Valid = true;
+          seqPerRule3 = item->m_startSeq;
+        }
+    }
+
   if (isSeqPerRule3Valid)
     {
       NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
@@ -1156,7 +1233,7 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
             }
         }
 
-      if (beginOfCurrentPacket >= m_highestSack.second)
+      if (beginOfCurrentPacket >= m_highestSack)
         {
           if (item->m_lost && !item->m_retrans)
             return true;
@@ -1167,10 +1244,7 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
 
       beginOfCurrentPacket += current->GetSize ();
     }
-  if (it == m_highestSack.first)
-    {
-      NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead " << m_highestSack.second);
-    }
+  NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead " << m_highestSack);
   return false;
 }
 
@@ -1185,7 +1259,9 @@ TcpTxBuffer::ResetRenoSack ()
       (*it)->m_sacked = false;
     }
 
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_isHighestSackValid = false;
+  m_highestSack = SequenceNumber32 (0);
+  ResetLossFrontiers ();
 }
 
 void
@@ -1207,7 +1283,9 @@ TcpTxBuffer::ResetSentList ()
   m_lostOut = 0;
   m_retrans = 0;
   m_sackedOut = 0;
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_isHighestSackValid = false;
+  m_highestSack = SequenceNumber32 (0);
+  ResetLossFrontiers ();
 }
 
 void
@@ -1225,6 +1303,12 @@ TcpTxBuffer::ResetLastSegmentSent ()
           m_retrans -= item->m_packet->GetSize ();
         }
       m_appList.insert (m_appList.begin (), item);
+
+      // The item will be sent again
+      if (m_firstByteSeq + m_sentSize < m_lostFrontier)
+        {
+          m_lostFrontier = m_firstByteSeq + m_sentSize;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1239,7 +1323,8 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
     {
       m_sackedOut = 0;
       m_lostOut = m_sentSize;
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_isHighestSackValid = false;
+      m_highestSack = SequenceNumber32 (0);
     }
   else
     {
@@ -1271,6 +1356,11 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       (*it)->m_retrans = false;
     }
 
+  // Every item is now sacked or lost, and may be retransmitted
+  m_lostFrontier = m_firstByteSeq + m_sentSize;
+  m_highestLost = m_firstByteSeq + m_sentSize;
+  m_nextSegHint = m_firstByteSeq;
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1303,6 +1393,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      m_nextSegHint = m_firstByteSeq;
     }
   ConsistencyCheck ();
 }
@@ -1332,6 +1423,13 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      // The head may have to be retransmitted
+      m_nextSegHint = m_firstByteSeq;
+      if (m_highestLost < m_firstByteSeq + m_sentList.front ()->m_packet->GetSize ())
+        {
+          m_highestLost = m_firstByteSeq + m_sentList.front ()->m_packet->GetSize ();
+        }
     }
   ConsistencyCheck ();
 }
@@ -1358,7 +1456,8 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
-      m_highestSack = std::make_pair (it, (*it)->m_startSeq);
+      m_isHighestSackValid = true;
+      m_highestSack = (*it)->m_startSeq;
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
   else
@@ -1398,6 +1497,15 @@ TcpTxBuffer::ConsistencyCheck () const
         {
           retrans += (*it)->m_packet->GetSize ();
         }
+
+      SequenceNumber32 end = (*it)->m_startSeq + (*it)->m_packet->GetSize ();
+      NS_ASSERT_MSG ((*it)->m_startSeq >= m_lostFrontier || (*it)->m_sacked || (*it)->m_lost,
+                     "Item " << *(*it) << " below the lost frontier " << m_lostFrontier);
+      NS_ASSERT_MSG (end <= m_highestLost || !(*it)->m_lost,
+                     "Item " << *(*it) << " above the highest lost byte " << m_highestLost);
+      NS_ASSERT_MSG ((*it)->m_startSeq >= m_nextSegHint || (*it)->m_sacked
+                     || (*it)->m_retrans || !(*it)->m_lost,
+                     "Item " << *(*it) << " below the NextSeg hint " << m_nextSegHint);
     }
 
   NS_ASSERT_MSG (sacked == m_sackedOut, "Counted SACK: " << sacked <<
@@ -22,6 +22,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <deque>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -102,8 +104,16 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding the
+ * segments covered by a SACK block and setting their SACK flag.
+ *
+ * The items of the SentList are stored in a double-ended queue, ordered by
+ * their starting sequence number and without holes between them, so that
+ * the item holding a given sequence number is found with a binary search
+ * instead of walking the list from the head. The ACKed items are removed
+ * from the front, and the new ones appended to the back, in constant time.
+ * Each SACK block therefore costs a search plus the items it covers, and
+ * not the size of the window.
  *
  * Item properties
  * ---------------
@@ -146,6 +156,15 @@ public:
  * connection, the TcpSocketImplementation should provide hints through
  * the MarkHeadAsLost and AddRenoSack methods.
  *
+ * The lost segments are found incrementally: the buffer remembers the
+ * sequence number below which every segment is either sacked or lost
+ * (m_lostFrontier), and UpdateLostCount only marks the segments between it
+ * and the new loss point. In the same way, NextSeg starts looking for a
+ * lost segment to retransmit from the last one it returned (m_nextSegHint)
+ * and stops after the highest lost byte (m_highestLost), so that the
+ * counters of lost, sacked and retransmitted bytes are kept up to date
+ * without walking the whole window on each ACK.
+ *
  * \see BytesInFlight
  * \see Size
  * \see SizeFromSequence
@@ -409,7 +428,7 @@ public:
 private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
-  typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::deque<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
   /**
    * \brief Update the lost count
@@ -426,12 +445,38 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
-   *
+   * and updates the lost count. It walks down from the highest sacked item
+   * until dupThresh sacked items are found, and then marks the items below
+   * down to m_lostFrontier only, since the ones below it are already sacked
+   * or lost.
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Find the item of the sent list holding a sequence number
+   * \param seq the sequence number
+   * \return the last item starting at or before seq, or the first item if
+   * seq is before it
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq);
+
+  /**
+   * \brief Find the item of the sent list holding a sequence number
+   * \param seq the sequence number
+   * \return the last item starting at or before seq, or the first item if
+   * seq is before it
+   */
+  PacketList::const_iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Reset the loss detection state after the flags of the sent list
+   * changed in bulk
+   *
+   * Nothing is assumed about the items of the sent list anymore: the next
+   * UpdateLostCount and NextSeg start from the head.
+   */
+  void ResetLossFrontiers ();
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -592,13 +637,6 @@ private:
    */
   void ConsistencyCheck () const;
 
-  /**
-   * \brief Find the highest SACK byte
-   * \return a pair with the highest byte and an iterator inside m_sentList
-   */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-  FindHighestSacked () const;
-
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
@@ -606,7 +644,8 @@ private:
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  bool m_isHighestSackValid {false}; //!< Indicates if some item has been sacked
+  SequenceNumber32 m_highestSack {0}; //!< Start of the highest sacked item, if valid
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
@@ -616,6 +655,10 @@ private:
   uint32_t m_segmentSize {0}; //!< Segment size from TcpSocketBase
   bool     m_renoSack {false}; //!< Indicates if AddRenoSack was called
 
+  SequenceNumber32 m_lostFrontier; //!< Every item starting below it is sacked or lost
+  SequenceNumber32 m_highestLost;  //!< No byte at or above it is lost
+  mutable SequenceNumber32 m_nextSegHint; //!< No byte below it is lost and neither sacked nor retransmitted
+
 };
 
 /**
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "../model/ipv6-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux Lookup test
+ *
+ * Checks that the most exact endpoint is found, including after a change
+ * of the peer of an endpoint and after a deallocation.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Look up the endpoint receiving a packet.
+   * \param demux the demultiplexer
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \return the endpoint, or 0 if none matches
+   */
+  Ipv4EndPoint *Lookup (Ipv4EndPointDemux &demux, const char *daddr, uint16_t dport,
+                        const char *saddr, uint16_t sport);
+
+  Ptr<Ipv4Interface> m_interface; //!< Incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup")
+{
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::Lookup (Ipv4EndPointDemux &demux, const char *daddr, uint16_t dport,
+                                   const char *saddr, uint16_t sport)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (Ipv4Address (daddr), dport,
+                                                         Ipv4Address (saddr), sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  m_interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.1.1.1"), Ipv4Mask ("255.255.255.0")));
+
+  Ipv4EndPointDemux demux;
+
+  // listening endpoint and connections forked from it
+  Ipv4EndPoint *listener = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "The listener should be allocated");
+  Ipv4EndPoint *first = demux.Allocate (0, Ipv4Address ("10.1.1.1"), 80, Ipv4Address ("10.1.1.2"), 1000);
+  Ipv4EndPoint *second = demux.Allocate (0, Ipv4Address ("10.1.1.1"), 80, Ipv4Address ("10.1.1.2"), 1001);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, Ipv4Address ("10.1.1.1"), 80, Ipv4Address ("10.1.1.2"), 1000), 0,
+                         "A duplicated connection should not be allocated");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (0, 80), 0, "A duplicated listener should not be allocated");
+
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 80, "10.1.1.2", 1000), first, "Exact match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 80, "10.1.1.2", 1001), second, "Exact match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 80, "10.1.1.2", 1002), listener, "Wildcard match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 81, "10.1.1.2", 1000), 0, "No match expected");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (Ipv4Address ("10.1.1.1"), 80, Ipv4Address ("10.1.1.2"), 1001), second,
+                         "Exact match expected");
+
+  // disabled endpoints are skipped
+  first->SetRxEnabled (false);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 80, "10.1.1.2", 1000), listener, "Wildcard match expected");
+  first->SetRxEnabled (true);
+
+  // a local address match is preferred to a wildcard
+  Ipv4EndPoint *anyAddress = demux.Allocate (0, 81);
+  Ipv4EndPoint *localAddress = demux.Allocate (0, Ipv4Address ("10.1.1.1"), 81);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 81, "10.1.1.2", 1000), localAddress, "Local address match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.255", 81, "10.1.1.2", 1000), anyAddress, "Wildcard match expected");
+
+  // subnet-directed broadcast
+  Ipv4EndPoint *subnet = demux.Allocate (0, Ipv4Address ("10.1.1.0"), 82);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.255", 82, "10.1.1.2", 1000), subnet, "Subnet match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.2.255", 82, "10.1.1.2", 1000), 0, "No match expected");
+
+  // the endpoints of the connecting sockets get their peer after their allocation
+  Ipv4EndPoint *client = demux.Allocate (Ipv4Address ("10.1.1.1"));
+  uint16_t clientPort = client->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (clientPort), true, "The ephemeral port should be in use");
+  client->SetPeer (Ipv4Address ("10.1.1.3"), 443);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", clientPort, "10.1.1.3", 443), client, "Exact match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", clientPort, "10.1.1.4", 443), 0, "No match expected");
+  client->SetLocalAddress (Ipv4Address ("10.1.1.5"));
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", clientPort, "10.1.1.3", 443), 0, "No match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.5", clientPort, "10.1.1.3", 443), client, "Exact match expected");
+
+  // deallocation
+  demux.DeAllocate (first);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "10.1.1.1", 80, "10.1.1.2", 1000), listener, "Wildcard match expected");
+  demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (clientPort), false, "The ephemeral port should be free");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "The port should still be in use");
+  demux.DeAllocate (second);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "The port should be free");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 3, "Three endpoints should be left");
+
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux Lookup test
+ *
+ * Checks that the most exact endpoint is found, including after a change
+ * of the peer of an endpoint and after a deallocation.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Look up the endpoint receiving a packet.
+   * \param demux the demultiplexer
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \return the endpoint, or 0 if none matches
+   */
+  Ipv6EndPoint *Lookup (Ipv6EndPointDemux &demux, const char *daddr, uint16_t dport,
+                        const char *saddr, uint16_t sport);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookup")
+{
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::Lookup (Ipv6EndPointDemux &demux, const char *daddr, uint16_t dport,
+                                   const char *saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (Ipv6Address (daddr), dport,
+                                                         Ipv6Address (saddr), sport, 0);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+
+  Ipv6EndPoint *listener = demux.Allocate (0, 80);
+  Ipv6EndPoint *connection = demux.Allocate (0, Ipv6Address ("2001::1"), 80, Ipv6Address ("2001::2"), 1000);
+  Ipv6EndPoint *localAddress = demux.Allocate (0, Ipv6Address ("2001::1"), 81);
+  Ipv6EndPoint *anyAddress = demux.Allocate (0, 81);
+
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", 80, "2001::2", 1000), connection, "Exact match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", 80, "2001::2", 1001), listener, "Wildcard match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", 81, "2001::2", 1000), localAddress, "Local address match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::3", 81, "2001::2", 1000), anyAddress, "Wildcard match expected");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", 82, "2001::2", 1000), 0, "No match expected");
+
+  // the endpoints of the connecting sockets get their peer after their allocation
+  Ipv6EndPoint *client = demux.Allocate (Ipv6Address ("2001::1"));
+  uint16_t clientPort = client->GetLocalPort ();
+  client->SetPeer (Ipv6Address ("2001::3"), 443);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", clientPort, "2001::3", 443), client, "Exact match expected");
+  client->SetLocalPort (83);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (clientPort), false, "The ephemeral port should be free");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", 83, "2001::3", 443), client, "Exact match expected");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (Ipv6Address ("2001::1"), 83, Ipv6Address ("2001::3"), 443), client,
+                         "Exact match expected");
+
+  demux.DeAllocate (connection);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (demux, "2001::1", 80, "2001::2", 1000), listener, "Wildcard match expected");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "The port should be free");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 3, "Three endpoints should be left");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux and Ipv6EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
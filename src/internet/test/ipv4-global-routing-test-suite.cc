@@ -15,8 +15,10 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-value.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -1244,6 +1246,365 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes computed by several threads are the ones
+ * computed by a single thread.
+ *
+ * The nodes form a grid whose neighbours are joined by point-to-point
+ * links, so that there are many equal-cost paths between the nodes.
+ */
+class Ipv4GlobalRoutingThreadsTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingThreadsTestCase ();
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  /**
+   * \returns the routing tables of all the nodes.
+   */
+  std::string GetRoutes (void) const;
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingThreadsTestCase::Ipv4GlobalRoutingThreadsTestCase ()
+  : TestCase ("Global routes computed by several threads")
+{
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoSetup (void)
+{
+  const uint32_t size = 6;
+  m_nodes.Create (size * size);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < size * size; i++)
+    {
+      std::vector<uint32_t> neighbours;
+      if ((i + 1) % size != 0)
+        {
+          neighbours.push_back (i + 1);
+        }
+      if (i + size < size * size)
+        {
+          neighbours.push_back (i + size);
+        }
+      for (uint32_t j = 0; j < neighbours.size (); j++)
+        {
+          Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+          NetDeviceContainer net = simpleHelper.Install (m_nodes.Get (i), channel);
+          net.Add (simpleHelper.Install (m_nodes.Get (neighbours[j]), channel));
+          ipv4.Assign (net);
+          ipv4.NewNetwork ();
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
+std::string
+Ipv4GlobalRoutingThreadsTestCase::GetRoutes (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = globalRouting->GetRoute (j);
+          oss << i << " " << *route << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoRun (void)
+{
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string routes = GetRoutes ();
+  NS_TEST_ASSERT_MSG_NE (routes, "", "no routes computed");
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (GetRoutes (), routes, "the threads computed different routes");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes updated after interfaces go down and up
+ * are the ones computed from scratch.
+ *
+ * The nodes form a grid whose neighbours are joined by point-to-point
+ * links, and an island of three nodes on a broadcast link, two of them
+ * joined to a fourth node by point-to-point links.  The changes bring
+ * interfaces down and up, and change their metrics, which gives new
+ * shortest paths and equal-cost paths.  The network of the island is
+ * never reached through equal-cost paths, which the global routing does
+ * not support.  The updates run with the trees of all the nodes kept, of
+ * some of them, and of none.  The routes added by hand are removed by an
+ * update, as by a full recompute.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param maxTreeMemory the largest memory taken by the shortest-path
+   * trees kept
+   */
+  Ipv4GlobalRoutingUpdateTestCase (uint64_t maxTreeMemory);
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+private:
+  /**
+   * \returns the routing tables of all the nodes.
+   */
+  std::string GetRoutes (void) const;
+  /**
+   * Update the routes, and check them against the routes computed from
+   * scratch.
+   * \param step a description of the change
+   */
+  void CheckUpdate (std::string step);
+  /**
+   * \param i the index of a node
+   * \returns the global routing of the node
+   */
+  Ptr<Ipv4GlobalRouting> GetGlobalRouting (uint32_t i) const;
+  /**
+   * \param i the index of a node, the nodes of the island following the
+   * nodes of the grid
+   * \returns the node
+   */
+  Ptr<Node> GetNode (uint32_t i) const;
+  /**
+   * Change the metric of an interface, and check the update.
+   * \param node the index of the node
+   * \param interface the interface of the node
+   * \param metric the new metric
+   */
+  void CheckMetric (uint32_t node, uint32_t interface, uint16_t metric);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+  NodeContainer m_island; //!< Nodes which are not connected to m_nodes.
+  uint64_t m_maxTreeMemory; //!< The largest memory taken by the shortest-path trees kept.
+  UintegerValue m_defaultTreeMemory; //!< The bound of the other tests.
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase (uint64_t maxTreeMemory)
+  : TestCase ("Global routes updated after interface events, " + std::to_string (maxTreeMemory)
+              + " bytes of trees kept"),
+    m_maxTreeMemory (maxTreeMemory)
+{
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoSetup (void)
+{
+  const uint32_t size = 5;
+  m_nodes.Create (size * size);
+  m_island.Create (4);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+  internet.Install (m_island);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < size * size; i++)
+    {
+      std::vector<uint32_t> neighbours;
+      if ((i + 1) % size != 0)
+        {
+          neighbours.push_back (i + 1);
+        }
+      if (i + size < size * size)
+        {
+          neighbours.push_back (i + size);
+        }
+      for (uint32_t j = 0; j < neighbours.size (); j++)
+        {
+          Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+          NetDeviceContainer net = simpleHelper.Install (m_nodes.Get (i), channel);
+          net.Add (simpleHelper.Install (m_nodes.Get (neighbours[j]), channel));
+          ipv4.Assign (net);
+          ipv4.NewNetwork ();
+        }
+    }
+
+  SimpleNetDeviceHelper lanHelper;
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NodeContainer lanNodes (m_island.Get (0), m_island.Get (1), m_island.Get (2));
+  NetDeviceContainer lan = lanHelper.Install (lanNodes, channel);
+  ipv4.SetBase ("192.168.1.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  ipv4.SetBase ("192.168.2.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 3; i += 2)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (m_island.Get (3), channel);
+      net.Add (simpleHelper.Install (m_island.Get (i), channel));
+      ipv4.Assign (net);
+      ipv4.NewNetwork ();
+    }
+  // the fourth node reaches the network of the island through the first one
+  m_island.Get (3)->GetObject<Ipv4> ()->SetMetric (2, 2);
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("GlobalRoutingMaxSpfTreeMemory", m_defaultTreeMemory);
+  Simulator::Destroy ();
+}
+
+Ptr<Node>
+Ipv4GlobalRoutingUpdateTestCase::GetNode (uint32_t i) const
+{
+  return i < m_nodes.GetN () ? m_nodes.Get (i) : m_island.Get (i - m_nodes.GetN ());
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingUpdateTestCase::GetGlobalRouting (uint32_t i) const
+{
+  return GetNode (i)->GetObject<Ipv4L3Protocol> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+}
+
+std::string
+Ipv4GlobalRoutingUpdateTestCase::GetRoutes (void) const
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_nodes.GetN () + m_island.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = GetGlobalRouting (i);
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = globalRouting->GetRoute (j);
+          oss << i << " " << *route << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::CheckUpdate (std::string step)
+{
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  std::string routes = GetRoutes ();
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (routes, GetRoutes (), "wrong routes after " << step);
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::CheckMetric (uint32_t node, uint32_t interface, uint16_t metric)
+{
+  GetNode (node)->GetObject<Ipv4> ()->SetMetric (interface, metric);
+  std::ostringstream oss;
+  oss << "node " << node << " interface " << interface << " metric " << metric;
+  CheckUpdate (oss.str ());
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  GlobalValue::GetValueByName ("GlobalRoutingMaxSpfTreeMemory", m_defaultTreeMemory);
+  Config::SetGlobal ("GlobalRoutingMaxSpfTreeMemory", UintegerValue (m_maxTreeMemory));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  // the first update keeps the trees, and the second one uses them
+  CheckUpdate ("no change");
+  CheckUpdate ("no change again");
+
+  // bring some links of the grid down one after the other, then up again
+  uint32_t links[][2] = { { 0, 1 }, { 12, 2 }, { 6, 3 }, { 24, 1 }, { 18, 4 } };
+  for (uint32_t k = 0; k < 5; k++)
+    {
+      Ptr<Ipv4> ipv4 = m_nodes.Get (links[k][0])->GetObject<Ipv4> ();
+      ipv4->SetDown (links[k][1]);
+      std::ostringstream oss;
+      oss << "node " << links[k][0] << " interface " << links[k][1] << " down";
+      CheckUpdate (oss.str ());
+    }
+  for (uint32_t k = 0; k < 5; k++)
+    {
+      Ptr<Ipv4> ipv4 = m_nodes.Get (links[k][0])->GetObject<Ipv4> ();
+      ipv4->SetUp (links[k][1]);
+      std::ostringstream oss;
+      oss << "node " << links[k][0] << " interface " << links[k][1] << " up";
+      CheckUpdate (oss.str ());
+    }
+  Ptr<Ipv4> ipv4 = m_island.Get (2)->GetObject<Ipv4> ();
+  ipv4->SetDown (1);
+  CheckUpdate ("island node 2 down");
+  ipv4->SetUp (1);
+  CheckUpdate ("island node 2 up");
+
+  // longer and shorter links, some of them giving equal-cost paths
+  CheckMetric (0, 1, 3);
+  CheckMetric (12, 2, 2);
+  CheckMetric (12, 3, 2);
+  CheckMetric (7, 1, 5);
+  CheckMetric (0, 1, 1);
+  CheckMetric (12, 2, 1);
+  CheckMetric (7, 1, 1);
+  CheckMetric (12, 3, 1);
+
+  // the fourth node of the island reaches its network through the third
+  // node, then through the first one again
+  uint32_t island = m_nodes.GetN ();
+  CheckMetric (island, 1, 3);
+  CheckMetric (island + 3, 2, 4);
+  CheckMetric (island, 1, 1);
+  CheckMetric (island + 3, 2, 2);
+  ipv4 = m_island.Get (0)->GetObject<Ipv4> ();
+  ipv4->SetDown (1);
+  CheckUpdate ("island node 0 down");
+  ipv4->SetUp (1);
+  CheckUpdate ("island node 0 up");
+
+  // the routes added by hand are removed, even from the nodes whose tree
+  // the change does not touch, such as the nodes of the island.
+  Ptr<Ipv4GlobalRouting> islandRouting = GetGlobalRouting (m_nodes.GetN ());
+  uint32_t nRoutes = islandRouting->GetNRoutes ();
+  islandRouting->AddHostRouteTo (Ipv4Address ("172.16.0.1"), Ipv4Address ("192.168.1.2"), 1);
+  GetGlobalRouting (24)->AddHostRouteTo (Ipv4Address ("172.16.0.1"), 1);
+  m_nodes.Get (0)->GetObject<Ipv4> ()->SetDown (1);
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (islandRouting->GetNRoutes (), nRoutes, "the route added by hand was kept");
+  std::string routes = GetRoutes ();
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (routes, GetRoutes (), "wrong routes after routes added by hand");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1628,11 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingThreadsTestCase, TestCase::QUICK);
+    // a tree of the update test takes 30 vertices, that is 1200 bytes
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (1024 * 1024), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (12000), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase (0), TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,245 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 prefix trie test on a few nested prefixes.
+ */
+class Ipv4PrefixTrieBasicTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieBasicTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4PrefixTrieBasicTestCase::Ipv4PrefixTrieBasicTestCase ()
+  : TestCase ("Insert, find, match and erase nested prefixes")
+{
+}
+
+void
+Ipv4PrefixTrieBasicTestCase::DoRun (void)
+{
+  Ipv4PrefixTrie<int> trie;
+  int *matches[Ipv4PrefixTrie<int>::MAX_MATCHES];
+
+  NS_TEST_ASSERT_MSG_EQ (trie.IsEmpty (), true, "New trie not empty");
+  NS_TEST_ASSERT_MSG_EQ (trie.Match (Ipv4Address ("10.1.2.3"), matches), 0u, "Match in an empty trie");
+
+  trie.Insert (Ipv4Address ("10.1.0.0"), 16) = 16;
+  trie.Insert (Ipv4Address ("10.1.2.3"), 32) = 32;
+  trie.Insert (Ipv4Address ("0.0.0.0"), 0) = 0;
+  // the host bits of the network address are ignored.
+  trie.Insert (Ipv4Address ("10.7.7.7"), 8) = 8;
+  trie.Insert (Ipv4Address ("10.2.0.0"), 16) = 162;
+
+  NS_TEST_ASSERT_MSG_EQ (trie.IsEmpty (), false, "Trie should not be empty");
+  NS_TEST_ASSERT_MSG_NE (trie.Find (Ipv4Address ("10.0.0.0"), 8), 0, "Prefix not found");
+  NS_TEST_ASSERT_MSG_EQ (*trie.Find (Ipv4Address ("10.0.0.0"), 8), 8, "Wrong value");
+  NS_TEST_ASSERT_MSG_EQ (trie.Find (Ipv4Address ("10.1.0.0"), 24), 0, "Unexpected prefix");
+  NS_TEST_ASSERT_MSG_EQ (trie.Find (Ipv4Address ("10.0.0.0"), 12), 0, "Unexpected prefix");
+
+  NS_TEST_ASSERT_MSG_EQ (trie.Match (Ipv4Address ("10.1.2.3"), matches), 4u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (*matches[0], 32, "Longest prefix not first");
+  NS_TEST_ASSERT_MSG_EQ (*matches[1], 16, "Wrong second match");
+  NS_TEST_ASSERT_MSG_EQ (*matches[2], 8, "Wrong third match");
+  NS_TEST_ASSERT_MSG_EQ (*matches[3], 0, "Default route not last");
+  NS_TEST_ASSERT_MSG_EQ (trie.Match (Ipv4Address ("10.2.9.9"), matches), 3u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (*matches[0], 162, "Wrong longest match");
+  NS_TEST_ASSERT_MSG_EQ (trie.Match (Ipv4Address ("192.168.0.1"), matches), 1u, "Wrong number of matches");
+
+  trie.Erase (Ipv4Address ("10.1.0.0"), 16);
+  trie.Erase (Ipv4Address ("10.3.0.0"), 16);
+  NS_TEST_ASSERT_MSG_EQ (trie.Find (Ipv4Address ("10.1.0.0"), 16), 0, "Prefix not erased");
+  NS_TEST_ASSERT_MSG_EQ (trie.Match (Ipv4Address ("10.1.2.3"), matches), 3u, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (*matches[0], 32, "Wrong longest match");
+  NS_TEST_ASSERT_MSG_EQ (*matches[1], 8, "Wrong second match");
+
+  trie.Erase (Ipv4Address ("0.0.0.0"), 0);
+  NS_TEST_ASSERT_MSG_EQ (trie.Match (Ipv4Address ("192.168.0.1"), matches), 0u, "Default route not erased");
+
+  trie.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (trie.IsEmpty (), true, "Trie not cleared");
+}
+
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 prefix trie test against a linear scan of random prefixes.
+ */
+class Ipv4PrefixTrieRandomTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A prefix: the network bits and the prefix length.
+  typedef std::pair<uint32_t, uint8_t> Prefix;
+  /// The reference table, from prefix to value.
+  typedef std::map<Prefix, uint32_t> Table;
+
+  /**
+   * Check the matches of random addresses against a linear scan.
+   * \param trie The trie.
+   * \param table The prefixes and values inserted in the trie.
+   * \param rng The random number generator.
+   */
+  void CheckMatches (const Ipv4PrefixTrie<uint32_t> &trie, const Table &table,
+                     Ptr<UniformRandomVariable> rng);
+  /**
+   * \param rng The random number generator.
+   * \returns A random address in one of a few /8 networks.
+   */
+  static uint32_t GetRandomAddress (Ptr<UniformRandomVariable> rng);
+  /**
+   * \param length A prefix length.
+   * \returns The mask of the prefix length.
+   */
+  static uint32_t GetMask (uint8_t length);
+};
+
+Ipv4PrefixTrieRandomTestCase::Ipv4PrefixTrieRandomTestCase ()
+  : TestCase ("Match random addresses against a linear scan of random prefixes")
+{
+}
+
+uint32_t
+Ipv4PrefixTrieRandomTestCase::GetMask (uint8_t length)
+{
+  return (length == 0) ? 0 : 0xffffffff << (32 - length);
+}
+
+uint32_t
+Ipv4PrefixTrieRandomTestCase::GetRandomAddress (Ptr<UniformRandomVariable> rng)
+{
+  // few different networks, and fewer bits in the middle, so that the
+  // prefixes overlap a lot.
+  uint32_t network = rng->GetInteger (10, 13) << 24;
+  return network | (rng->GetInteger (0, 15) << 16) | rng->GetInteger (0, 0xffff);
+}
+
+void
+Ipv4PrefixTrieRandomTestCase::CheckMatches (const Ipv4PrefixTrie<uint32_t> &trie, const Table &table,
+                                            Ptr<UniformRandomVariable> rng)
+{
+  uint32_t *matches[Ipv4PrefixTrie<uint32_t>::MAX_MATCHES];
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      uint32_t address = GetRandomAddress (rng);
+      // the values of the matching prefixes, longest prefix first.
+      std::vector<uint32_t> expected;
+      for (int length = 32; length >= 0; length--)
+        {
+          Table::const_iterator it = table.find (Prefix (address & GetMask (length), length));
+          if (it != table.end ())
+            {
+              expected.push_back (it->second);
+            }
+        }
+      uint32_t n = trie.Match (Ipv4Address (address), matches);
+      NS_TEST_ASSERT_MSG_EQ (n, expected.size (), "Wrong number of matches for " << Ipv4Address (address));
+      for (uint32_t j = 0; j < n; j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (*matches[j], expected[j], "Wrong match for " << Ipv4Address (address));
+        }
+    }
+}
+
+void
+Ipv4PrefixTrieRandomTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ipv4PrefixTrie<uint32_t> trie;
+  Table table;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      uint8_t length = rng->GetInteger (0, 32);
+      uint32_t network = GetRandomAddress (rng) & GetMask (length);
+      trie.Insert (Ipv4Address (network), length) = i;
+      table[Prefix (network, length)] = i;
+    }
+  CheckMatches (trie, table, rng);
+
+  // erase half of the prefixes.
+  for (Table::iterator it = table.begin (); it != table.end (); )
+    {
+      if (rng->GetInteger (0, 1) == 0)
+        {
+          trie.Erase (Ipv4Address (it->first.first), it->first.second);
+          table.erase (it++);
+        }
+      else
+        {
+          it++;
+        }
+    }
+  for (Table::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      uint32_t *value = trie.Find (Ipv4Address (it->first.first), it->first.second);
+      NS_TEST_ASSERT_MSG_NE (value, 0, "Prefix lost by the erasures");
+      NS_TEST_ASSERT_MSG_EQ (*value, it->second, "Wrong value after the erasures");
+    }
+  CheckMatches (trie, table, rng);
+
+  for (Table::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      trie.Erase (Ipv4Address (it->first.first), it->first.second);
+    }
+  NS_TEST_ASSERT_MSG_EQ (trie.IsEmpty (), true, "Nodes left after erasing all the prefixes");
+}
+
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 prefix trie TestSuite
+ */
+class Ipv4PrefixTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4PrefixTrieTestSuite ();
+};
+
+Ipv4PrefixTrieTestSuite::Ipv4PrefixTrieTestSuite ()
+  : TestSuite ("ipv4-prefix-trie", UNIT)
+{
+  AddTestCase (new Ipv4PrefixTrieBasicTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4PrefixTrieRandomTestCase, TestCase::QUICK);
+}
+
+static Ipv4PrefixTrieTestSuite ipv4PrefixTrieTestSuite; //!< Static variable for test initialization
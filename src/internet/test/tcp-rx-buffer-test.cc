@@ -44,6 +44,15 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the SACK block of a segment contiguous to blocks which
+   * are no longer in the SACK list.
+   */
+  void TestDiscardedSackBlocks ();
+  /**
+   * \brief Test the extraction of the data.
+   */
+  void TestExtract ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +64,8 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestDiscardedSackBlocks ();
+  TestExtract ();
 }
 
 void
@@ -338,6 +349,93 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestDiscardedSackBlocks ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpOptionSack::SackList::iterator it;
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader h;
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  // Six out of order blocks: only the last four fit in the list
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (201 + 200 * i));
+      rxBuf.Add (p, h);
+    }
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4,
+                         "SACK list should contain four elements");
+  NS_TEST_ASSERT_MSG_EQ (sackList.back ().first, SequenceNumber32 (601),
+                         "SACK block different than expected");
+
+  // The segment fills the hole between the two discarded blocks: the first
+  // block covers the whole contiguous data, discarded blocks included
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  rxBuf.Add (p, h);
+
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4,
+                         "SACK list should contain four elements");
+  it = sackList.begin ();
+  NS_TEST_ASSERT_MSG_EQ (it->first, SequenceNumber32 (201),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (it->second, SequenceNumber32 (501),
+                         "SACK block different than expected");
+
+  // The segment fills the hole at the head: everything up to the next hole
+  // becomes available
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  p = Create<Packet> (200);
+  rxBuf.Add (p, h);
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (501),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 500,
+                         "Available bytes differ from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackList ().size (), 3,
+                         "SACK list should contain three elements");
+}
+
+void
+TcpRxBufferTestCase::TestExtract ()
+{
+  TcpRxBuffer rxBuf;
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader h;
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (p, h);
+  h.SetSequenceNumber (SequenceNumber32 (101));
+  rxBuf.Add (p, h);
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  rxBuf.Add (p, h);
+
+  // Extract a whole segment and part of the next one
+  Ptr<Packet> out = rxBuf.Extract (150);
+  NS_TEST_ASSERT_MSG_EQ (out->GetSize (), 150, "Extracted size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 50, "Available bytes differ from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 150, "Buffer size differs from expected");
+
+  // Only the in-order bytes are extracted
+  out = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (out->GetSize (), 50, "Extracted size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Extract (1000), 0, "No data should be available");
+
+  // The remaining segment becomes available once the hole is filled
+  h.SetSequenceNumber (SequenceNumber32 (201));
+  rxBuf.Add (p, h);
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (401),
+                         "Sequence number differs from expected");
+  out = rxBuf.Extract (1000);
+  NS_TEST_ASSERT_MSG_EQ (out->GetSize (), 200, "Extracted size differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Buffer should be empty");
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
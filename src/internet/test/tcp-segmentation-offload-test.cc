@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/node.h"
+#include "ns3/tcp-header.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/gso-tag.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpSegmentationOffloadTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the super-segments of the TsoMaxSegments attribute
+ *
+ * The sender builds super-segments of up to TsoMaxSegments segments,
+ * tagged with a GsoTag. The SimpleNetDevice does not accept them, so
+ * Ipv4L3Protocol splits them, and the receiver gets single segments,
+ * with the sequence numbers it expects.
+ */
+class TcpSegmentationOffloadTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param desc Description.
+   * \param tsoMaxSegments Maximum number of segments of a super-segment.
+   */
+  TcpSegmentationOffloadTest (const std::string &desc, uint32_t tsoMaxSegments);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  uint32_t m_tsoMaxSegments;    //!< Maximum number of segments of a super-segment.
+  uint32_t m_superSegments;     //!< Number of super-segments sent.
+  uint32_t m_bytesReceived;     //!< Number of bytes received.
+  SequenceNumber32 m_nextRxSeq; //!< Next sequence number expected by the receiver.
+};
+
+TcpSegmentationOffloadTest::TcpSegmentationOffloadTest (const std::string &desc,
+                                                        uint32_t tsoMaxSegments)
+  : TcpGeneralTest (desc),
+    m_tsoMaxSegments (tsoMaxSegments),
+    m_superSegments (0),
+    m_bytesReceived (0),
+    m_nextRxSeq (1)
+{
+}
+
+void
+TcpSegmentationOffloadTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (100);
+  SetAppPktSize (1000);
+  SetAppPktInterval (MicroSeconds (10));
+  SetPropagationDelay (MilliSeconds (50));
+}
+
+void
+TcpSegmentationOffloadTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("TsoMaxSegments", UintegerValue (m_tsoMaxSegments));
+}
+
+void
+TcpSegmentationOffloadTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+  uint32_t segSize = GetSegSize (SENDER);
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (p->GetSize (), m_tsoMaxSegments * segSize,
+                               "Super-segment larger than TsoMaxSegments segments");
+  GsoTag gsoTag;
+  bool tagged = p->PeekPacketTag (gsoTag);
+  NS_TEST_ASSERT_MSG_EQ (tagged, (p->GetSize () > segSize),
+                         "Only the super-segments should carry a GsoTag");
+  if (tagged)
+    {
+      NS_TEST_ASSERT_MSG_EQ (gsoTag.GetSegmentSize (), segSize, "Wrong segment size in the GsoTag");
+      m_superSegments++;
+    }
+}
+
+void
+TcpSegmentationOffloadTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != RECEIVER || p->GetSize () == 0)
+    {
+      return;
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (p->GetSize (), GetSegSize (SENDER),
+                               "The super-segments should be split before the device");
+  NS_TEST_ASSERT_MSG_EQ (h.GetSequenceNumber (), m_nextRxSeq,
+                         "The segments should be received in order");
+  m_nextRxSeq += p->GetSize ();
+  m_bytesReceived += p->GetSize ();
+}
+
+void
+TcpSegmentationOffloadTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_bytesReceived, 100 * 1000, "All the data should be received");
+  if (m_tsoMaxSegments > 1)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_superSegments, 0, "Super-segments should be sent");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_superSegments, 0, "No super-segment should be sent");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite: Check the super-segments of the TsoMaxSegments attribute
+ */
+class TcpSegmentationOffloadTestSuite : public TestSuite
+{
+public:
+  TcpSegmentationOffloadTestSuite () : TestSuite ("tcp-segmentation-offload", UNIT)
+  {
+    AddTestCase (new TcpSegmentationOffloadTest ("Segmentation offload disabled", 1),
+                 TestCase::QUICK);
+    AddTestCase (new TcpSegmentationOffloadTest ("Super-segments of up to 4 segments", 4),
+                 TestCase::QUICK);
+    AddTestCase (new TcpSegmentationOffloadTest ("Super-segments of up to 16 segments", 16),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpSegmentationOffloadTestSuite g_tcpSegmentationOffloadTestSuite; //!< Static variable for test initialization
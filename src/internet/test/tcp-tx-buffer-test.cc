@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard of a large window with many holes */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -342,6 +346,88 @@ TcpTxBufferTestCase::TestTransmittedBlock ()
 {
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 1000;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (2000000);
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+
+  // Send 1000 segments, and keep some unsent data
+  txBuf.Add (Create<Packet> (1100000));
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every other segment, from the second to the 20th, is received
+  for (uint32_t i = 1; i < 20; i += 2)
+    {
+      sack->AddSackBlock (TcpOptionSack::SackBlock (head + (segmentSize * i),
+                                                    head + (segmentSize * (i + 1))));
+      txBuf.Update (sack->GetSackList ());
+      sack->ClearSackList ();
+    }
+
+  // The holes below the third sacked segment from the top are lost
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 10 * segmentSize,
+                         "Different sacked count than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 8 * segmentSize,
+                         "Different lost count than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), 982 * segmentSize,
+                         "Different bytes in flight than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 14)), true,
+                         "Hole below the loss point is not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 16)), false,
+                         "Hole above the loss point is lost");
+
+  // The lost segments are retransmitted in order, and then the new data
+  for (uint32_t i = 0; i < 16; i += 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i),
+                             "Different NextSeq than expected for a lost segment");
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 8 * segmentSize,
+                         "Different retransmitted count than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                         "No NextSeq with unsent data");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 1000),
+                         "Different NextSeq than expected for new data");
+
+  // One more sacked segment moves the loss point up by one hole
+  sack->AddSackBlock (TcpOptionSack::SackBlock (head + (segmentSize * 21),
+                                                head + (segmentSize * 22)));
+  txBuf.Update (sack->GetSackList ());
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 9 * segmentSize,
+                         "Different lost count than expected after a new SACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                         "No NextSeq with a new lost segment");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 16),
+                         "Different NextSeq than expected for a new lost segment");
+
+  // The ACK of the retransmitted segments removes them from the counts
+  txBuf.DiscardUpTo (head + (segmentSize * 16));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 3 * segmentSize,
+                         "Different sacked count than expected after an ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize,
+                         "Different lost count than expected after an ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), 0,
+                         "Different retransmitted count than expected after an ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                         "No NextSeq after an ACK");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 16),
+                         "Different NextSeq than expected after an ACK");
+}
+
 void
 TcpTxBufferTestCase::DoTeardown ()
 {
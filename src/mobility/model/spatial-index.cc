@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "spatial-index.h"
+#include "mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialIndex");
+
+namespace {
+
+/// The bias added to the grid coordinates to make them positive.
+const int32_t CELL_COORDINATE_BIAS = 1 << 20;
+
+} // unnamed namespace
+
+SpatialIndex::SpatialIndex (double cellSize)
+  : m_cellSize (cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT (cellSize > 0);
+}
+
+SpatialIndex::~SpatialIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+SpatialIndex::SetCellSize (double cellSize)
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT (cellSize > 0);
+  if (cellSize == m_cellSize)
+    {
+      return;
+    }
+  m_cellSize = cellSize;
+  for (uint32_t id = 0; id < m_entries.size (); id++)
+    {
+      if (!m_entries[id].dirty)
+        {
+          m_entries[id].dirty = true;
+          m_dirty.push_back (id);
+        }
+    }
+}
+
+double
+SpatialIndex::GetCellSize (void) const
+{
+  return m_cellSize;
+}
+
+uint32_t
+SpatialIndex::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  uint32_t id = m_entries.size ();
+  Entry entry;
+  entry.mobility = mobility;
+  entry.location = OUTSIDE;
+  entry.dirty = false;
+  entry.cell = 0;
+  m_entries.push_back (entry);
+  if (mobility != 0)
+    {
+      if (m_models.find (PeekPointer (mobility)) == m_models.end ())
+        {
+          mobility->TraceConnectWithoutContext ("CourseChange",
+                                                MakeCallback (&SpatialIndex::NotifyCourseChange, this));
+        }
+      m_models.insert (std::make_pair (PeekPointer (mobility), id));
+    }
+  Place (id);
+  return id;
+}
+
+uint32_t
+SpatialIndex::GetN (void) const
+{
+  return m_entries.size ();
+}
+
+void
+SpatialIndex::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Entry>::iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      std::multimap<const MobilityModel *, uint32_t>::iterator j = m_models.find (PeekPointer (i->mobility));
+      if (j != m_models.end ())
+        {
+          i->mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                      MakeCallback (&SpatialIndex::NotifyCourseChange, this));
+          m_models.erase (PeekPointer (i->mobility));
+        }
+    }
+  m_entries.clear ();
+  m_cells.clear ();
+  m_movingCells.clear ();
+  m_expiries = std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry> > ();
+  m_outside.clear ();
+  m_dirty.clear ();
+  m_models.clear ();
+}
+
+void
+SpatialIndex::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  typedef std::multimap<const MobilityModel *, uint32_t>::const_iterator Iterator;
+  std::pair<Iterator, Iterator> range = m_models.equal_range (PeekPointer (mobility));
+  for (Iterator i = range.first; i != range.second; i++)
+    {
+      if (!m_entries[i->second].dirty)
+        {
+          m_entries[i->second].dirty = true;
+          m_dirty.push_back (i->second);
+        }
+    }
+}
+
+void
+SpatialIndex::Update (void)
+{
+  for (std::vector<uint32_t>::const_iterator i = m_dirty.begin (); i != m_dirty.end (); i++)
+    {
+      Unplace (*i);
+      Place (*i);
+      m_entries[*i].dirty = false;
+    }
+  m_dirty.clear ();
+  Time now = Simulator::Now ();
+  while (!m_expiries.empty () && m_expiries.top ().first < now)
+    {
+      uint32_t id = m_expiries.top ().second;
+      Entry &entry = m_entries[id];
+      // the entries placed again since then have a later expiry.
+      if (entry.location == MOVING_GRID && entry.expiry == m_expiries.top ().first)
+        {
+          Unplace (id);
+          Place (id);
+        }
+      m_expiries.pop ();
+    }
+}
+
+void
+SpatialIndex::Place (uint32_t id)
+{
+  Entry &entry = m_entries[id];
+  if (entry.mobility == 0)
+    {
+      NS_LOG_LOGIC ("entry " << id << " has no position, kept aside");
+      entry.location = OUTSIDE;
+      m_outside.push_back (id);
+      return;
+    }
+  Vector velocity = entry.mobility->GetVelocity ();
+  double speed = std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z);
+  entry.cell = GetCellKey (entry.mobility->GetPosition ());
+  if (speed == 0)
+    {
+      entry.location = STATIC_GRID;
+      m_cells[entry.cell].push_back (id);
+      return;
+    }
+  // the entry stays within one cell size of its cell until it expires.
+  entry.location = MOVING_GRID;
+  Time lifetime = Simulator::GetMaximumSimulationTime () - Simulator::Now ();
+  if (m_cellSize / speed < lifetime.GetSeconds ())
+    {
+      lifetime = Seconds (m_cellSize / speed);
+    }
+  entry.expiry = Simulator::Now () + lifetime;
+  NS_LOG_LOGIC ("entry " << id << " is moving, placed again at " << entry.expiry);
+  m_movingCells[entry.cell].push_back (id);
+  m_expiries.push (std::make_pair (entry.expiry, id));
+}
+
+void
+SpatialIndex::Unplace (uint32_t id)
+{
+  Entry &entry = m_entries[id];
+  if (entry.location == OUTSIDE)
+    {
+      std::vector<uint32_t>::iterator i = std::find (m_outside.begin (), m_outside.end (), id);
+      NS_ASSERT (i != m_outside.end ());
+      *i = m_outside.back ();
+      m_outside.pop_back ();
+      return;
+    }
+  Grid &grid = (entry.location == STATIC_GRID) ? m_cells : m_movingCells;
+  Grid::iterator cell = grid.find (entry.cell);
+  NS_ASSERT (cell != grid.end ());
+  std::vector<uint32_t> &ids = cell->second;
+  std::vector<uint32_t>::iterator i = std::find (ids.begin (), ids.end (), id);
+  NS_ASSERT (i != ids.end ());
+  *i = ids.back ();
+  ids.pop_back ();
+  if (ids.empty ())
+    {
+      grid.erase (cell);
+    }
+}
+
+SpatialIndex::CellCoordinate
+SpatialIndex::GetCellCoordinate (double x) const
+{
+  double cell = std::floor (x / m_cellSize);
+  // the cells at the edge of the grid extend to infinity.
+  if (!(cell > -CELL_COORDINATE_BIAS))
+    {
+      return -CELL_COORDINATE_BIAS + 1;
+    }
+  if (!(cell < CELL_COORDINATE_BIAS))
+    {
+      return CELL_COORDINATE_BIAS - 1;
+    }
+  return static_cast<CellCoordinate> (cell);
+}
+
+SpatialIndex::CellKey
+SpatialIndex::GetCellKey (CellCoordinate x, CellCoordinate y, CellCoordinate z)
+{
+  return (static_cast<CellKey> (x + CELL_COORDINATE_BIAS) << 42)
+         | (static_cast<CellKey> (y + CELL_COORDINATE_BIAS) << 21)
+         | static_cast<CellKey> (z + CELL_COORDINATE_BIAS);
+}
+
+SpatialIndex::CellKey
+SpatialIndex::GetCellKey (const Vector &position) const
+{
+  return GetCellKey (GetCellCoordinate (position.x),
+                     GetCellCoordinate (position.y),
+                     GetCellCoordinate (position.z));
+}
+
+void
+SpatialIndex::GetCandidates (const Vector &position, double range, std::vector<uint32_t> &candidates)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  Update ();
+  candidates.clear ();
+  if (!(range >= 0))
+    {
+      for (uint32_t id = 0; id < m_entries.size (); id++)
+        {
+          candidates.push_back (id);
+        }
+      return;
+    }
+  AddCandidates (m_cells, position, range, candidates);
+  AddCandidates (m_movingCells, position, range + m_cellSize, candidates);
+  candidates.insert (candidates.end (), m_outside.begin (), m_outside.end ());
+  std::sort (candidates.begin (), candidates.end ());
+  NS_LOG_LOGIC (candidates.size () << " candidates out of " << m_entries.size () << " entries");
+}
+
+void
+SpatialIndex::AddCandidates (const Grid &grid, const Vector &position, double range,
+                             std::vector<uint32_t> &candidates) const
+{
+  CellCoordinate x0 = GetCellCoordinate (position.x - range);
+  CellCoordinate x1 = GetCellCoordinate (position.x + range);
+  CellCoordinate y0 = GetCellCoordinate (position.y - range);
+  CellCoordinate y1 = GetCellCoordinate (position.y + range);
+  CellCoordinate z0 = GetCellCoordinate (position.z - range);
+  CellCoordinate z1 = GetCellCoordinate (position.z + range);
+  double nCells = (x1 - x0 + 1.0) * (y1 - y0 + 1.0) * (z1 - z0 + 1.0);
+  if (nCells > grid.size ())
+    {
+      // cheaper to visit the occupied cells than the cells in range.
+      CellKey mask = (static_cast<CellKey> (1) << 21) - 1;
+      for (Grid::const_iterator cell = grid.begin (); cell != grid.end (); cell++)
+        {
+          CellCoordinate x = static_cast<CellCoordinate> (cell->first >> 42) - CELL_COORDINATE_BIAS;
+          CellCoordinate y = static_cast<CellCoordinate> ((cell->first >> 21) & mask) - CELL_COORDINATE_BIAS;
+          CellCoordinate z = static_cast<CellCoordinate> (cell->first & mask) - CELL_COORDINATE_BIAS;
+          if (x >= x0 && x <= x1 && y >= y0 && y <= y1 && z >= z0 && z <= z1)
+            {
+              candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (CellCoordinate x = x0; x <= x1; x++)
+        {
+          for (CellCoordinate y = y0; y <= y1; y++)
+            {
+              for (CellCoordinate z = z0; z <= z1; z++)
+                {
+                  Grid::const_iterator cell = grid.find (GetCellKey (x, y, z));
+                  if (cell != grid.end ())
+                    {
+                      candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace ns3
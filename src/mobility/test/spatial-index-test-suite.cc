@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "ns3/simulator.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/spatial-index.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check that the spatial index finds all the models in range
+ * of random positions, as the models move.
+ */
+class SpatialIndexTestCase : public TestCase
+{
+public:
+  SpatialIndexTestCase ();
+  virtual ~SpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the candidates of random positions against the distances
+   * to all the models.
+   * \param range the search range.
+   * \param maxCandidates the maximum number of candidates expected.
+   */
+  void CheckCandidates (double range, uint32_t maxCandidates);
+
+  std::vector<Ptr<MobilityModel> > m_models;  //!< the indexed models.
+  SpatialIndex m_index;                        //!< the index under test.
+  Ptr<UniformRandomVariable> m_rng;            //!< random coordinates.
+};
+
+SpatialIndexTestCase::SpatialIndexTestCase ()
+  : TestCase ("Check the candidates of the spatial index against the distances"),
+    m_index (50)
+{
+}
+
+SpatialIndexTestCase::~SpatialIndexTestCase ()
+{
+}
+
+void
+SpatialIndexTestCase::CheckCandidates (double range, uint32_t maxCandidates)
+{
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Vector position (m_rng->GetValue (-100, 1100), m_rng->GetValue (-100, 1100), 0);
+      std::vector<uint32_t> candidates;
+      m_index.GetCandidates (position, range, candidates);
+      NS_TEST_ASSERT_MSG_EQ (std::is_sorted (candidates.begin (), candidates.end ()), true,
+                             "Candidates not in increasing order");
+      for (uint32_t id = 0; id < m_models.size (); id++)
+        {
+          if (CalculateDistance (position, m_models[id]->GetPosition ()) <= range)
+            {
+              NS_TEST_ASSERT_MSG_EQ (std::binary_search (candidates.begin (), candidates.end (), id), true,
+                                     "Model " << id << " in range of " << position << " not found");
+            }
+        }
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (candidates.size (), maxCandidates,
+                                   "Too many candidates for the cells around " << position);
+    }
+}
+
+void
+SpatialIndexTestCase::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      Ptr<MobilityModel> model = CreateObject<ConstantPositionMobilityModel> ();
+      model->SetPosition (Vector (m_rng->GetValue (0, 1000), m_rng->GetValue (0, 1000), 0));
+      m_models.push_back (model);
+      NS_TEST_ASSERT_MSG_EQ (m_index.Add (model), i, "Wrong entry number");
+    }
+  // two entries for the same model, and moving models.
+  m_models.push_back (m_models[0]);
+  m_index.Add (m_models[0]);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+      moving->SetPosition (Vector (m_rng->GetValue (0, 1000), m_rng->GetValue (0, 1000), 0));
+      moving->SetVelocity (Vector (m_rng->GetValue (-40, 40), m_rng->GetValue (-40, 40), 0));
+      m_models.push_back (moving);
+      m_index.Add (moving);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_index.GetN (), m_models.size (), "Wrong number of entries");
+
+  CheckCandidates (50, 60);
+  CheckCandidates (10, 40);
+
+  // move some models: the index follows their course changes.
+  for (uint32_t i = 0; i < 500; i += 3)
+    {
+      m_models[i]->SetPosition (Vector (m_rng->GetValue (0, 1000), m_rng->GetValue (0, 1000), 0));
+    }
+  CheckCandidates (50, 60);
+
+  // the moving models are found wherever they went, in the cells where
+  // they were placed or, once they may have left them, in their new cells.
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      Simulator::Stop (Seconds (0.7));
+      Simulator::Run ();
+      CheckCandidates (50, 60);
+    }
+
+  m_index.SetCellSize (200);
+  CheckCandidates (200, 300);
+  CheckCandidates (20, 150);
+
+  m_index.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (m_index.GetN (), 0u, "Index not cleared");
+  // the models are no longer connected to the index.
+  m_models[1]->SetPosition (Vector (0, 0, 0));
+  m_models.clear ();
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Spatial index test suite.
+ */
+class SpatialIndexTestSuite : public TestSuite
+{
+public:
+  SpatialIndexTestSuite ();
+};
+
+SpatialIndexTestSuite::SpatialIndexTestSuite ()
+  : TestSuite ("spatial-index", UNIT)
+{
+  AddTestCase (new SpatialIndexTestCase, TestCase::QUICK);
+}
+
+static SpatialIndexTestSuite g_spatialIndexTestSuite; ///< the test suite
@@ -0,0 +1,790 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mtp")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaximumLookAhead",
+                   "The maximum duration of a synchronization window.  "
+                   "The actual lookahead is the smallest delay of the "
+                   "point-to-point channels between partitions, if smaller.",
+                   TimeValue (Time::Max ()),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_maxLookAhead),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_global (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_schedulerFactory.SetTypeId ("ns3::MapScheduler");
+  m_global = CreatePartition (0);
+  m_partitions.push_back (CreatePartition (0));
+  m_inWindow = false;
+  m_windowEnd = 0;
+  m_safeTs = 0;
+  m_lookAhead = 0;
+  m_stop = false;
+  m_stopTs = UINT64_MAX;
+  m_main = SystemThread::Self ();
+#ifdef NS3_MTP
+  m_windows = 0;
+  m_running = 0;
+  m_exit = false;
+#endif
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
+
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  m_global = 0;
+  m_globalNodeEvents.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        CriticalSection cs (m_destroyEventsMutex);
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::CreatePartition (uint32_t id) const
+{
+  NS_LOG_FUNCTION (this << id);
+  Partition *partition = new Partition;
+  partition->id = id;
+  partition->events = m_schedulerFactory.Create<Scheduler> ();
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  partition->uid = 4;
+  partition->currentUid = 0;
+  partition->currentTs = m_global != 0 ? m_global->currentTs : 0;
+  partition->currentContext = Simulator::NO_CONTEXT;
+  return partition;
+}
+
+void
+MultithreadedSimulatorImpl::AddPartition (uint32_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  NS_ASSERT (!m_inWindow);
+  while (m_partitions.size () <= id)
+    {
+      m_partitions.push_back (CreatePartition (m_partitions.size ()));
+    }
+}
+
+void
+MultithreadedSimulatorImpl::UpdatePartitions (void)
+{
+  NS_ASSERT (!m_inWindow);
+  for (uint32_t i = m_nodePartitions.size (); i < NodeList::GetNNodes (); ++i)
+    {
+      uint32_t id = NodeList::GetNode (i)->GetSystemId ();
+      AddPartition (id);
+      m_nodePartitions.push_back (id);
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Current (void) const
+{
+  Partition *current = m_current;
+  return current != 0 ? current : m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Route (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_global;
+    }
+  if (context >= m_nodePartitions.size () && !m_inWindow)
+    {
+      // the node list cannot be read while the partitions are running.
+      UpdatePartitions ();
+    }
+  if (context < m_nodePartitions.size ())
+    {
+      return m_partitions[m_nodePartitions[context]];
+    }
+  return m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Owner (const EventId &id) const
+{
+  uint32_t context = id.GetContext ();
+  if (context < m_nodePartitions.size ()
+      && (m_globalNodeEvents.empty ()
+          || m_globalNodeEvents.find (id.PeekEventImpl ()) == m_globalNodeEvents.end ()))
+    {
+      return m_partitions[m_nodePartitions[context]];
+    }
+  return m_global;
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+      partition->events = scheduler;
+    }
+  m_partitions.pop_back ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return Current ()->id;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts,
+                                    uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->events->Insert (ev);
+  if (partition == m_global && context != Simulator::NO_CONTEXT)
+    {
+      // the node of the context was unknown: Route may send the later
+      // events of the context to another partition.
+      m_globalNodeEvents.insert (event);
+    }
+  return ev.key.m_uid;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::Next (const Partition *partition) const
+{
+  if (partition->events->IsEmpty ())
+    {
+      return UINT64_MAX;
+    }
+  return partition->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  if (partition == m_global && next.key.m_context != Simulator::NO_CONTEXT)
+    {
+      m_globalNodeEvents.erase (next.impl);
+    }
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (Partition *partition)
+{
+  m_current = partition;
+  while (Next (partition) < m_windowEnd)
+    {
+      ProcessOneEvent (partition);
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::RunWindow (void)
+{
+  NS_LOG_FUNCTION (this << m_windowEnd);
+  m_inWindow = true;
+#ifdef NS3_MTP
+  StartThreads ();
+  {
+    std::lock_guard<std::mutex> lock (m_barrierMutex);
+    m_running = m_threads.size ();
+    m_windows++;
+  }
+  m_windowStart.notify_all ();
+  ProcessWindow (m_partitions[0]);
+  {
+    std::unique_lock<std::mutex> lock (m_barrierMutex);
+    while (m_running != 0)
+      {
+        m_windowDone.wait (lock);
+      }
+  }
+#else
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      ProcessWindow (*i);
+    }
+#endif
+  m_inWindow = false;
+  m_safeTs = m_windowEnd;
+}
+
+#ifdef NS3_MTP
+void
+MultithreadedSimulatorImpl::Work (Partition *partition, uint64_t windows)
+{
+  while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock (m_barrierMutex);
+        while (!m_exit && m_windows == windows)
+          {
+            m_windowStart.wait (lock);
+          }
+        if (m_exit)
+          {
+            return;
+          }
+        windows = m_windows;
+      }
+      ProcessWindow (partition);
+      {
+        std::lock_guard<std::mutex> lock (m_barrierMutex);
+        m_running--;
+        if (m_running == 0)
+          {
+            m_windowDone.notify_one ();
+          }
+      }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StartThreads (void)
+{
+  // the main thread runs the first partition.
+  while (m_threads.size () + 1 < m_partitions.size ())
+    {
+      Partition *partition = m_partitions[m_threads.size () + 1];
+      NS_LOG_LOGIC ("start thread of partition " << partition->id);
+      m_threads.push_back (std::thread (&MultithreadedSimulatorImpl::Work, this,
+                                        partition, m_windows));
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StopThreads (void)
+{
+  NS_LOG_FUNCTION (this);
+  {
+    std::lock_guard<std::mutex> lock (m_barrierMutex);
+    m_exit = true;
+  }
+  m_windowStart.notify_all ();
+  for (std::vector<std::thread>::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      i->join ();
+    }
+  m_threads.clear ();
+  m_exit = false;
+}
+#endif
+
+void
+MultithreadedSimulatorImpl::ProcessHandovers (void)
+{
+  // partitions are visited in order so that uids do not depend on
+  // the order in which the threads ran.
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Handovers &handovers = (*i)->handovers;
+      for (Handovers::const_iterator j = handovers.begin (); j != handovers.end (); ++j)
+        {
+          Insert (j->target, j->ts, j->context, j->event);
+        }
+      handovers.clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessEventsWithContext (void)
+{
+  EventsWithContext eventsWithContext;
+  {
+    CriticalSection cs (m_eventsWithContextMutex);
+    m_eventsWithContext.swap (eventsWithContext);
+  }
+  while (!eventsWithContext.empty ())
+    {
+      EventWithContext event = eventsWithContext.front ();
+      eventsWithContext.pop_front ();
+      Insert (Route (event.context), m_safeTs + event.timestamp,
+              event.context, event.event);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time lookAhead = m_maxLookAhead;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          // only works for p2p links currently
+          if (!device->IsPointToPoint ())
+            {
+              continue;
+            }
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          bool remote = false;
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              if (channel->GetDevice (k)->GetNode ()->GetSystemId () != node->GetSystemId ())
+                {
+                  remote = true;
+                }
+            }
+          TimeValue delay;
+          if (remote && channel->GetAttributeFailSafe ("Delay", delay)
+              && delay.Get () < lookAhead)
+            {
+              lookAhead = delay.Get ();
+            }
+        }
+    }
+  NS_ABORT_MSG_IF (!lookAhead.IsStrictlyPositive (),
+                   "MultithreadedSimulatorImpl: zero-delay channel between two partitions");
+  m_lookAhead = lookAhead.GetTimeStep ();
+  NS_LOG_LOGIC ("lookahead=" << lookAhead);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return m_global->events->IsEmpty ();
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  m_stop = false;
+  UpdatePartitions ();
+  CalculateLookAhead ();
+  ProcessEventsWithContext ();
+
+  while (!m_stop)
+    {
+      uint64_t next = UINT64_MAX;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, Next (*i));
+        }
+      uint64_t nextGlobal = Next (m_global);
+      uint64_t stopTs;
+      {
+        CriticalSection cs (m_stopMutex);
+        stopTs = m_stopTs;
+      }
+      if (std::min (next, nextGlobal) >= stopTs)
+        {
+          if (stopTs != UINT64_MAX)
+            {
+              NS_LOG_LOGIC ("stop at " << stopTs);
+              m_global->currentTs = stopTs;
+              m_global->currentUid = 0;
+              CriticalSection cs (m_stopMutex);
+              m_stopTs = UINT64_MAX;
+            }
+          break;
+        }
+      if (nextGlobal <= next)
+        {
+          // the global events see every partition stopped.
+          while (!m_stop && Next (m_global) == nextGlobal)
+            {
+              ProcessOneEvent (m_global);
+            }
+          m_safeTs = nextGlobal;
+        }
+      else
+        {
+          m_windowEnd = next + std::min (m_lookAhead, UINT64_MAX - next);
+          m_windowEnd = std::min (m_windowEnd, std::min (nextGlobal, stopTs));
+          RunWindow ();
+          ProcessHandovers ();
+        }
+      ProcessEventsWithContext ();
+    }
+
+#ifdef NS3_MTP
+  StopThreads ();
+#endif
+
+  // Now () in the main thread is the time of the last event.
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if ((*i)->currentTs > m_global->currentTs)
+        {
+          m_global->currentTs = (*i)->currentTs;
+          m_global->currentUid = 0;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  uint64_t ts = Current ()->currentTs + delay.GetTimeStep ();
+  if (m_inWindow)
+    {
+      // the other partitions may already be past ts.
+      ts = std::max (ts, m_windowEnd);
+    }
+  CriticalSection cs (m_stopMutex);
+  m_stopTs = std::min (m_stopTs, ts);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (m_current != 0 || SystemThread::Equals (m_main),
+                 "Simulator::Schedule Thread-unsafe invocation!");
+
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+  Partition *current = Current ();
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  uint32_t context = current->currentContext;
+  Partition *partition = m_inWindow ? current : Route (context);
+  uint32_t uid = Insert (partition, ts, context, event);
+  return EventId (event, ts, context, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  if (m_current == 0 && !SystemThread::Equals (m_main))
+    {
+      EventWithContext ev;
+      ev.context = context;
+      // Current time added in ProcessEventsWithContext()
+      ev.timestamp = delay.GetTimeStep ();
+      ev.event = event;
+      CriticalSection cs (m_eventsWithContextMutex);
+      m_eventsWithContext.push_back (ev);
+      return;
+    }
+
+  Partition *current = Current ();
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  Partition *partition = Route (context);
+  if (!m_inWindow || partition == current)
+    {
+      Insert (partition, ts, context, event);
+      return;
+    }
+  NS_ABORT_MSG_IF (ts < m_windowEnd,
+                   "MultithreadedSimulatorImpl: event for context " << context <<
+                   " scheduled within the lookahead of partition " << current->id);
+  Handover handover;
+  handover.target = partition;
+  handover.ts = ts;
+  handover.context = context;
+  handover.event = event;
+  current->handovers.push_back (handover);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), Current ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (Current ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - Current ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  CheckOwner (id);
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  Partition *partition = Owner (id);
+  partition->events->Remove (event);
+  if (partition == m_global && event.key.m_context != Simulator::NO_CONTEXT)
+    {
+      m_globalNodeEvents.erase (event.impl);
+    }
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  CheckOwner (id);
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CheckOwner (const EventId &id) const
+{
+  // the scheduler of another partition, or the events it holds, change
+  // under a running window.
+  NS_ABORT_MSG_IF (m_inWindow && id.PeekEventImpl () != 0 && id.GetUid () != 2
+                   && Owner (id) != Current (),
+                   "MultithreadedSimulatorImpl: event of another partition removed "
+                   "or cancelled from partition " << Current ()->id << " within a window");
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (id.PeekEventImpl () == 0)
+    {
+      return true;
+    }
+  const Partition *partition = Owner (id);
+  // the clock of another partition changes under a running window, but
+  // not the one of the global partition.
+  NS_ABORT_MSG_IF (m_inWindow && partition != Current () && partition != m_global,
+                   "MultithreadedSimulatorImpl: event of another partition checked "
+                   "from partition " << Current ()->id << " within a window");
+  if (id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return Current ()->currentContext;
+}
+
+} // namespace ns3
@@ -0,0 +1,336 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <set>
+#include <vector>
+
+#ifdef NS3_MTP
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \defgroup mtp Multithreaded Simulation
+ *
+ * Shared-memory parallel simulation of a single process, with one
+ * thread per node partition.
+ */
+
+/**
+ * \ingroup mtp
+ * \brief a simulator implementation which runs node partitions in parallel
+ *
+ * The nodes are split into partitions according to their system id
+ * (see Node::GetSystemId), exactly as for the distributed simulator
+ * of the mpi module.  Each partition has its own event scheduler and
+ * processes the events whose context is one of its nodes.  The events
+ * without a context, or whose context is not a node, are held in a
+ * separate global queue.
+ *
+ * The partitions are synchronized conservatively: they all process
+ * the events of a time window [t, t + lookahead) before meeting at a
+ * barrier, where t is the timestamp of the earliest pending event.
+ * The lookahead is the smallest delay of the point-to-point channels
+ * which connect two partitions, bounded by the MaximumLookAhead
+ * attribute.  An event scheduled by a partition for another one is
+ * handed over at the barrier, by pointer: packets are never serialized.
+ * Scheduling an event for another partition earlier than the end of
+ * the current window (for example over a shared channel which is not
+ * point-to-point) is a fatal error.
+ *
+ * The global events are run by the main thread between two windows,
+ * while every partition is stopped: they may safely touch any node.
+ * They run before the partition events which have the same timestamp.
+ *
+ * The partitions run in parallel only if ns-3 was configured with
+ * --enable-mtp, which also makes the reference counts and the packet
+ * buffers thread-safe.  Otherwise the partitions of a window are
+ * processed one after the other by the main thread, with the same
+ * results.  In both cases, the order of the events is deterministic.
+ *
+ * Events can only be removed or cancelled from their own partition, or
+ * from the main thread between two windows, and only the global events
+ * can be checked for expiry from another partition; anything else is a
+ * fatal error.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Get the lookahead used by the last call to Run.
+   *
+   * \returns The duration of a synchronization window.
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  struct Partition;
+
+  /** An event scheduled by a partition for another one. */
+  struct Handover
+  {
+    Partition *target;  /**< The partition of the event. */
+    uint64_t ts;        /**< The absolute event timestamp. */
+    uint32_t context;   /**< The event context. */
+    EventImpl *event;   /**< The event implementation. */
+  };
+  /** Container type for the events scheduled for other partitions. */
+  typedef std::vector<Handover> Handovers;
+
+  /** The state of a partition. */
+  struct Partition
+  {
+    uint32_t id;                /**< The system id of the partition nodes. */
+    Ptr<Scheduler> events;      /**< The event priority queue. */
+    uint32_t uid;               /**< Next event unique id. */
+    uint32_t currentUid;        /**< Unique id of the current event. */
+    uint64_t currentTs;         /**< Timestamp of the current event. */
+    uint32_t currentContext;    /**< Execution context of the current event. */
+    Handovers handovers;        /**< Events scheduled for other partitions. */
+  };
+
+  /** Wrap an event scheduled by a thread foreign to the simulator. */
+  struct EventWithContext
+  {
+    uint32_t context;   /**< The event context. */
+    uint64_t timestamp; /**< The event delay. */
+    EventImpl *event;   /**< The event implementation. */
+  };
+  /** Container type for the events scheduled by foreign threads. */
+  typedef std::list<EventWithContext> EventsWithContext;
+
+  /**
+   * Get the partition of the calling thread.
+   *
+   * \returns The current partition; the global one for the main
+   * thread outside of a window, or for a foreign thread.
+   */
+  inline Partition * Current (void) const;
+  /**
+   * Get the partition which processes the events of a context.
+   *
+   * \param [in] context The event context.
+   * \returns The partition.
+   */
+  Partition * Route (uint32_t context);
+  /**
+   * Get the partition which holds an event.
+   *
+   * \param [in] id The event.
+   * \returns The partition.
+   */
+  Partition * Owner (const EventId &id) const;
+  /**
+   * Abort if an event may not be removed or cancelled by the calling
+   * thread.
+   *
+   * \param [in] id The event.
+   */
+  void CheckOwner (const EventId &id) const;
+  /**
+   * Create an empty partition.
+   *
+   * \param [in] id The system id of the partition.
+   * \returns The new partition.
+   */
+  Partition * CreatePartition (uint32_t id) const;
+  /**
+   * Create the partition of a system id, and those before it.
+   *
+   * \param [in] id The system id.
+   */
+  void AddPartition (uint32_t id);
+  /** Record the partition of the nodes created since the last call. */
+  void UpdatePartitions (void);
+  /**
+   * Insert an event in a partition.
+   *
+   * \param [in] partition The partition.
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \returns The event unique id.
+   */
+  uint32_t Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Process the next event of a partition.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Process the events of a partition which belong to the current window.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessWindow (Partition *partition);
+  /** Process a window in every partition. */
+  void RunWindow (void);
+  /** Hand the events scheduled at the last window over to their partition. */
+  void ProcessHandovers (void);
+  /** Move the events scheduled by foreign threads to their partition. */
+  void ProcessEventsWithContext (void);
+  /** Compute the lookahead from the point-to-point channels. */
+  void CalculateLookAhead (void);
+  /**
+   * Get the timestamp of the next event of a partition.
+   *
+   * \param [in] partition The partition.
+   * \returns The timestamp, or UINT64_MAX if the partition has no event.
+   */
+  uint64_t Next (const Partition *partition) const;
+
+#ifdef NS3_MTP
+  /**
+   * The body of the thread of a partition.
+   *
+   * \param [in] partition The partition.
+   * \param [in] windows The number of windows started so far.
+   */
+  void Work (Partition *partition, uint64_t windows);
+  /** Start a thread for each partition, but the first one. */
+  void StartThreads (void);
+  /** Stop all the partition threads. */
+  void StopThreads (void);
+#endif
+
+  /** The partitions, indexed by system id. */
+  std::vector<Partition *> m_partitions;
+  /** The partition of the events without a node context. */
+  Partition *m_global;
+  /** The partition of each node, indexed by node id. */
+  std::vector<uint32_t> m_nodePartitions;
+  /**
+   * The pending events of the global partition with a context, whose
+   * node was unknown when they were scheduled.  Only the main thread
+   * changes it, between two windows.
+   */
+  std::set<const EventImpl *> m_globalNodeEvents;
+  /** Factory of the event schedulers. */
+  ObjectFactory m_schedulerFactory;
+  /** The partition run by the calling thread, if any. */
+  static thread_local Partition *m_current;
+
+  /** \c true while the partitions run a window. */
+  bool m_inWindow;
+  /** The end (excluded) of the current window. */
+  uint64_t m_windowEnd;
+  /** Every event before this timestamp has been processed. */
+  uint64_t m_safeTs;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** Upper bound of the lookahead. */
+  Time m_maxLookAhead;
+
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The simulation stops before this timestamp. */
+  uint64_t m_stopTs;
+  /** Mutex to control access to m_stopTs. */
+  SystemMutex m_stopMutex;
+
+  /** The events scheduled by threads foreign to the simulator. */
+  EventsWithContext m_eventsWithContext;
+  /** Mutex to control access to the list of events with context. */
+  SystemMutex m_eventsWithContextMutex;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the destroy events. */
+  mutable SystemMutex m_destroyEventsMutex;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+
+#ifdef NS3_MTP
+  /** The partition threads, for partitions 1 and above. */
+  std::vector<std::thread> m_threads;
+  /** Mutex protecting the barrier state. */
+  std::mutex m_barrierMutex;
+  /** Signals the start of a window, or the end of the threads. */
+  std::condition_variable m_windowStart;
+  /** Signals the end of the window in every partition thread. */
+  std::condition_variable m_windowDone;
+  /** The number of windows started. */
+  uint64_t m_windows;
+  /** The number of partition threads still running the window. */
+  uint32_t m_running;
+  /** \c true when the partition threads must exit. */
+  bool m_exit;
+#endif
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
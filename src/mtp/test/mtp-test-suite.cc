@@ -0,0 +1,461 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/packet.h"
+#include "ns3/mac48-address.h"
+#include "ns3/multithreaded-simulator-impl.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-test mtp module tests
+ */
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * \brief Check that the events seen by each node do not depend on the
+ * simulator implementation.
+ *
+ * Every event spawns its successors from its own payload only, so the
+ * set of events seen by each node is the same whatever the order in
+ * which the events with the same timestamp run.  Events jump from node
+ * to node with ScheduleWithContext, and packets are sent on a ring of
+ * point-to-point links which cross the partitions.
+ */
+class MtpEventsTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  MtpEventsTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** The events seen by a node: their timestamp and payload. */
+  typedef std::vector<std::pair<int64_t, uint32_t> > Log;
+
+  /**
+   * Run the scenario with a given simulator implementation.
+   *
+   * \param [in] impl The simulator implementation type.
+   * \returns The sorted events seen by each node.
+   */
+  std::vector<Log> RunScenario (std::string impl);
+  /**
+   * An event which jumps to another node.
+   *
+   * \param [in] node The node index.
+   * \param [in] value The event payload.
+   */
+  void Hop (uint32_t node, uint32_t value);
+  /**
+   * An event which stays on its node.
+   *
+   * \param [in] node The node index.
+   * \param [in] value The event payload.
+   */
+  void Local (uint32_t node, uint32_t value);
+  /**
+   * Receive a packet.
+   *
+   * \param [in] device The receiving device.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number.
+   * \param [in] from The sender address.
+   * \returns \c true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from);
+  /**
+   * Check the context and the system id of the current event.
+   *
+   * \param [in] node The expected node.
+   */
+  void Check (uint32_t node);
+  /**
+   * Scramble a payload.
+   *
+   * \param [in] v The payload.
+   * \returns The new payload.
+   */
+  static uint32_t Mix (uint32_t v);
+
+  NodeContainer m_nodes;          //!< The nodes.
+  std::vector<Log> m_logs;        //!< The events seen by each node.
+  std::vector<uint32_t> m_errors; //!< The errors seen by each node.
+  bool m_checkSystemId;           //!< Check the system id of the events.
+};
+
+/** The number of nodes. */
+static const uint32_t N_NODES = 8;
+/** The number of partitions. */
+static const uint32_t N_PARTITIONS = 4;
+
+MtpEventsTestCase::MtpEventsTestCase ()
+  : TestCase ("Check that partitions see the same events as with the default simulator")
+{
+}
+
+uint32_t
+MtpEventsTestCase::Mix (uint32_t v)
+{
+  v ^= v >> 16;
+  v *= 0x7feb352d;
+  v ^= v >> 15;
+  v *= 0x846ca68b;
+  v ^= v >> 16;
+  return v;
+}
+
+void
+MtpEventsTestCase::Check (uint32_t node)
+{
+  if (Simulator::GetContext () != m_nodes.Get (node)->GetId ())
+    {
+      m_errors[node]++;
+    }
+  if (m_checkSystemId && Simulator::GetSystemId () != m_nodes.Get (node)->GetSystemId ())
+    {
+      m_errors[node]++;
+    }
+}
+
+void
+MtpEventsTestCase::Hop (uint32_t node, uint32_t value)
+{
+  Check (node);
+  m_logs[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), value));
+  uint32_t next = Mix (value);
+  uint32_t dest = next % N_NODES;
+  Simulator::ScheduleWithContext (m_nodes.Get (dest)->GetId (), MicroSeconds (1000 + next % 1000),
+                                  &MtpEventsTestCase::Hop, this, dest, next);
+  if (next % 4 == 0)
+    {
+      EventId id = Simulator::Schedule (NanoSeconds (next % 500), &MtpEventsTestCase::Local,
+                                        this, node, next);
+      if (next % 3 == 0)
+        {
+          Simulator::Cancel (id);
+        }
+      else if (next % 3 == 1)
+        {
+          Simulator::Remove (id);
+        }
+    }
+  if (next % 16 == 1)
+    {
+      Ptr<NetDevice> device = m_nodes.Get (node)->GetDevice (0);
+      device->Send (Create<Packet> (1 + next % 1000), Mac48Address::GetBroadcast (), 0);
+    }
+}
+
+void
+MtpEventsTestCase::Local (uint32_t node, uint32_t value)
+{
+  Check (node);
+  m_logs[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), value + 1));
+}
+
+bool
+MtpEventsTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                            uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  Check (node);
+  m_logs[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), packet->GetSize ()));
+  return true;
+}
+
+std::vector<MtpEventsTestCase::Log>
+MtpEventsTestCase::RunScenario (std::string impl)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (impl));
+  m_checkSystemId = impl == "ns3::MultithreadedSimulatorImpl";
+  m_logs.assign (N_NODES, Log ());
+  m_errors.assign (N_NODES, 0);
+
+  m_nodes = NodeContainer ();
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      m_nodes.Add (CreateObject<Node> (i % N_PARTITIONS));
+    }
+  // a ring of point-to-point links, all of them between two partitions.
+  SimpleNetDeviceHelper helper;
+  helper.SetNetDevicePointToPointMode (true);
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      helper.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1000 + 10 * i)));
+      NetDeviceContainer devices = helper.Install (NodeContainer (m_nodes.Get (i),
+                                                                  m_nodes.Get ((i + 1) % N_NODES)));
+      for (uint32_t j = 0; j < devices.GetN (); ++j)
+        {
+          devices.Get (j)->SetReceiveCallback (MakeCallback (&MtpEventsTestCase::Receive, this));
+        }
+    }
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      for (uint32_t k = 0; k < 4; ++k)
+        {
+          Simulator::ScheduleWithContext (m_nodes.Get (i)->GetId (), MicroSeconds (10 * k),
+                                          &MtpEventsTestCase::Hop, this, i, Mix (i * 4 + k + 1));
+        }
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (1), "Simulation did not stop at the right time");
+  Ptr<MultithreadedSimulatorImpl> mtp =
+    DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (mtp != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (mtp->GetLookAhead (), MicroSeconds (1000), "Wrong lookahead");
+    }
+  Simulator::Destroy ();
+  m_nodes = NodeContainer ();
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_errors[i], 0u, "Wrong context or system id for node " << i);
+      std::sort (m_logs[i].begin (), m_logs[i].end ());
+    }
+  return m_logs;
+}
+
+void
+MtpEventsTestCase::DoRun (void)
+{
+  std::vector<Log> expected = RunScenario ("ns3::DefaultSimulatorImpl");
+  std::vector<Log> actual = RunScenario ("ns3::MultithreadedSimulatorImpl");
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      NS_TEST_ASSERT_MSG_GT (expected[i].size (), 100u, "Too few events for node " << i);
+      NS_TEST_ASSERT_MSG_EQ (actual[i].size (), expected[i].size (), "Wrong number of events for node " << i);
+      for (uint32_t j = 0; j < expected[i].size (); ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (actual[i][j].first, expected[i][j].first,
+                                 "Wrong event time for node " << i);
+          NS_TEST_ASSERT_MSG_EQ (actual[i][j].second, expected[i][j].second,
+                                 "Wrong event for node " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * \brief Check the scheduling of events without a node context.
+ */
+class MtpGlobalEventsTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  MtpGlobalEventsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * An event without a context.
+   *
+   * \param [in] n The number of events still to schedule.
+   */
+  void Tick (uint32_t n);
+  /** An event on a node. */
+  void Tock (void);
+
+  uint32_t m_ticks;    //!< The number of Tick events.
+  uint32_t m_tocks;    //!< The number of Tock events.
+  bool m_stopped;      //!< Whether Stop was called.
+};
+
+MtpGlobalEventsTestCase::MtpGlobalEventsTestCase ()
+  : TestCase ("Check the events without a node context"),
+    m_ticks (0),
+    m_tocks (0),
+    m_stopped (false)
+{
+}
+
+void
+MtpGlobalEventsTestCase::Tick (uint32_t n)
+{
+  m_ticks++;
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), Simulator::NO_CONTEXT, "Wrong context");
+  NS_TEST_EXPECT_MSG_EQ (m_tocks, m_ticks - 1, "The partitions are not in sync");
+  // a node event at the same time runs after the global one.
+  Simulator::ScheduleWithContext (n % 2, Seconds (0), &MtpGlobalEventsTestCase::Tock, this);
+  if (n > 0)
+    {
+      Simulator::Schedule (MilliSeconds (3), &MtpGlobalEventsTestCase::Tick, this, n - 1);
+    }
+  else
+    {
+      Simulator::Stop ();
+      m_stopped = true;
+    }
+}
+
+void
+MtpGlobalEventsTestCase::Tock (void)
+{
+  m_tocks++;
+}
+
+void
+MtpGlobalEventsTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  NodeContainer nodes;
+  nodes.Add (CreateObject<Node> (0));
+  nodes.Add (CreateObject<Node> (1));
+
+  Simulator::Schedule (Seconds (1), &MtpGlobalEventsTestCase::Tick, this, 10);
+  Simulator::ScheduleWithContext (0, Seconds (100), &MtpGlobalEventsTestCase::Tock, this);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_stopped, true, "Stop was not called");
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 11u, "Wrong number of global events");
+  // the last node event was scheduled by the event which stopped the simulation.
+  NS_TEST_EXPECT_MSG_EQ (m_tocks, 10u, "Wrong number of node events");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (1) + MilliSeconds (30), "Wrong stop time");
+
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * \brief Check the removal of an event scheduled for a node which did
+ * not exist yet.
+ *
+ * The event is held by the global partition, and it stays there once
+ * the node is created and the later events of its context go to the
+ * partition of the node.
+ */
+class MtpUnknownNodeTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  MtpUnknownNodeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** The event of the context of a node which is not created yet. */
+  void Create (void);
+  /** An event which must not run. */
+  void Removed (void);
+  /** An event on the created node. */
+  void Tock (void);
+
+  uint32_t m_removed;  //!< The number of Removed events.
+  uint32_t m_tocks;    //!< The number of Tock events.
+};
+
+MtpUnknownNodeTestCase::MtpUnknownNodeTestCase ()
+  : TestCase ("Check the removal of an event scheduled for an unknown node"),
+    m_removed (0),
+    m_tocks (0)
+{
+}
+
+void
+MtpUnknownNodeTestCase::Create (void)
+{
+  EventId id = Simulator::Schedule (Seconds (1), &MtpUnknownNodeTestCase::Removed, this);
+  while (NodeList::GetNNodes () <= Simulator::GetContext ())
+    {
+      CreateObject<Node> (1);
+    }
+  // the partition of the node is known from now on.
+  Simulator::ScheduleWithContext (Simulator::GetContext (), Seconds (1), &MtpUnknownNodeTestCase::Tock, this);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (id), false, "The event expired");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetDelayLeft (id), Seconds (1), "Wrong delay left");
+  Simulator::Remove (id);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::IsExpired (id), true, "The event did not expire");
+}
+
+void
+MtpUnknownNodeTestCase::Removed (void)
+{
+  m_removed++;
+}
+
+void
+MtpUnknownNodeTestCase::Tock (void)
+{
+  m_tocks++;
+}
+
+void
+MtpUnknownNodeTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  NodeContainer nodes;
+  nodes.Add (CreateObject<Node> (0));
+  nodes.Add (CreateObject<Node> (1));
+
+  Simulator::ScheduleWithContext (3, Seconds (1), &MtpUnknownNodeTestCase::Create, this);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_removed, 0u, "The removed event ran");
+  NS_TEST_EXPECT_MSG_EQ (m_tocks, 1u, "Wrong number of node events");
+
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * \brief The mtp module TestSuite.
+ */
+class MtpTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  MtpTestSuite ();
+};
+
+MtpTestSuite::MtpTestSuite ()
+  : TestSuite ("mtp", UNIT)
+{
+  AddTestCase (new MtpEventsTestCase, TestCase::QUICK);
+  AddTestCase (new MtpGlobalEventsTestCase, TestCase::QUICK);
+  AddTestCase (new MtpUnknownNodeTestCase, TestCase::QUICK);
+}
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
@@ -50,24 +50,135 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
+#ifdef NS3_MTP
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
+bool Buffer::g_slicesEnabled = false;
+
+/**
+ * \ingroup packet
+ * The smallest buffer worth chaining as a slice rather than copying.
+ */
+static const uint32_t SLICE_MIN_SIZE = 256;
+/**
+ * \ingroup packet
+ * The largest number of slices of a buffer: the slices of a buffer
+ * which would exceed it are copied into a single contiguous buffer.
+ */
+static const uint32_t SLICE_MAX_COUNT = 16;
+
+/**
+ * The slices which follow the head of a Buffer.
+ *
+ * None of the buffers of a chain has slices of its own.
+ */
+struct Buffer::Slices
+{
+  /**
+   * The reference count of the chain.  Each buffer which references
+   * the chain holds a count.
+   */
+#ifdef NS3_MTP
+  std::atomic<uint32_t> m_count;
+#else
+  uint32_t m_count;
+#endif
+  /** The slices, in order. */
+  std::vector<Buffer> m_buffers;
+};
 #ifdef BUFFER_FREE_LIST
+/**
+ * \ingroup packet
+ * The size of the smallest size class of the free lists, a power of two.
+ */
+static const uint32_t FREE_LIST_MIN_SIZE = 32;
+/**
+ * \ingroup packet
+ * The number of size classes of the free lists: the largest class
+ * holds BufferData of FREE_LIST_MIN_SIZE << (FREE_LIST_CLASSES - 1)
+ * bytes, and the larger BufferData are never recycled.
+ */
+static const uint32_t FREE_LIST_CLASSES = 12;
+
+/**
+ * \ingroup packet
+ * Get the size class of a BufferData size.
+ * \param size the BufferData size
+ * \returns the smallest size class whose BufferData hold size bytes,
+ * or FREE_LIST_CLASSES if size is larger than the largest class.
+ */
+static uint32_t
+GetSizeClass (uint32_t size)
+{
+  uint32_t sizeClass = 0;
+  while (sizeClass < FREE_LIST_CLASSES && (FREE_LIST_MIN_SIZE << sizeClass) < size)
+    {
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+/**
+ * The BufferData released by a thread, sorted by size class.
+ */
+struct Buffer::FreeList
+{
+  FreeList ()
+    : m_maxSize (0)
+  {
+    memset (&m_stats, 0, sizeof (m_stats));
+  }
+  /**
+   * Take a BufferData from a size class.
+   * \param sizeClass the size class
+   * \returns the BufferData, or zero if the size class is empty
+   */
+  struct Buffer::Data *Pop (uint32_t sizeClass)
+  {
+    std::vector<struct Buffer::Data *> &list = m_classes[sizeClass];
+    if (list.empty ())
+      {
+        return 0;
+      }
+    struct Buffer::Data *data = list.back ();
+    list.pop_back ();
+    m_stats.cachedBytes -= data->m_size;
+    data->m_count = 1;
+    return data;
+  }
+  /** Reset the counters and the high-water mark. */
+  void ResetStats (void)
+  {
+    uint64_t cachedBytes = m_stats.cachedBytes;
+    memset (&m_stats, 0, sizeof (m_stats));
+    m_stats.cachedBytes = cachedBytes;
+    m_stats.maxCachedBytes = cachedBytes;
+  }
+  /** The BufferData of each size class. */
+  std::vector<struct Buffer::Data *> m_classes[FREE_LIST_CLASSES];
+  /** The largest BufferData size released by this thread, the size of the new empty buffers. */
+  uint32_t m_maxSize;
+  /** The statistics of this free list. */
+  FreeListStats m_stats;
+};
+
 /* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
+ * keep track of 3 possible states for the g_freeList variable of a thread:
+ *  - uninitialized means that this thread has not created a buffer yet
  *    so no one has created the associated free list (it is created
  *    on-demand when the first buffer is created)
  *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
+ *  - destroyed means that the thread-local destructors of this thread
  *    have run so, the free list has been cleared from its content
  * The key is that in destroyed state, we are careful not re-create it
  * which is a typical weakness of lazy evaluation schemes which use 
  * '0' as a special value to indicate both un-initialized and destroyed.
  * Note that it is important to use '0' as the marker for un-initialized state
  * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+ * in each thread before any of its constructors run so this ensures perfect
+ * handling of crazy constructor orderings.
  */
 #define MAGIC_DESTROYED (~(long) 0)
 #define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
@@ -75,70 +186,158 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+thread_local Buffer::FreeList *Buffer::g_freeList = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+uint32_t Buffer::g_freeListMaxCount = 1000;
+uint64_t Buffer::g_freeListMaxBytes = 4 * 1024 * 1024;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
   if (IS_INITIALIZED (g_freeList))
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
+      FlushFreeList ();
       delete g_freeList;
       g_freeList = DESTROYED;
     }
 }
 
+Buffer::FreeList *
+Buffer::GetFreeList (void)
+{
+  if (IS_UNINITIALIZED (g_freeList))
+    {
+      g_freeList = new Buffer::FreeList ();
+      // construct the destructor of the free list of this thread.
+      (void) &g_localStaticDestructor;
+    }
+  else if (IS_DESTROYED (g_freeList))
+    {
+      return 0;
+    }
+  return g_freeList;
+}
+
+void
+Buffer::SetFreeListLimits (uint32_t maxBuffersPerClass, uint64_t maxBytes)
+{
+  NS_LOG_FUNCTION (maxBuffersPerClass << maxBytes);
+  g_freeListMaxCount = maxBuffersPerClass;
+  g_freeListMaxBytes = maxBytes;
+}
+
+Buffer::FreeListStats
+Buffer::GetFreeListStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeList *freeList = GetFreeList ();
+  if (freeList == 0)
+    {
+      FreeListStats stats;
+      memset (&stats, 0, sizeof (stats));
+      return stats;
+    }
+  return freeList->m_stats;
+}
+
+void
+Buffer::ResetFreeListStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeList *freeList = GetFreeList ();
+  if (freeList != 0)
+    {
+      freeList->ResetStats ();
+    }
+}
+
+void
+Buffer::FlushFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeList *freeList = GetFreeList ();
+  if (freeList == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < FREE_LIST_CLASSES; i++)
+    {
+      std::vector<struct Buffer::Data *> &sizeClass = freeList->m_classes[i];
+      for (std::vector<struct Buffer::Data *>::iterator j = sizeClass.begin ();
+           j != sizeClass.end (); j++)
+        {
+          Buffer::Deallocate (*j);
+        }
+      sizeClass.clear ();
+    }
+  freeList->m_stats.cachedBytes = 0;
+}
+
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  FreeList *freeList = GetFreeList ();
+  uint32_t sizeClass = GetSizeClass (data->m_size);
+  /* feed into the free list of this thread, if the buffer data is
+   * exactly the size of its class and the free list is not full.
+   */
+  if (freeList == 0 ||
+      sizeClass == FREE_LIST_CLASSES ||
+      (FREE_LIST_MIN_SIZE << sizeClass) != data->m_size)
     {
       Buffer::Deallocate (data);
+      return;
     }
-  else
+  freeList->m_maxSize = std::max (freeList->m_maxSize, data->m_size);
+  if (freeList->m_classes[sizeClass].size () >= g_freeListMaxCount ||
+      freeList->m_stats.cachedBytes + data->m_size > g_freeListMaxBytes)
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      freeList->m_stats.drops++;
+      Buffer::Deallocate (data);
+      return;
     }
+  freeList->m_classes[sizeClass].push_back (data);
+  freeList->m_stats.recycles++;
+  freeList->m_stats.cachedBytes += data->m_size;
+  freeList->m_stats.maxCachedBytes = std::max (freeList->m_stats.maxCachedBytes,
+                                               freeList->m_stats.cachedBytes);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  FreeList *freeList = GetFreeList ();
+  if (freeList == 0)
     {
-      g_freeList = new Buffer::FreeList ();
+      return Buffer::Allocate (dataSize);
     }
-  else if (IS_INITIALIZED (g_freeList))
+  freeList->m_stats.allocations++;
+  /* a new, empty buffer gets the largest size released so far, as its
+   * headers are added later on and would otherwise resize it; any other
+   * request gets the smallest size class which holds it.
+   */
+  uint32_t sizeClass = GetSizeClass (dataSize == 0 ? freeList->m_maxSize : dataSize);
+  if (sizeClass < FREE_LIST_CLASSES)
     {
-      while (!g_freeList->empty ()) 
+      struct Buffer::Data *data = freeList->Pop (sizeClass);
+      if (data != 0)
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
+          return data;
         }
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  freeList->m_stats.misses++;
+  /* allocate the whole size class, so that the buffer data can be
+   * recycled, unless it is larger than the largest class.
+   */
+  uint32_t wanted = dataSize;
+  if (sizeClass < FREE_LIST_CLASSES)
+    {
+      wanted = FREE_LIST_MIN_SIZE << sizeClass;
+    }
+  struct Buffer::Data *data = Buffer::Allocate (wanted);
   NS_ASSERT (data->m_count == 1);
   return data;
 }
@@ -157,6 +356,33 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+void
+Buffer::SetFreeListLimits (uint32_t maxBuffersPerClass, uint64_t maxBytes)
+{
+  NS_LOG_FUNCTION (maxBuffersPerClass << maxBytes);
+}
+
+Buffer::FreeListStats
+Buffer::GetFreeListStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeListStats stats;
+  memset (&stats, 0, sizeof (stats));
+  return stats;
+}
+
+void
+Buffer::ResetFreeListStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+Buffer::FlushFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -198,6 +424,8 @@ Buffer::Buffer (uint32_t dataSize)
 }
 
 Buffer::Buffer (uint32_t dataSize, bool initialize)
+  : m_slices (0),
+    m_slicesSize (0)
 {
   NS_LOG_FUNCTION (this << dataSize << initialize);
   if (initialize == true)
@@ -252,6 +480,8 @@ Buffer::Initialize (uint32_t zeroSize)
   m_end = m_zeroAreaEnd;
   m_data->m_dirtyStart = m_start;
   m_data->m_dirtyEnd = m_end;
+  m_slices = 0;
+  m_slicesSize = 0;
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -259,16 +489,38 @@ Buffer &
 Buffer::operator = (Buffer const&o)
 {
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != o.m_slices)
+    {
+      // take the new reference first: o may be one of our slices.
+      if (o.m_slices != 0)
+        {
+          RefSlices (o.m_slices);
+        }
+      Slices *old = m_slices;
+      m_slices = o.m_slices;
+      m_slicesSize = o.m_slicesSize;
+      if (old != 0 && --old->m_count == 0)
+        {
+          delete old;
+        }
+    }
+  AssignHead (o);
+  NS_ASSERT (CheckInternalState ());
+  return *this;
+}
+
+void
+Buffer::AssignHead (Buffer const &o)
+{
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      o.m_data->m_count++;
+      if (--m_data->m_count == 0) 
         {
           Recycle (m_data);
         }
       m_data = o.m_data;
-      m_data->m_count++;
     }
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
@@ -276,8 +528,6 @@ Buffer::operator = (Buffer const&o)
   m_zeroAreaEnd = o.m_zeroAreaEnd;
   m_start = o.m_start;
   m_end = o.m_end;
-  NS_ASSERT (CheckInternalState ());
-  return *this;
 }
 
 Buffer::~Buffer ()
@@ -285,11 +535,164 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0) 
     {
       Recycle (m_data);
     }
+  ReleaseSlices ();
+}
+
+void
+Buffer::EnableSlices (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_slicesEnabled = true;
+}
+
+void
+Buffer::DisableSlices (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_slicesEnabled = false;
+}
+
+uint32_t
+Buffer::GetNSlices (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_slices != 0 ? m_slices->m_buffers.size () : 0;
+}
+
+void
+Buffer::RefSlices (Slices *slices)
+{
+  slices->m_count++;
+}
+
+void
+Buffer::ReleaseSlices (void)
+{
+  if (m_slices != 0)
+    {
+      if (--m_slices->m_count == 0)
+        {
+          delete m_slices;
+        }
+      m_slices = 0;
+      m_slicesSize = 0;
+    }
+}
+
+Buffer::Slices *
+Buffer::GetWritableSlices (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_slices == 0)
+    {
+      m_slices = new Slices ();
+      m_slices->m_count = 1;
+      m_slicesSize = 0;
+    }
+  else if (m_slices->m_count != 1)
+    {
+      Slices *copy = new Slices ();
+      copy->m_count = 1;
+      copy->m_buffers = m_slices->m_buffers;
+      --m_slices->m_count;
+      m_slices = copy;
+    }
+  return m_slices;
+}
+
+void
+Buffer::AppendSlices (Buffer const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  if (GetNSlices () + 1 + o.GetNSlices () > SLICE_MAX_COUNT)
+    {
+      // too many slices: copy all of them into a single one.
+      Buffer all = CreateFullCopy ();
+      all.AddAtEnd (o.CreateFullCopy ());
+      *this = all;
+      return;
+    }
+  // o may share our slices: keep them alive while we modify ours.
+  Buffer tmp = o;
+  Slices *slices = GetWritableSlices ();
+  Buffer head = tmp;
+  head.ReleaseSlices ();
+  slices->m_buffers.push_back (head);
+  if (tmp.m_slices != 0)
+    {
+      slices->m_buffers.insert (slices->m_buffers.end (),
+                                tmp.m_slices->m_buffers.begin (),
+                                tmp.m_slices->m_buffers.end ());
+    }
+  m_slicesSize += tmp.GetSize ();
+}
+
+void
+Buffer::PushHeadIntoSlices (void)
+{
+  NS_LOG_FUNCTION (this);
+  Buffer head = *this;
+  head.ReleaseSlices ();
+  Slices *slices = GetWritableSlices ();
+  slices->m_buffers.insert (slices->m_buffers.begin (), head);
+  m_slicesSize += head.GetSize ();
+  // start a new head, without any zero area.
+  Buffer empty;
+  AssignHead (empty);
+}
+
+void
+Buffer::PopHeadFromSlices (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_slices != 0);
+  Slices *slices = GetWritableSlices ();
+  Buffer head = slices->m_buffers.front ();
+  slices->m_buffers.erase (slices->m_buffers.begin ());
+  m_slicesSize -= head.GetSize ();
+  if (slices->m_buffers.empty ())
+    {
+      ReleaseSlices ();
+    }
+  AssignHead (head);
+}
+
+uint8_t *
+Buffer::FindRun (uint32_t offset, uint32_t &size) const
+{
+  NS_LOG_FUNCTION (this << offset);
+  const Buffer *segment = this;
+  // the offset of the byte in the buffer data of segment.
+  uint32_t current = offset;
+  if (offset >= m_end && m_slices != 0)
+    {
+      const std::vector<Buffer> &slices = m_slices->m_buffers;
+      std::vector<Buffer>::const_iterator i = slices.begin ();
+      uint32_t sliceStart = m_end;
+      while (i + 1 != slices.end () && offset - sliceStart >= i->GetSize ())
+        {
+          sliceStart += i->GetSize ();
+          ++i;
+        }
+      segment = &*i;
+      current = i->m_start + (offset - sliceStart);
+    }
+  if (current < segment->m_zeroAreaStart)
+    {
+      size = segment->m_zeroAreaStart - current;
+      return segment->m_data->m_data + current;
+    }
+  if (current < segment->m_zeroAreaEnd)
+    {
+      size = segment->m_zeroAreaEnd - current;
+      return 0;
+    }
+  size = segment->m_end - current;
+  return segment->m_data->m_data + (current - (segment->m_zeroAreaEnd - segment->m_zeroAreaStart));
 }
 
 uint32_t
@@ -310,7 +713,23 @@ Buffer::AddAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+#ifdef NS3_MTP
+  // the dirty area of shared data may be claimed concurrently by
+  // another thread: always copy shared data.
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
+  if ((m_start < start || isDirty) && g_slicesEnabled &&
+      m_end - m_start >= SLICE_MIN_SIZE && GetNSlices () < SLICE_MAX_COUNT)
+    {
+      /* the head would have to be copied: chain it instead,
+       * behind a new head which holds only the added bytes.
+       */
+      PushHeadIntoSlices ();
+      AddAtStart (start);
+      return;
+    }
   if (m_start >= start && !isDirty)
     {
       /* enough space in the buffer and not dirty. 
@@ -328,8 +747,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (--m_data->m_count == 0)
         {
           Buffer::Recycle (m_data);
         }
@@ -355,7 +773,18 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      // the bytes go at the end of the last slice.
+      GetWritableSlices ()->m_buffers.back ().AddAtEnd (end);
+      m_slicesSize += end;
+      return;
+    }
+#ifdef NS3_MTP
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -373,8 +802,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Buffer::Recycle (m_data);
         }
@@ -400,6 +828,26 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  if (GetSize () == 0)
+    {
+      *this = o;
+      return;
+    }
+  if ((g_slicesEnabled && o.GetSize () >= SLICE_MIN_SIZE) || o.m_slices != 0)
+    {
+      /* chain o behind our own bytes, without copying it.
+       */
+      AppendSlices (o);
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (m_slices != 0)
+    {
+      // copy o at the end of the last slice.
+      GetWritableSlices ()->m_buffers.back ().AddAtEnd (o);
+      m_slicesSize += o.GetSize ();
+      return;
+    }
   if (m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
@@ -439,6 +887,12 @@ Buffer::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+  while (m_slices != 0 && start >= m_end - m_start)
+    {
+      // the whole head goes away.
+      start -= m_end - m_start;
+      PopHeadFromSlices ();
+    }
   uint32_t newStart = m_start + start;
   if (newStart <= m_zeroAreaStart)
     {
@@ -484,6 +938,26 @@ Buffer::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  while (m_slices != 0 && end > 0)
+    {
+      Slices *slices = GetWritableSlices ();
+      Buffer &last = slices->m_buffers.back ();
+      uint32_t size = last.GetSize ();
+      if (end < size)
+        {
+          last.RemoveAtEnd (end);
+          m_slicesSize -= end;
+          return;
+        }
+      // the whole slice goes away.
+      end -= size;
+      m_slicesSize -= size;
+      slices->m_buffers.pop_back ();
+      if (slices->m_buffers.empty ())
+        {
+          ReleaseSlices ();
+        }
+    }
   uint32_t newEnd = m_end - std::min (end, m_end - m_start);
   if (newEnd > m_zeroAreaEnd)
     {
@@ -532,6 +1006,26 @@ Buffer::CreateFullCopy (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
+  if (m_slices != 0)
+    {
+      /* copy the head and all the slices into a single buffer.
+       */
+      Buffer tmp = *this;
+      tmp.ReleaseSlices ();
+      tmp = tmp.CreateFullCopy ();
+      uint32_t offset = tmp.GetSize ();
+      tmp.AddAtEnd (m_slicesSize);
+      for (std::vector<Buffer>::const_iterator i = m_slices->m_buffers.begin ();
+           i != m_slices->m_buffers.end (); ++i)
+        {
+          Buffer::Iterator dst = tmp.Begin ();
+          dst.Next (offset);
+          dst.Write (i->Begin (), i->End ());
+          offset += i->GetSize ();
+        }
+      NS_ASSERT (tmp.CheckInternalState ());
+      return tmp;
+    }
   if (m_zeroAreaEnd - m_zeroAreaStart != 0) 
     {
       Buffer tmp;
@@ -557,7 +1051,8 @@ Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
-  uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
+  // the slices are serialized as data after the zero area of the head.
+  uint32_t dataEnd = (m_end - m_zeroAreaEnd + m_slicesSize + 3) & (~0x3);
 
   // total size 4-bytes for dataStart length 
   // + X number of bytes for dataStart 
@@ -615,7 +1110,7 @@ Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
     }
 
   // Add the length of the actual end data
-  uint32_t dataEndLength = m_end - m_zeroAreaEnd;
+  uint32_t dataEndLength = m_end - m_zeroAreaEnd + m_slicesSize;
   if (size + 4 <= maxSize)
     {
       size += 4;
@@ -631,7 +1126,16 @@ Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
     {
       // The following line is unnecessary.
       // size += (dataEndLength + 3) & (~3);
-      memcpy (p, m_data->m_data+m_zeroAreaStart, dataEndLength);
+      memcpy (p, m_data->m_data+m_zeroAreaStart, m_end - m_zeroAreaEnd);
+      if (m_slices != 0)
+        {
+          uint8_t *q = reinterpret_cast<uint8_t *> (p) + (m_end - m_zeroAreaEnd);
+          for (std::vector<Buffer>::const_iterator i = m_slices->m_buffers.begin ();
+               i != m_slices->m_buffers.end (); ++i)
+            {
+              q += i->CopyData (q, i->GetSize ());
+            }
+        }
       // The following line is unnecessary.
       // p += (((dataEndLength + 3) & (~3))/4); // Advance p, insuring 4 byte boundary
     }
@@ -656,6 +1160,7 @@ Buffer::Deserialize (const uint8_t *buffer, uint32_t size)
   sizeCheck -= 4;
 
   // Create zero bytes
+  ReleaseSlices ();
   Initialize (zeroDataLength);
 
   // Add start data
@@ -719,9 +1224,9 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
     {
       uint32_t tmpsize = std::min (m_zeroAreaStart-m_start, size);
       os->write ((const char*)(m_data->m_data + m_start), tmpsize);
-      if (size > tmpsize) 
+      size -= tmpsize;
+      if (size > 0) 
         { 
-          size -= m_zeroAreaStart-m_start;
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
           uint32_t left = tmpsize;
           while (left > 0)
@@ -730,11 +1235,22 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
               os->write (g_zeroes.buffer, toWrite);
               left -= toWrite;
             }
-          if (size > tmpsize)
+          size -= tmpsize;
+          if (size > 0)
             {
-              size -= tmpsize;
               tmpsize = std::min (m_end - m_zeroAreaEnd, size);
               os->write ((const char*)(m_data->m_data + m_zeroAreaStart), tmpsize); 
+              size -= tmpsize;
+            }
+        }
+      if (m_slices != 0)
+        {
+          for (std::vector<Buffer>::const_iterator i = m_slices->m_buffers.begin ();
+               i != m_slices->m_buffers.end () && size > 0; ++i)
+            {
+              tmpsize = std::min (i->GetSize (), size);
+              i->CopyData (os, tmpsize);
+              size -= tmpsize;
             }
         }
     }
@@ -767,6 +1283,17 @@ Buffer::CopyData (uint8_t *buffer, uint32_t size) const
             {
               tmpsize = std::min (m_end - m_zeroAreaEnd, size);
               memcpy (buffer, (const char*)(m_data->m_data + m_zeroAreaStart), tmpsize);
+              buffer += tmpsize;
+              size -= tmpsize;
+            }
+        }
+      if (m_slices != 0)
+        {
+          for (std::vector<Buffer>::const_iterator i = m_slices->m_buffers.begin ();
+               i != m_slices->m_buffers.end () && size > 0; ++i)
+            {
+              uint32_t tmpsize = i->CopyData (buffer, size);
+              buffer += tmpsize;
               size -= tmpsize;
             }
         }
@@ -808,6 +1335,54 @@ Buffer::Iterator::IsStart (void) const
   return m_current == m_dataStart;
 }
 
+uint8_t *
+Buffer::Iterator::GetRun (uint32_t &size) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_buffer != 0)
+    {
+      return m_buffer->FindRun (m_current, size);
+    }
+  if (m_current < m_zeroStart)
+    {
+      size = m_zeroStart - m_current;
+      return m_data + m_current;
+    }
+  if (m_current < m_zeroEnd)
+    {
+      size = m_zeroEnd - m_current;
+      return 0;
+    }
+  size = m_dataEnd - m_current;
+  return m_data + (m_current - (m_zeroEnd - m_zeroStart));
+}
+
+uint8_t
+Buffer::Iterator::SlicePeekU8 (void) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size;
+  uint8_t *data = m_buffer->FindRun (m_current, size);
+  return data != 0 ? *data : 0;
+}
+
+void
+Buffer::Iterator::SliceWrite (uint8_t const *buffer, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &buffer << size);
+  while (size > 0)
+    {
+      uint32_t run;
+      uint8_t *to = m_buffer->FindRun (m_current, run);
+      NS_ASSERT_MSG (to != 0 && run > 0, GetWriteErrorMessage ());
+      run = std::min (run, size);
+      memcpy (to, buffer, run);
+      buffer += run;
+      size -= run;
+      m_current += run;
+    }
+}
+
 bool 
 Buffer::Iterator::CheckNoZero (uint32_t start, uint32_t end) const
 {
@@ -825,6 +1400,11 @@ bool
 Buffer::Iterator::Check (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << &i);
+  if (m_buffer != 0 && i >= m_zeroStart && i < m_dataEnd)
+    {
+      uint32_t size;
+      return m_buffer->FindRun (i, size) != 0;
+    }
   return i >= m_dataStart && 
          !(i >= m_zeroStart && i < m_zeroEnd) &&
          i <= m_dataEnd;
@@ -835,6 +1415,29 @@ void
 Buffer::Iterator::Write (Iterator start, Iterator end)
 {
   NS_LOG_FUNCTION (this << &start << &end);
+  if (m_buffer != 0 || start.m_buffer != 0)
+    {
+      // one of the buffers has slices: copy run by run.
+      NS_ASSERT (start.m_current <= end.m_current);
+      uint32_t size = end.m_current - start.m_current;
+      while (size > 0)
+        {
+          uint32_t run;
+          uint8_t *from = start.GetRun (run);
+          run = std::min (run, size);
+          if (from != 0)
+            {
+              Write (from, run);
+            }
+          else
+            {
+              WriteU8 (0, run);
+            }
+          start.m_current += run;
+          size -= run;
+        }
+      return;
+    }
   NS_ASSERT (start.m_data == end.m_data);
   NS_ASSERT (start.m_current <= end.m_current);
   NS_ASSERT (start.m_zeroStart == end.m_zeroStart);
@@ -956,14 +1559,19 @@ Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
   NS_ASSERT_MSG (CheckNoZero (m_current, size),
                  GetWriteErrorMessage ());
   uint8_t *to;
-  if (m_current <= m_zeroStart)
+  if (m_current + size <= m_zeroStart)
     {
       to = &m_data[m_current];
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else
+    {
+      SliceWrite (buffer, size);
+      return;
+    }
   memcpy (to, buffer, size);
   m_current += size;
 }
@@ -24,7 +24,11 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
+// Recycle the buffer data through per-thread free lists.
 #define BUFFER_FREE_LIST 1
 
 namespace ns3 {
@@ -88,10 +92,40 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * When slices are enabled (see EnableSlices), the bytes described
+ * above are only the head of the buffer: they may be followed by a
+ * chain of slices, that is, other Buffer instances which share their
+ * BufferData with the buffers they come from.  Appending a large
+ * buffer to another one, or adding a header in front of a large
+ * buffer which would otherwise need to be copied, then only adds an
+ * entry to the chain instead of copying the payload bytes.  The chain
+ * is itself shared by the copies of a Buffer until one of them is
+ * modified.  The Iterator crosses the slice boundaries transparently.
+ *
+ * The BufferData instances released by a thread are kept on a free list
+ * of this thread, sorted in power-of-two size classes, to be reused by
+ * the next buffers created by this thread.  The free list of a thread
+ * is bounded both in number of instances per size class and in number
+ * of bytes (see SetFreeListLimits), and its statistics can be used to
+ * tune these bounds (see GetFreeListStats).
  */
 class Buffer 
 {
 public:
+  /**
+   * \brief The statistics of the BufferData free list of a thread.
+   */
+  struct FreeListStats
+  {
+    uint64_t allocations;    //!< number of BufferData requested
+    uint64_t misses;         //!< number of requests not served by the free list
+    uint64_t recycles;       //!< number of released BufferData kept in the free list
+    uint64_t drops;          //!< number of released BufferData freed because the free list was full
+    uint64_t cachedBytes;    //!< number of bytes currently held by the free list
+    uint64_t maxCachedBytes; //!< largest value of cachedBytes
+  };
+
   /**
    * \brief iterator in a Buffer instance
    */
@@ -403,6 +437,27 @@ private:
      * \param buffer the buffer this iterator refers to
      */
     inline void Construct (const Buffer *buffer);
+    /**
+     * \param size set to the number of bytes which follow the current
+     *        position in the same run of bytes
+     * \returns a pointer to the byte at the current position, or 0 if
+     *          that byte is in a "virtual zero area".
+     */
+    uint8_t *GetRun (uint32_t &size) const;
+    /**
+     * \returns the byte at the current position of an iterator which
+     *          crosses slices, outside of the head data in front of
+     *          the zero area.
+     */
+    uint8_t SlicePeekU8 (void) const;
+    /**
+     * Write bytes at the current position of an iterator which crosses
+     * slices, and advance the iterator.
+     *
+     * \param buffer the bytes to write
+     * \param size the number of bytes to write
+     */
+    void SliceWrite (uint8_t const *buffer, uint32_t size);
     /**
      * Checks that the [start, end) is not in the "virtual zero area".
      *
@@ -482,6 +537,13 @@ private:
      * to this pointer.
      */
     uint8_t *m_data;
+    /**
+     * the buffer this iterator refers to if it has slices, or zero.
+     * Such an iterator only accesses the head data in front of the
+     * zero area directly: its zero area extends to the end of the
+     * offsets, and the bytes found in it are looked up in the buffer.
+     */
+    Buffer const *m_buffer;
   };
 
   /**
@@ -489,6 +551,51 @@ private:
    */
   inline uint32_t GetSize (void) const;
 
+  /**
+   * Enable the slice representation of the buffers: from now on,
+   * AddAtEnd (const Buffer &) and AddAtStart chain large buffers
+   * instead of copying their bytes.
+   */
+  static void EnableSlices (void);
+  /**
+   * Disable the slice representation of the buffers.  The buffers
+   * which already have slices keep them.
+   */
+  static void DisableSlices (void);
+  /**
+   * \return the number of slices which follow the head of this buffer.
+   */
+  uint32_t GetNSlices (void) const;
+
+  /**
+   * Set the bounds of the BufferData free list of each thread.
+   *
+   * The bounds apply to the BufferData released from now on: the
+   * BufferData already in a free list stay there until they are
+   * reused, or until FlushFreeList is called.
+   *
+   * \param maxBuffersPerClass the maximum number of BufferData kept
+   *        in each size class, or zero to disable the free lists.
+   * \param maxBytes the maximum number of bytes kept by the free list
+   *        of a thread.
+   */
+  static void SetFreeListLimits (uint32_t maxBuffersPerClass, uint64_t maxBytes);
+  /**
+   * \return the statistics of the BufferData free list of the
+   * calling thread.
+   */
+  static FreeListStats GetFreeListStats (void);
+  /**
+   * Reset the counters of the BufferData free list of the calling
+   * thread.  The high-water mark restarts from the number of bytes
+   * currently held by the free list.
+   */
+  static void ResetFreeListStats (void);
+  /**
+   * Free all the BufferData held by the free list of the calling thread.
+   */
+  static void FlushFreeList (void);
+
   /**
    * \return a pointer to the start of the internal 
    * byte buffer.
@@ -663,7 +770,11 @@ private:
      * The reference count of an instance of this data structure.
      * Each buffer which references an instance holds a count.
      */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /**
      * the size of the m_data field below.
      */
@@ -749,6 +860,53 @@ private:
    */
   static void Deallocate (struct Buffer::Data *data);
 
+  /// The slices which follow the head of a buffer, shared copy-on-write.
+  struct Slices;
+  /**
+   * \brief Get the slices of this buffer, copied first if shared.
+   * \returns the slices
+   */
+  Slices *GetWritableSlices (void);
+  /**
+   * \brief Drop the reference of this buffer to its slices.
+   */
+  void ReleaseSlices (void);
+  /**
+   * \brief Take a new reference to the slices of a buffer.
+   * \param slices the slices
+   */
+  static void RefSlices (Slices *slices);
+  /**
+   * \brief Copy the head of a buffer, but not its slices.
+   * \param o the buffer whose head is copied
+   */
+  void AssignHead (Buffer const &o);
+  /**
+   * \brief Append a buffer, with its own slices, to the slices of
+   * this buffer.
+   * \param o the buffer to append
+   */
+  void AppendSlices (Buffer const &o);
+  /**
+   * \brief Turn the head of this buffer into its first slice, and
+   * start a new empty head.
+   */
+  void PushHeadIntoSlices (void);
+  /**
+   * \brief Replace the head of this buffer by its first slice.
+   */
+  void PopHeadFromSlices (void);
+  /**
+   * \brief Find the run of bytes of the head or of a slice which holds
+   * a byte.
+   * \param offset the offset of the byte, counted like m_start.
+   * \param size set to the number of bytes from the byte to the end of
+   * its run.
+   * \returns a pointer to the byte, or 0 if the byte is in the zero area
+   * of the head or of a slice.
+   */
+  uint8_t *FindRun (uint32_t offset, uint32_t &size) const;
+
   struct Data *m_data; //!< the buffer data storage
 
   /**
@@ -767,7 +925,11 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
+#ifdef NS3_MTP
+  static thread_local uint32_t g_recommendedStart;
+#else
   static uint32_t g_recommendedStart;
+#endif
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -789,18 +951,33 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
+  /**
+   * the slices which follow m_end, if any.
+   */
+  struct Slices *m_slices;
+  /**
+   * the total number of bytes in m_slices.
+   */
+  uint32_t m_slicesSize;
+  static bool g_slicesEnabled; //!< Chain large buffers instead of copying them
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
+  /// The free list of a thread, defined in buffer.cc
+  struct FreeList;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  /**
+   * \brief Get the free list of the calling thread.
+   * \returns the free list, or zero if it has been destroyed.
+   */
+  static FreeList *GetFreeList (void);
+  static thread_local FreeList *g_freeList; //!< Buffer data container of this thread
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static uint32_t g_freeListMaxCount; //!< Max number of buffer data per size class
+  static uint64_t g_freeListMaxBytes; //!< Max number of bytes per thread
 #endif
 };
 
@@ -817,7 +994,8 @@ Buffer::Iterator::Iterator ()
     m_dataStart (0),
     m_dataEnd (0),
     m_current (0),
-    m_data (0)
+    m_data (0),
+    m_buffer (0)
 {
 }
 Buffer::Iterator::Iterator (Buffer const*buffer)
@@ -839,6 +1017,13 @@ Buffer::Iterator::Construct (const Buffer *buffer)
   m_dataStart = buffer->m_start;
   m_dataEnd = buffer->m_end;
   m_data = buffer->m_data->m_data;
+  m_buffer = 0;
+  if (buffer->m_slices != 0)
+    {
+      m_zeroEnd = 0xffffffff;
+      m_dataEnd += buffer->m_slicesSize;
+      m_buffer = buffer;
+    }
 }
 
 void 
@@ -876,11 +1061,15 @@ Buffer::Iterator::WriteU8 (uint8_t data)
       m_data[m_current] = data;
       m_current++;
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       m_data[m_current - (m_zeroEnd-m_zeroStart)] = data;
       m_current++;
     }
+  else
+    {
+      SliceWrite (&data, 1);
+    }
 }
 
 void 
@@ -888,17 +1077,24 @@ Buffer::Iterator::WriteU8 (uint8_t  data, uint32_t len)
 {
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + len),
                  GetWriteErrorMessage ());
-  if (m_current <= m_zeroStart)
+  if (m_current + len <= m_zeroStart)
     {
       std::memset (&(m_data[m_current]), data, len);
       m_current += len;
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       uint8_t *buffer = &m_data[m_current - (m_zeroEnd-m_zeroStart)];
       std::memset (buffer, data, len);
       m_current += len;
     }
+  else
+    {
+      for (uint32_t i = 0; i < len; ++i)
+        {
+          WriteU8 (data);
+        }
+    }
 }
 
 void 
@@ -911,10 +1107,16 @@ Buffer::Iterator::WriteHtonU16 (uint16_t data)
     {
       buffer = &m_data[m_current];
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else
+    {
+      WriteU8 ((data >> 8) & 0xff);
+      WriteU8 ((data >> 0) & 0xff);
+      return;
+    }
   buffer[0] = (data >> 8)& 0xff;
   buffer[1] = (data >> 0)& 0xff;
   m_current+= 2;
@@ -931,10 +1133,18 @@ Buffer::Iterator::WriteHtonU32 (uint32_t data)
     {
       buffer = &m_data[m_current];
     }
-  else
+  else if (m_current >= m_zeroEnd)
     {
       buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+  else
+    {
+      WriteU8 ((data >> 24) & 0xff);
+      WriteU8 ((data >> 16) & 0xff);
+      WriteU8 ((data >> 8) & 0xff);
+      WriteU8 ((data >> 0) & 0xff);
+      return;
+    }
   buffer[0] = (data >> 24)& 0xff;
   buffer[1] = (data >> 16)& 0xff;
   buffer[2] = (data >> 8)& 0xff;
@@ -1008,6 +1218,10 @@ Buffer::Iterator::PeekU8 (void)
     }
   else if (m_current < m_zeroEnd)
     {
+      if (m_buffer != 0)
+        {
+          return SlicePeekU8 ();
+        }
       return 0;
     }
   else
@@ -1053,16 +1267,22 @@ Buffer::Buffer (Buffer const&o)
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
     m_start (o.m_start),
-    m_end (o.m_end)
+    m_end (o.m_end),
+    m_slices (o.m_slices),
+    m_slicesSize (o.m_slicesSize)
 {
   m_data->m_count++;
+  if (m_slices != 0)
+    {
+      RefSlices (m_slices);
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
 uint32_t 
 Buffer::GetSize (void) const
 {
-  return m_end - m_start;
+  return m_end - m_start + m_slicesSize;
 }
 
 Buffer::Iterator 
@@ -33,10 +33,16 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableLazy = false;
 bool PacketMetadata::m_metadataSkipped = false;
+#ifdef NS3_MTP
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+#else
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+#endif
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -70,6 +76,21 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableLazy (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_enableLazy = true;
+}
+
+void
+PacketMetadata::DisableLazy (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableLazy = false;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -77,8 +98,7 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0)
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -95,15 +115,26 @@ PacketMetadata::ReserveCopy (uint32_t size)
       Append16 (0xffff, start);
     }
 }
+bool
+PacketMetadata::IsAppendable (void) const
+{
+  NS_LOG_FUNCTION (this);
+#ifdef NS3_MTP
+  // the other owners of shared data may live in other threads: never
+  // append to it in place.
+  return m_data->m_count == 1;
+#else
+  return (m_head == 0xffff && !m_lazy) ||
+         m_data->m_count == 1 ||
+         m_data->m_dirtyEnd == m_used;
+#endif
+}
 void
 PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   NS_ASSERT (m_data != 0);
-  if (m_data->m_size >= m_used + size &&
-      (m_head == 0xffff ||
-       m_data->m_count == 1 ||
-       m_data->m_dirtyEnd == m_used))
+  if (m_data->m_size >= m_used + size && IsAppendable ())
     {
       /* enough room, not dirty. */
     }
@@ -134,6 +165,10 @@ PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
   bool ok = m_used <= m_data->m_size;
+  if (m_lazy)
+    {
+      return ok && (m_head == 0xffff || m_head < m_used);
+    }
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
   uint16_t current = m_head;
@@ -379,10 +414,7 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+  if (m_used + n > m_data->m_size || !IsAppendable ())
     {
       ReserveCopy (n);
     }
@@ -417,10 +449,7 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
-  if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+  if (m_used + n > m_data->m_size || !IsAppendable ())
     {
       ReserveCopy (n);
     }
@@ -504,7 +533,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
    */
 
   // create a copy of the packet without its tail.
-  PacketMetadata h (m_packetUid, 0);
+  PacketMetadata h (m_packetUid, 0, false);
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -575,6 +604,7 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
+#ifndef NS3_MTP
   while (!m_freeList.empty ()) 
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
@@ -588,6 +618,7 @@ PacketMetadata::Create (uint32_t size)
       NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
       PacketMetadata::Deallocate (data);
     }
+#endif
   NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
   return PacketMetadata::Allocate (m_maxSize);
 }
@@ -596,6 +627,10 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
+#ifdef NS3_MTP
+  // no free list in multithreaded builds.
+  PacketMetadata::Deallocate (data);
+#else
   if (!m_enable)
     {
       PacketMetadata::Deallocate (data);
@@ -612,6 +647,7 @@ PacketMetadata::Recycle (struct PacketMetadata::Data *data)
     {
       m_freeList.push_back (data);
     }
+#endif
 }
 
 struct PacketMetadata::Data *
@@ -656,26 +692,30 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
-  DoAddHeader (uid, size);
+  DoAddHeader (uid, size, m_chunkUid++);
   NS_ASSERT (IsStateOk ());
 }
 void
-PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
+PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size, uint16_t chunkUid)
 {
-  NS_LOG_FUNCTION (this << uid << size);
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   if (!m_enable)
     {
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      LazyAddChunk (LAZY_ADD_HEADER, uid, size, chunkUid);
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
   item.prev = 0xffff;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
@@ -685,11 +725,23 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
+  DoRemoveHeader (uid, size);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::DoRemoveHeader (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      LazyRemoveChunk (LAZY_REMOVE_HEADER, LAZY_ADD_HEADER, uid, size);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -725,7 +777,6 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
     {
       m_head = item.next;
     }
-  NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
@@ -733,21 +784,31 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
+  DoAddTrailer (uid, size, m_chunkUid++);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::DoAddTrailer (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   if (!m_enable)
     {
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      LazyAddChunk (LAZY_ADD_TRAILER, uid, size, chunkUid);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
-  NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
@@ -755,11 +816,23 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
+  DoRemoveTrailer (uid, size);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::DoRemoveTrailer (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   if (!m_enable) 
     {
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      LazyRemoveChunk (LAZY_REMOVE_TRAILER, LAZY_ADD_TRAILER, uid, size);
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -795,7 +868,6 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
     {
       m_tail = item.prev;
     }
-  NS_ASSERT (IsStateOk ());
 }
 void
 PacketMetadata::AddAtEnd (PacketMetadata const&o)
@@ -807,6 +879,28 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      if (m_used == 0)
+        {
+          // Nothing recorded yet so 'AddAtEnd' is
+          // equivalent to self-assignment.
+          *this = o;
+        }
+      else
+        {
+          LazyAddAtEnd (o);
+        }
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  if (o.m_lazy)
+    {
+      PacketMetadata eager = o;
+      eager.MakeEager ();
+      AddAtEnd (eager);
+      return;
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -895,6 +989,12 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      LazyRemoveBytes (LAZY_REMOVE_AT_START, start);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -921,7 +1021,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment (m_packetUid, 0, false);
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -958,6 +1058,12 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy)
+    {
+      LazyRemoveBytes (LAZY_REMOVE_AT_END, end);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -985,7 +1091,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment (m_packetUid, 0, false);
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1036,6 +1142,329 @@ PacketMetadata::GetTotalSize (void) const
   return totalSize;
 }
 
+uint8_t *
+PacketMetadata::LazyReserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_ASSERT (m_lazy);
+  // room for the record and its trailing size.
+  n += 2;
+  if (m_used + n > 0xffff)
+    {
+      NS_FATAL_ERROR ("Packet metadata trace too large");
+    }
+  if (m_used + n > m_data->m_size || !IsAppendable ())
+    {
+      struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + n);
+      memcpy (newData->m_data, m_data->m_data, m_used);
+      newData->m_dirtyEnd = m_used;
+      if (--m_data->m_count == 0)
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+      m_data = newData;
+    }
+  return &m_data->m_data[m_used];
+}
+void
+PacketMetadata::LazyCommit (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  Append16 (n + 2, &m_data->m_data[m_used + n]);
+  m_head = m_used;
+  m_used += n + 2;
+  m_data->m_dirtyEnd = m_used;
+}
+void
+PacketMetadata::LazyPop (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_head != 0xffff);
+  m_used = m_head;
+  if (m_head == 0)
+    {
+      m_head = 0xffff;
+    }
+  else
+    {
+      const uint8_t *buffer = &m_data->m_data[m_head - 2];
+      m_head -= buffer[0] | (buffer[1] << 8);
+    }
+}
+void
+PacketMetadata::LazyAddChunk (uint8_t op, uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (op) << uid << size << chunkUid);
+  uint32_t uidSize = GetUleb128Size (uid);
+  uint32_t sizeSize = GetUleb128Size (size);
+  uint32_t n = 1 + uidSize + sizeSize + 2;
+  uint8_t *buffer = LazyReserve (n);
+  buffer[0] = op;
+  buffer++;
+  AppendValue (uid, buffer);
+  buffer += uidSize;
+  AppendValue (size, buffer);
+  buffer += sizeSize;
+  Append16 (chunkUid, buffer);
+  LazyCommit (n);
+  LazyCheckSize ();
+}
+void
+PacketMetadata::LazyRemoveChunk (uint8_t op, uint8_t addOp, uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (op) << uid << size);
+  if (m_head != 0xffff && m_data->m_data[m_head] == addOp)
+    {
+      const uint8_t *buffer = &m_data->m_data[m_head + 1];
+      uint32_t lastUid = ReadUleb128 (&buffer);
+      uint32_t lastSize = ReadUleb128 (&buffer);
+      if (lastUid == uid && lastSize == size)
+        {
+          // the last operation added this very chunk: forget both.
+          LazyPop ();
+          return;
+        }
+    }
+  uint32_t uidSize = GetUleb128Size (uid);
+  uint32_t sizeSize = GetUleb128Size (size);
+  uint32_t n = 1 + uidSize + sizeSize;
+  uint8_t *buffer = LazyReserve (n);
+  buffer[0] = op;
+  buffer++;
+  AppendValue (uid, buffer);
+  buffer += uidSize;
+  AppendValue (size, buffer);
+  LazyCommit (n);
+  LazyCheckSize ();
+}
+void
+PacketMetadata::LazyRemoveBytes (uint8_t op, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (op) << size);
+  if (size == 0)
+    {
+      return;
+    }
+  if (m_head != 0xffff && m_data->m_data[m_head] == op)
+    {
+      // merge with the previous removal at the same end.
+      const uint8_t *buffer = &m_data->m_data[m_head + 1];
+      size += ReadUleb128 (&buffer);
+      LazyPop ();
+    }
+  uint32_t sizeSize = GetUleb128Size (size);
+  uint32_t n = 1 + sizeSize;
+  uint8_t *buffer = LazyReserve (n);
+  buffer[0] = op;
+  AppendValue (size, buffer + 1);
+  LazyCommit (n);
+  LazyCheckSize ();
+}
+void
+PacketMetadata::LazyAddAtEnd (PacketMetadata const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  if (!o.m_lazy)
+    {
+      PacketMetadata items (o.m_packetUid, 0, true);
+      items.LazyAddItems (o);
+      LazyAddAtEnd (items);
+      return;
+    }
+  if (o.m_used == 0)
+    {
+      // we have nothing to append.
+      return;
+    }
+  uint32_t n = 1 + 8 + 2 + o.m_used;
+  uint8_t *buffer = LazyReserve (n);
+  buffer[0] = LAZY_ADD_AT_END;
+  Append32 (o.m_packetUid & 0xffffffff, buffer + 1);
+  Append32 (o.m_packetUid >> 32, buffer + 5);
+  Append16 (o.m_used, buffer + 9);
+  // o may be this metadata: its trace is left untouched until the
+  // commit below.
+  memcpy (buffer + 11, o.m_data->m_data, o.m_used);
+  LazyCommit (n);
+  LazyCheckSize ();
+}
+void
+PacketMetadata::LazyAddItems (PacketMetadata const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (!o.m_lazy);
+  uint16_t current = o.m_head;
+  while (current != 0xffff)
+    {
+      struct PacketMetadata::SmallItem item;
+      PacketMetadata::ExtraItem extraItem;
+      o.ReadItems (current, &item, &extraItem);
+      uint32_t typeUidSize = GetUleb128Size (item.typeUid);
+      uint32_t sizeSize = GetUleb128Size (item.size);
+      uint32_t fragStartSize = GetUleb128Size (extraItem.fragmentStart);
+      uint32_t fragEndSize = GetUleb128Size (extraItem.fragmentEnd);
+      uint32_t n = 1 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
+      uint8_t *buffer = LazyReserve (n);
+      buffer[0] = LAZY_ITEM;
+      buffer++;
+      AppendValue (item.typeUid, buffer);
+      buffer += typeUidSize;
+      AppendValue (item.size, buffer);
+      buffer += sizeSize;
+      Append16 (item.chunkUid, buffer);
+      buffer += 2;
+      AppendValue (extraItem.fragmentStart, buffer);
+      buffer += fragStartSize;
+      AppendValue (extraItem.fragmentEnd, buffer);
+      buffer += fragEndSize;
+      Append32 (extraItem.packetUid, buffer);
+      LazyCommit (n);
+      if (current == o.m_tail)
+        {
+          break;
+        }
+      current = item.next;
+    }
+}
+void
+PacketMetadata::LazyCheckSize (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used <= LAZY_COMPACT_SIZE ||
+      (m_tail != 0xffff && m_used <= 2 * m_tail))
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("compact trace of size " << m_used);
+  PacketMetadata eager (m_packetUid, 0, false);
+  LazyReplay (m_data->m_data, m_used, &eager);
+  PacketMetadata compact (m_packetUid, 0, true);
+  compact.LazyAddItems (eager);
+  compact.m_tail = compact.m_used;
+  *this = compact;
+}
+void
+PacketMetadata::LazyReplay (const uint8_t *buffer, uint32_t size, PacketMetadata *eager) const
+{
+  NS_LOG_FUNCTION (this << &buffer << size << eager);
+  NS_ASSERT (!eager->m_lazy);
+  const uint8_t *end = buffer + size;
+  while (buffer < end)
+    {
+      uint8_t op = buffer[0];
+      buffer++;
+      switch (op)
+        {
+        case LAZY_ADD_HEADER:
+        case LAZY_ADD_TRAILER:
+          {
+            uint32_t uid = ReadUleb128 (&buffer);
+            uint32_t chunkSize = ReadUleb128 (&buffer);
+            uint16_t chunkUid = buffer[0] | (buffer[1] << 8);
+            buffer += 2;
+            if (op == LAZY_ADD_HEADER)
+              {
+                eager->DoAddHeader (uid, chunkSize, chunkUid);
+              }
+            else
+              {
+                eager->DoAddTrailer (uid, chunkSize, chunkUid);
+              }
+            break;
+          }
+        case LAZY_REMOVE_HEADER:
+        case LAZY_REMOVE_TRAILER:
+          {
+            uint32_t uid = ReadUleb128 (&buffer);
+            uint32_t chunkSize = ReadUleb128 (&buffer);
+            if (op == LAZY_REMOVE_HEADER)
+              {
+                eager->DoRemoveHeader (uid, chunkSize);
+              }
+            else
+              {
+                eager->DoRemoveTrailer (uid, chunkSize);
+              }
+            break;
+          }
+        case LAZY_REMOVE_AT_START:
+          eager->RemoveAtStart (ReadUleb128 (&buffer));
+          break;
+        case LAZY_REMOVE_AT_END:
+          eager->RemoveAtEnd (ReadUleb128 (&buffer));
+          break;
+        case LAZY_ADD_AT_END:
+          {
+            uint64_t packetUid = buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) |
+              (static_cast<uint64_t> (buffer[3]) << 24);
+            packetUid |= static_cast<uint64_t> (buffer[4] | (buffer[5] << 8) | (buffer[6] << 16) |
+                                                (static_cast<uint32_t> (buffer[7]) << 24)) << 32;
+            uint16_t otherSize = buffer[8] | (buffer[9] << 8);
+            buffer += 10;
+            PacketMetadata other (packetUid, 0, false);
+            LazyReplay (buffer, otherSize, &other);
+            buffer += otherSize;
+            if (eager->m_tail != 0xffff)
+              {
+                eager->AddAtEnd (other);
+                break;
+              }
+            // Unlike AddAtEnd, keep the uid of this packet, which
+            // was already set when the operation was recorded.
+            uint16_t current = other.m_head;
+            while (current != 0xffff)
+              {
+                struct PacketMetadata::SmallItem item;
+                PacketMetadata::ExtraItem extraItem;
+                other.ReadItems (current, &item, &extraItem);
+                uint16_t written = eager->AddBig (0xffff, eager->m_tail, &item, &extraItem);
+                eager->UpdateTail (written);
+                if (current == other.m_tail)
+                  {
+                    break;
+                  }
+                current = item.next;
+              }
+            break;
+          }
+        case LAZY_ITEM:
+          {
+            struct PacketMetadata::SmallItem item;
+            PacketMetadata::ExtraItem extraItem;
+            item.typeUid = ReadUleb128 (&buffer);
+            item.size = ReadUleb128 (&buffer);
+            item.chunkUid = buffer[0] | (buffer[1] << 8);
+            buffer += 2;
+            extraItem.fragmentStart = ReadUleb128 (&buffer);
+            extraItem.fragmentEnd = ReadUleb128 (&buffer);
+            extraItem.packetUid = buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) |
+              (static_cast<uint64_t> (buffer[3]) << 24);
+            buffer += 4;
+            uint16_t written = eager->AddBig (0xffff, eager->m_tail, &item, &extraItem);
+            eager->UpdateTail (written);
+            break;
+          }
+        default:
+          NS_FATAL_ERROR ("Invalid packet metadata trace");
+        }
+      // skip the size of the record.
+      buffer += 2;
+    }
+  NS_ASSERT (buffer == end);
+}
+void
+PacketMetadata::MakeEager (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_lazy)
+    {
+      return;
+    }
+  PacketMetadata eager (m_packetUid, 0, false);
+  LazyReplay (m_data->m_data, m_used, &eager);
+  *this = eager;
+}
+
 uint64_t 
 PacketMetadata::GetUid (void) const
 {
@@ -1050,12 +1479,66 @@ PacketMetadata::BeginItem (Buffer buffer) const
 }
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
   : m_metadata (metadata),
+    m_eager (0),
     m_buffer (buffer),
     m_current (metadata->m_head),
     m_offset (0),
     m_hasReadTail (false)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
+  if (metadata->m_lazy)
+    {
+      // the metadata may be shared by other packets, or read by other
+      // threads: its items are rebuilt into a copy which the iterator
+      // owns, and the metadata itself is left untouched.
+      m_eager = new PacketMetadata (*metadata);
+      m_eager->MakeEager ();
+      m_metadata = m_eager;
+      m_current = m_eager->m_head;
+    }
+}
+PacketMetadata::ItemIterator::ItemIterator (const ItemIterator &o)
+  : m_metadata (o.m_metadata),
+    m_eager (0),
+    m_buffer (o.m_buffer),
+    m_current (o.m_current),
+    m_offset (o.m_offset),
+    m_hasReadTail (o.m_hasReadTail)
+{
+  NS_LOG_FUNCTION (this << &o);
+  if (o.m_eager != 0)
+    {
+      m_eager = new PacketMetadata (*o.m_eager);
+      m_metadata = m_eager;
+    }
+}
+PacketMetadata::ItemIterator &
+PacketMetadata::ItemIterator::operator = (const ItemIterator &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  if (this == &o)
+    {
+      return *this;
+    }
+  delete m_eager;
+  m_eager = 0;
+  m_metadata = o.m_metadata;
+  if (o.m_eager != 0)
+    {
+      m_eager = new PacketMetadata (*o.m_eager);
+      m_metadata = m_eager;
+    }
+  m_buffer = o.m_buffer;
+  m_current = o.m_current;
+  m_offset = o.m_offset;
+  m_hasReadTail = o.m_hasReadTail;
+  return *this;
+}
+PacketMetadata::ItemIterator::~ItemIterator ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_eager;
+  m_eager = 0;
 }
 bool
 PacketMetadata::ItemIterator::HasNext (void) const
@@ -1145,6 +1628,12 @@ PacketMetadata::GetSerializedSize (void) const
     {
       return totalSize;
     }
+  if (m_lazy)
+    {
+      PacketMetadata eager = *this;
+      eager.MakeEager ();
+      return eager.GetSerializedSize ();
+    }
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -1178,6 +1667,12 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_lazy)
+    {
+      PacketMetadata eager = *this;
+      eager.MakeEager ();
+      return eager.Serialize (buffer, maxSize);
+    }
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1279,6 +1774,11 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_lazy)
+    {
+      // the deserialized items are stored eagerly.
+      *this = PacketMetadata (m_packetUid, 0, false);
+    }
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
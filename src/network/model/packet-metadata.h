@@ -27,6 +27,9 @@
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
 #include "buffer.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3 {
 
@@ -74,6 +77,20 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * Maintaining this linked list on every operation is costly, so the
+ * metadata can instead be recorded lazily (see EnableLazy). The
+ * byte buffer of a lazy metadata then holds a compact trace of the
+ * operations performed on the packet (header and trailer additions
+ * and removals, fragmentation and concatenation) rather than its
+ * items, and the linked list is only rebuilt from that trace when it
+ * is actually needed: to iterate over the items or to serialize the
+ * metadata. Each record of the trace ends with its own size so that
+ * the trace can also be walked backwards: removing the header or
+ * trailer which was added by the last recorded operation just drops
+ * that operation from the trace, and consecutive removals of bytes
+ * at the same end of the packet are merged. When a trace grows too
+ * large, it is compacted into one record per item of the linked list.
  */
 class PacketMetadata 
 {
@@ -134,6 +151,18 @@ public:
      * \param buffer the buffer the metadata refers to
      */
     ItemIterator (const PacketMetadata *metadata, Buffer buffer);
+    /**
+     * \brief Copy constructor
+     * \param o the iterator to copy
+     */
+    ItemIterator (const ItemIterator &o);
+    /**
+     * \brief Assignment operator
+     * \param o the iterator to copy
+     * \returns a reference to this iterator
+     */
+    ItemIterator &operator = (const ItemIterator &o);
+    ~ItemIterator ();
     /**
      * \brief Checks if there is another metadata item
      * \returns true if there is another item
@@ -146,6 +175,11 @@ public:
     Item Next (void);
 private:
     const PacketMetadata *m_metadata; //!< pointer to the metadata
+    /**
+     * The items rebuilt from a lazy metadata, which the iterator owns,
+     * or zero if the metadata iterated over is eager
+     */
+    PacketMetadata *m_eager;
     Buffer m_buffer; //!< buffer the metadata refers to
     uint16_t m_current; //!< current position
     uint32_t m_offset; //!< offset
@@ -160,6 +194,23 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata, recorded lazily
+   *
+   * The metadata of the packets created from now on only record a
+   * trace of the operations performed on the packets, and rebuild
+   * their list of items from that trace when BeginItem, Serialize or
+   * GetSerializedSize is called. The metadata checking, when enabled,
+   * takes precedence over the lazy recording.
+   */
+  static void EnableLazy (void);
+  /**
+   * \brief Record the metadata of the packets created from now on
+   * eagerly again
+   *
+   * The packets which record their metadata lazily keep doing so.
+   */
+  static void DisableLazy (void);
 
   /**
    * \brief Constructor
@@ -413,7 +464,11 @@ private:
    */
   struct Data {
     /** number of references to this struct Data instance. */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /** size (in bytes) of m_data buffer below */
     uint16_t m_size;
     /** max of the m_used field over all objects which
@@ -508,6 +563,30 @@ public:
   friend class ItemIterator;
 
   PacketMetadata ();
+  /**
+   * \brief Constructor
+   * \param uid packet uid
+   * \param size size of the header
+   * \param lazy true if the metadata is recorded lazily
+   */
+  inline PacketMetadata (uint64_t uid, uint32_t size, bool lazy);
+
+  /// The operations recorded in the trace of a lazy metadata
+  enum LazyOp {
+    LAZY_ADD_HEADER = 1,      //!< AddHeader: uid, size, chunk uid
+    LAZY_ADD_TRAILER = 2,     //!< AddTrailer: uid, size, chunk uid
+    LAZY_REMOVE_HEADER = 3,   //!< RemoveHeader: uid, size
+    LAZY_REMOVE_TRAILER = 4,  //!< RemoveTrailer: uid, size
+    LAZY_REMOVE_AT_START = 5, //!< RemoveAtStart: size
+    LAZY_REMOVE_AT_END = 6,   //!< RemoveAtEnd: size
+    LAZY_ADD_AT_END = 7,      //!< AddAtEnd: packet uid, trace of the other packet
+    LAZY_ITEM = 8             //!< An item of a compacted trace
+  };
+  /**
+   * The size beyond which the trace of a lazy metadata is compacted,
+   * unless it is less than twice as large as after its last compaction.
+   */
+  static const uint16_t LAZY_COMPACT_SIZE = 512;
 
   /**
    * \brief Add a SmallItem
@@ -592,6 +671,11 @@ public:
    * \param n space to reserve
    */
   inline void Reserve (uint32_t n);
+  /**
+   * \brief Check whether new items can be written in place at m_used
+   * \returns true if the metadata storage does not need to be copied
+   */
+  inline bool IsAppendable (void) const;
   /**
    * \brief Reserve space and make a metadata copy
    * \param n space to reserve
@@ -618,8 +702,91 @@ public:
    * \brief Add an header
    * \param uid header's uid to add
    * \param size header serialized size
+   * \param chunkUid the uid of the header instance
    */
-  void DoAddHeader (uint32_t uid, uint32_t size);
+  void DoAddHeader (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove an header
+   * \param uid header's uid to remove
+   * \param size header serialized size
+   */
+  void DoRemoveHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add a trailer
+   * \param uid trailer's uid to add
+   * \param size trailer serialized size
+   * \param chunkUid the uid of the trailer instance
+   */
+  void DoAddTrailer (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove a trailer
+   * \param uid trailer's uid to remove
+   * \param size trailer serialized size
+   */
+  void DoRemoveTrailer (uint32_t uid, uint32_t size);
+
+  /**
+   * \brief Make room for a new record at the end of the lazy trace
+   * \param n the size of the record, without its trailing size
+   * \returns where to write the record
+   */
+  uint8_t *LazyReserve (uint32_t n);
+  /**
+   * \brief Append the record written after LazyReserve to the lazy trace
+   * \param n the size of the record, without its trailing size
+   */
+  void LazyCommit (uint32_t n);
+  /**
+   * \brief Drop the last record of the lazy trace
+   */
+  void LazyPop (void);
+  /**
+   * \brief Record the addition of a header or trailer
+   * \param op LAZY_ADD_HEADER or LAZY_ADD_TRAILER
+   * \param uid the uid of the header or trailer
+   * \param size its serialized size
+   * \param chunkUid the uid of the header or trailer instance
+   */
+  void LazyAddChunk (uint8_t op, uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Record the removal of a header or trailer
+   * \param op LAZY_REMOVE_HEADER or LAZY_REMOVE_TRAILER
+   * \param addOp the matching LAZY_ADD_HEADER or LAZY_ADD_TRAILER
+   * \param uid the uid of the header or trailer
+   * \param size its serialized size
+   */
+  void LazyRemoveChunk (uint8_t op, uint8_t addOp, uint32_t uid, uint32_t size);
+  /**
+   * \brief Record the removal of bytes at either end of the packet
+   * \param op LAZY_REMOVE_AT_START or LAZY_REMOVE_AT_END
+   * \param size the number of bytes removed
+   */
+  void LazyRemoveBytes (uint8_t op, uint32_t size);
+  /**
+   * \brief Record the concatenation of another packet
+   * \param o the metadata of the other packet
+   */
+  void LazyAddAtEnd (PacketMetadata const &o);
+  /**
+   * \brief Record all the items of an eager metadata
+   * \param o the eager metadata
+   */
+  void LazyAddItems (PacketMetadata const &o);
+  /**
+   * \brief Compact the lazy trace if it has grown too large
+   */
+  void LazyCheckSize (void);
+  /**
+   * \brief Replay a lazy trace
+   * \param buffer the trace
+   * \param size the size of the trace
+   * \param eager the eager metadata to replay the trace into
+   */
+  void LazyReplay (const uint8_t *buffer, uint32_t size, PacketMetadata *eager) const;
+  /**
+   * \brief Rebuild the linked list of items of a lazy metadata
+   */
+  void MakeEager (void);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -661,9 +828,12 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
+#ifndef NS3_MTP
   static DataFreeList m_freeList; //!< the metadata data storage
+#endif
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_enableLazy; //!< Record the metadata of the new packets lazily
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -672,8 +842,13 @@ public:
    */
   static bool m_metadataSkipped;
 
+#ifdef NS3_MTP
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
+#else
   static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
+#endif
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -681,9 +856,15 @@ public:
        ^             |
         \---(prev)---|
    */
+  /*
+     In a lazy metadata, m_head is the offset of the last record of the
+     trace, and m_tail the size of the trace after its last compaction;
+     both are 0xffff if there is no such record or compaction.
+   */
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  bool m_lazy; //!< true if m_data holds a trace rather than items
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -692,16 +873,21 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
+  : PacketMetadata (uid, size, m_enableLazy && !m_enableChecking)
+{
+}
+PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size, bool lazy)
   : m_data (PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_lazy (lazy),
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
-      DoAddHeader (0, size);
+      DoAddHeader (0, size, m_chunkUid++);
     }
 }
 PacketMetadata::PacketMetadata (PacketMetadata const &o)
@@ -709,6 +895,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_lazy (o.m_lazy),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
@@ -722,8 +909,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0)
         {
           PacketMetadata::Recycle (m_data);
         }
@@ -734,14 +920,14 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_lazy = o.m_lazy;
   m_packetUid = o.m_packetUid;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (--m_data->m_count == 0)
     {
       PacketMetadata::Recycle (m_data);
     }
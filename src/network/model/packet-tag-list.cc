@@ -51,6 +51,50 @@ PacketTagList::CreateTagData (size_t dataSize)
   return tag;
 }
 
+uint32_t
+PacketTagList::FindInline (TypeId tid) const
+{
+  for (uint32_t i = 0; i < m_inline.n; ++i)
+    {
+      if (m_inline.tid[i] == tid)
+        {
+          return i;
+        }
+    }
+  return m_inline.n;
+}
+
+void
+PacketTagList::RemoveInline (uint32_t i)
+{
+  NS_ASSERT (i < m_inline.n);
+  for (uint32_t j = i + 1; j < m_inline.n; ++j)
+    {
+      m_inline.tid[j - 1] = m_inline.tid[j];
+      m_inline.size[j - 1] = m_inline.size[j];
+      std::memcpy (m_inline.data[j - 1], m_inline.data[j], m_inline.size[j]);
+    }
+  m_inline.n--;
+}
+
+void
+PacketTagList::CopyFrom (PacketTagList const &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (m_next == 0);
+  struct TagData **prevNext = &m_next;
+  for (const struct TagData *cur = o.m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData * copy = CreateTagData (cur->size);
+      copy->tid = cur->tid;
+      copy->count = 1;
+      copy->next = 0;
+      memcpy (copy->data, cur->data, copy->size);
+      *prevNext = copy;
+      prevNext = &copy->next;
+    }
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -175,6 +219,13 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  uint32_t i = m_inline.n == 0 ? 0 : FindInline (tag.GetInstanceTypeId ());
+  if (i < m_inline.n)
+    {
+      tag.Deserialize (TagBuffer (m_inline.data[i], m_inline.data[i] + m_inline.size[i]));
+      RemoveInline (i);
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
@@ -214,6 +265,13 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  uint32_t i = m_inline.n == 0 ? 0 : FindInline (tag.GetInstanceTypeId ());
+  if (i < m_inline.n)
+    {
+      // just rewrite, as ReplaceWriter does before the first merge
+      tag.Serialize (TagBuffer (m_inline.data[i], m_inline.data[i] + m_inline.size[i]));
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -261,12 +319,26 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
+  NS_ASSERT_MSG (FindInline (tag.GetInstanceTypeId ()) == m_inline.n,
+                 "Error: cannot add the same kind of tag twice.");
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
                      "Error: cannot add the same kind of tag twice.");
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
+  uint32_t size = tag.GetSerializedSize ();
+  // a tag is only stored inline while there is no TagData, so that the
+  // inline tags are always older than the TagData.
+  if (m_next == 0 && m_inline.n < INLINE_TAGS && size <= INLINE_TAG_SIZE)
+    {
+      struct InlineTags &tags = const_cast<PacketTagList *> (this)->m_inline;
+      tags.tid[tags.n] = tag.GetInstanceTypeId ();
+      tags.size[tags.n] = size;
+      tag.Serialize (TagBuffer (tags.data[tags.n], tags.data[tags.n] + size));
+      tags.n++;
+      return;
+    }
+  struct TagData * head = CreateTagData (size);
   head->count = 1;
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
@@ -281,6 +353,13 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  uint32_t i = FindInline (tid);
+  if (i < m_inline.n)
+    {
+      uint8_t *data = const_cast<uint8_t *> (m_inline.data[i]);
+      tag.Deserialize (TagBuffer (data, data + m_inline.size[i]));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -119,6 +119,21 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Inline tags </b>
+ *
+ *   - Up to #INLINE_TAGS tags whose serialized size is at most
+ *     #INLINE_TAG_SIZE bytes are not stored in the tree but in the
+ *     PacketTagList itself, as long as the list has no TagData yet.
+ *     Most packets carry only one or two small tags, so most of them
+ *     never allocate any TagData.
+ *
+ *   - The inline tags are thus always older than the tags of the tree,
+ *     and the tags are visited in the same order as if they were all in
+ *     the tree: the most recent one first.
+ *
+ *   - The inline tags are copied along with the PacketTagList, instead
+ *     of being shared, so they are read and written in place.
  */
 class PacketTagList 
 {
@@ -214,11 +229,47 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of tag list, which does not include the
+   *          inline tags.
    */
   const struct PacketTagList::TagData *Head (void) const;
 
 private:
+  /// Friend class, to iterate over the inline tags.
+  friend class PacketTagIterator;
+
+  /** The largest serialized size of an inline tag. */
+  static const uint32_t INLINE_TAG_SIZE = 8;
+  /** The largest number of inline tags. */
+  static const uint32_t INLINE_TAGS = 2;
+
+  /**
+   * The tags stored in the PacketTagList itself, in the order they
+   * were added.  They make each PacketTagList 24 bytes larger.
+   */
+  struct InlineTags
+  {
+    TypeId tid[INLINE_TAGS];                  /**< Type of each tag */
+    uint8_t size[INLINE_TAGS];                /**< Serialized size of each tag */
+    uint8_t n;                                /**< Number of tags */
+    uint8_t data[INLINE_TAGS][INLINE_TAG_SIZE]; /**< Serialization buffers */
+  };
+
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The type of the tag.
+   * \returns The index of the tag in #m_inline, or its number of tags
+   *          if not found.
+   */
+  uint32_t FindInline (TypeId tid) const;
+  /**
+   * Remove an inline tag, keeping the order of the others.
+   *
+   * \param [in] i The index of the tag in #m_inline.
+   */
+  void RemoveInline (uint32_t i);
+
   /**
    * Allocate and construct a TagData struct, sizing the data area
    * large enough to serialize dataSize bytes from a Tag.
@@ -228,6 +279,16 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Copy all the tags of another list into this empty list,
+   * without sharing any TagData.
+   *
+   * Multithreaded builds (NS3_MTP) copy lists this way, since the
+   * copies of a packet may then be used concurrently by several threads.
+   *
+   * \param [in] o The PacketTagList to copy.
+   */
+  void CopyFrom (PacketTagList const &o);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -282,6 +343,10 @@ private:
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /**
+   * The inline tags
+   */
+  struct InlineTags m_inline;
 };
 
 } // namespace ns3
@@ -295,31 +360,43 @@ namespace ns3 {
 PacketTagList::PacketTagList ()
   : m_next ()
 {
+  m_inline.n = 0;
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_inline (o.m_inline)
 {
+#ifdef NS3_MTP
+  m_next = 0;
+  CopyFrom (o);
+#else
   if (m_next != 0)
     {
       m_next->count++;
     }
+#endif
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o)
     {
       return *this;
     }
   RemoveAll ();
+  m_inline = o.m_inline;
+#ifdef NS3_MTP
+  CopyFrom (o);
+#else
   m_next = o.m_next;
   if (m_next != 0) 
     {
       m_next->count++;
     }
+#endif
   return *this;
 }
 
@@ -331,6 +408,7 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
+  m_inline.n = 0;
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
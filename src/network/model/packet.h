@@ -155,10 +155,14 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the type of the tag.
+     * \param data the serialized tag.
+     * \param size the size of the serialized tag.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data, uint32_t size);
+    TypeId m_tid;           //!< the type of the tag
+    const uint8_t *m_data;  //!< the serialized tag
+    uint32_t m_size;        //!< the size of the serialized tag
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -173,9 +177,11 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the list of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const PacketTagList *list);
+  const PacketTagList *m_list;  //!< the list of the items
+  uint32_t m_inline;  //!< number of inline tags left to visit
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
 };
 
@@ -199,7 +205,8 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. Packet::EnableLazyPrinting lowers the cost
+ * of the metadata further by rebuilding it only when it is used.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -530,6 +537,16 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing packets metadata, recorded lazily.
+   *
+   * Like EnablePrinting, but each packet only records a compact
+   * trace of the operations performed on it, from which its list of
+   * headers and trailers is rebuilt the first time it is printed,
+   * iterated over or serialized. This makes the metadata much cheaper
+   * to maintain for the packets which are never printed.
+   */
+  static void EnableLazyPrinting (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -766,7 +783,15 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+#ifdef NS3_MTP
+  /**
+   * Per-thread counter of packets Uid: the system id held in the
+   * upper bits of the packet uid tells the threads apart.
+   */
+  static thread_local uint32_t m_globalUid;
+#else
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
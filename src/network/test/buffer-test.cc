@@ -22,6 +22,9 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -378,6 +381,360 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer slices unit tests.
+ */
+class BufferSlicesTest : public TestCase {
+private:
+  /**
+   * Create a buffer filled with a byte pattern.
+   * \param size The buffer size
+   * \param seed The first byte of the pattern
+   * \param [out] bytes The bytes of the buffer are appended here
+   * \returns The buffer
+   */
+  Buffer Fill (uint32_t size, uint8_t seed, std::vector<uint8_t> &bytes);
+  /**
+   * Checks the buffer content through all the access methods.
+   * \param b The buffer to check
+   * \param expected The expected bytes
+   * \param file The file name
+   * \param line The line number
+   */
+  void EnsureContent (Buffer b, std::vector<uint8_t> expected, const char *file, int line);
+public:
+  virtual void DoRun (void);
+  BufferSlicesTest ();
+};
+
+BufferSlicesTest::BufferSlicesTest ()
+  : TestCase ("Buffer slices")
+{
+}
+
+Buffer
+BufferSlicesTest::Fill (uint32_t size, uint8_t seed, std::vector<uint8_t> &bytes)
+{
+  Buffer b;
+  b.AddAtStart (size);
+  Buffer::Iterator i = b.Begin ();
+  for (uint32_t j = 0; j < size; j++)
+    {
+      uint8_t byte = seed + j * 7;
+      i.WriteU8 (byte);
+      bytes.push_back (byte);
+    }
+  return b;
+}
+
+void
+BufferSlicesTest::EnsureContent (Buffer b, std::vector<uint8_t> expected, const char *file, int line)
+{
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (b.GetSize (), expected.size (), "Bad size", file, line);
+  if (b.GetSize () != expected.size ())
+    {
+      return;
+    }
+  uint32_t size = expected.size ();
+
+  std::vector<uint8_t> copied (size + 1);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (b.CopyData (&copied[0], size + 1), size, "Bad CopyData size", file, line);
+  std::ostringstream os;
+  b.CopyData (&os, size);
+  std::string streamed = os.str ();
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (streamed.size (), size, "Bad CopyData stream size", file, line);
+
+  bool copyOk = true;
+  bool streamOk = true;
+  bool readOk = true;
+  bool read16Ok = true;
+  bool read32Ok = true;
+  Buffer::Iterator i = b.Begin ();
+  for (uint32_t j = 0; j < size; j++)
+    {
+      copyOk = copyOk && copied[j] == expected[j];
+      streamOk = streamOk && (uint8_t)streamed[j] == expected[j];
+      readOk = readOk && i.ReadU8 () == expected[j];
+    }
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (i.IsEnd (), true, "Iterator not at end", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (i.GetDistanceFrom (b.Begin ()), size, "Bad distance", file, line);
+  // multi-byte reads at every offset, across the slice boundaries.
+  for (uint32_t j = 0; j + 4 <= size; j++)
+    {
+      i = b.Begin ();
+      i.Next (j);
+      uint16_t v16 = i.ReadNtohU16 ();
+      read16Ok = read16Ok && v16 == ((expected[j] << 8) | expected[j + 1]);
+      i.Prev (2);
+      uint32_t v32 = i.ReadNtohU32 ();
+      read32Ok = read32Ok && v32 == (((uint32_t)expected[j] << 24) | (expected[j + 1] << 16) |
+                                     (expected[j + 2] << 8) | expected[j + 3]);
+    }
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (copyOk, true, "Bad CopyData content", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (streamOk, true, "Bad CopyData stream content", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (readOk, true, "Bad ReadU8", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (read16Ok, true, "Bad ReadNtohU16", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (read32Ok, true, "Bad ReadNtohU32", file, line);
+
+  // Deserialize expects the size to include the size field written by Packet.
+  std::vector<uint8_t> serialized (b.GetSerializedSize ());
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (b.Serialize (&serialized[0], serialized.size ()), 1u, "Serialize failed", file, line);
+  Buffer deserialized (0, false);
+  deserialized.Deserialize (&serialized[0], serialized.size () + 4);
+  std::vector<uint8_t> copied2 (size);
+  deserialized.CopyData (&copied2[0], size);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL ((copied2 == expected), true, "Bad deserialized content", file, line);
+
+  Buffer peeked = b;
+  uint8_t const *data = peeked.PeekData ();
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (peeked.GetNSlices (), 0u, "PeekData kept the slices", file, line);
+  NS_TEST_EXPECT_MSG_EQ_INTERNAL (std::equal (expected.begin (), expected.end (), data), true, "Bad PeekData", file, line);
+}
+
+/// Check the content of a buffer against a byte vector.
+#define ENSURE_CONTENT(buffer, expected) \
+  EnsureContent (buffer, expected, __FILE__, __LINE__)
+
+void
+BufferSlicesTest::DoRun (void)
+{
+  Buffer::EnableSlices ();
+
+  // concatenation
+  std::vector<uint8_t> aBytes;
+  std::vector<uint8_t> bBytes;
+  Buffer a = Fill (600, 1, aBytes);
+  Buffer b = Fill (700, 2, bBytes);
+  Buffer c = a;
+  c.AddAtEnd (b);
+  std::vector<uint8_t> cBytes = aBytes;
+  cBytes.insert (cBytes.end (), bBytes.begin (), bBytes.end ());
+  NS_TEST_EXPECT_MSG_EQ (c.GetNSlices (), 1u, "Concatenation did not chain");
+  ENSURE_CONTENT (c, cBytes);
+  ENSURE_CONTENT (a, aBytes);
+
+  // header in front of a shared buffer
+  Buffer d = c;
+  d.AddAtStart (20);
+  Buffer::Iterator i = d.Begin ();
+  std::vector<uint8_t> dBytes;
+  for (uint8_t j = 0; j < 20; j++)
+    {
+      i.WriteU8 (0xa0 + j);
+      dBytes.push_back (0xa0 + j);
+    }
+  dBytes.insert (dBytes.end (), cBytes.begin (), cBytes.end ());
+  NS_TEST_EXPECT_MSG_EQ (d.GetNSlices (), 2u, "Header prepend did not chain");
+  ENSURE_CONTENT (d, dBytes);
+  ENSURE_CONTENT (c, cBytes);
+
+  // fragments
+  Buffer e = d.CreateFragment (10, 1000);
+  ENSURE_CONTENT (e, std::vector<uint8_t> (dBytes.begin () + 10, dBytes.begin () + 1010));
+  e = d.CreateFragment (700, 500);
+  ENSURE_CONTENT (e, std::vector<uint8_t> (dBytes.begin () + 700, dBytes.begin () + 1200));
+  e = d;
+  e.RemoveAtStart (620);
+  e.RemoveAtEnd (100);
+  NS_TEST_EXPECT_MSG_EQ (e.GetNSlices (), 0u, "Removed slices still there");
+  ENSURE_CONTENT (e, std::vector<uint8_t> (dBytes.begin () + 620, dBytes.end () - 100));
+
+  // trailer and writes across the slice boundaries of private slices
+  std::vector<uint8_t> fBytes;
+  Buffer f = Fill (300, 3, fBytes);
+  {
+    std::vector<uint8_t> gBytes;
+    Buffer g = Fill (300, 4, gBytes);
+    f.AddAtEnd (g);
+    fBytes.insert (fBytes.end (), gBytes.begin (), gBytes.end ());
+  }
+  f.AddAtEnd (6);
+  i = f.End ();
+  i.Prev (6);
+  i.WriteU8 (0x55, 6);
+  fBytes.insert (fBytes.end (), 6, 0x55);
+  i = f.Begin ();
+  i.Next (298);
+  i.WriteHtonU32 (0x01020304);
+  i.Prev (4);
+  uint8_t written[] = { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16 };
+  i.Write (written, 6);
+  fBytes[298] = 0x11; fBytes[299] = 0x12; fBytes[300] = 0x13;
+  fBytes[301] = 0x14; fBytes[302] = 0x15; fBytes[303] = 0x16;
+  ENSURE_CONTENT (f, fBytes);
+
+  // slices with a virtual zero area
+  Buffer z (500);
+  z.AddAtStart (2);
+  z.Begin ().WriteHtonU16 (0x1234);
+  std::vector<uint8_t> zBytes = aBytes;
+  zBytes.push_back (0x12);
+  zBytes.push_back (0x34);
+  zBytes.insert (zBytes.end (), 500, 0);
+  Buffer az = a;
+  az.AddAtEnd (z);
+  ENSURE_CONTENT (az, zBytes);
+
+  // a head with a zero area and data after it, followed by slices: the
+  // zero area of the head is not serialized.
+  Buffer hz (400);
+  hz.AddAtEnd (4);
+  hz.AddAtEnd (b);
+  i = hz.Begin ();
+  i.Next (400);
+  i.WriteHtonU32 (0x0a0b0c0d);
+  std::vector<uint8_t> hzBytes (400, 0);
+  hzBytes.push_back (0x0a);
+  hzBytes.push_back (0x0b);
+  hzBytes.push_back (0x0c);
+  hzBytes.push_back (0x0d);
+  hzBytes.insert (hzBytes.end (), bBytes.begin (), bBytes.end ());
+  NS_TEST_EXPECT_MSG_EQ (hz.GetNSlices (), 1u, "Concatenation did not chain");
+  ENSURE_CONTENT (hz, hzBytes);
+  NS_TEST_EXPECT_MSG_LT (hz.GetSerializedSize (), hz.GetSize (), "Zero area serialized");
+
+  // copy from a buffer with slices into another one
+  Buffer copy;
+  copy.AddAtStart (d.GetSize ());
+  copy.Begin ().Write (d.Begin (), d.End ());
+  ENSURE_CONTENT (copy, dBytes);
+
+  // the number of slices is bounded
+  Buffer many = a;
+  std::vector<uint8_t> manyBytes = aBytes;
+  for (uint32_t j = 0; j < 40; j++)
+    {
+      many.AddAtEnd (b);
+      manyBytes.insert (manyBytes.end (), bBytes.begin (), bBytes.end ());
+    }
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (many.GetNSlices (), 16u, "Too many slices");
+  ENSURE_CONTENT (many, manyBytes);
+
+  Buffer::DisableSlices ();
+  Buffer h = a;
+  h.AddAtEnd (b);
+  NS_TEST_EXPECT_MSG_EQ (h.GetNSlices (), 0u, "Slices disabled but used");
+  ENSURE_CONTENT (h, cBytes);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer data free list unit tests.
+ */
+class BufferFreeListTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFreeListTest ();
+};
+
+BufferFreeListTest::BufferFreeListTest ()
+  : TestCase ("Buffer data free list")
+{
+}
+
+void
+BufferFreeListTest::DoRun (void)
+{
+  Buffer::FlushFreeList ();
+  Buffer::ResetFreeListStats ();
+  Buffer::FreeListStats stats = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.cachedBytes, 0u, "Free list not flushed");
+  NS_TEST_ASSERT_MSG_EQ (stats.allocations, 0u, "Statistics not reset");
+
+  // the first buffer misses, and its data is recycled.
+  {
+    Buffer b;
+    b.AddAtStart (100);
+  }
+  stats = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_GT (stats.misses, 0u, "Empty free list did not miss");
+  NS_TEST_ASSERT_MSG_GT (stats.recycles, 0u, "Buffer data not recycled");
+  NS_TEST_ASSERT_MSG_GT (stats.cachedBytes, 0u, "Buffer data not cached");
+  NS_TEST_ASSERT_MSG_EQ (stats.maxCachedBytes, stats.cachedBytes, "Bad high-water mark");
+  uint64_t misses = stats.misses;
+  uint64_t cachedBytes = stats.cachedBytes;
+
+  // the next buffers of the same size reuse the recycled data.
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Buffer b;
+      b.AddAtStart (100);
+      b.AddAtEnd (20);
+    }
+  stats = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, misses, "Recycled buffer data not reused");
+  NS_TEST_ASSERT_MSG_EQ (stats.cachedBytes, cachedBytes, "Recycled buffer data lost");
+  NS_TEST_ASSERT_MSG_EQ (stats.drops, 0u, "Buffer data dropped");
+
+  // several live buffers raise the high-water mark.
+  {
+    std::vector<Buffer> buffers (4);
+    for (std::vector<Buffer>::iterator i = buffers.begin (); i != buffers.end (); i++)
+      {
+        i->AddAtStart (100);
+      }
+  }
+  stats = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_GT (stats.maxCachedBytes, cachedBytes, "High-water mark not raised");
+  NS_TEST_ASSERT_MSG_EQ (stats.maxCachedBytes, stats.cachedBytes, "Bad high-water mark");
+
+  // a full free list drops the released data.
+  Buffer::SetFreeListLimits (1, 1000000);
+  Buffer::FlushFreeList ();
+  Buffer::ResetFreeListStats ();
+  {
+    std::vector<Buffer> buffers (4);
+    for (std::vector<Buffer>::iterator i = buffers.begin (); i != buffers.end (); i++)
+      {
+        i->AddAtStart (100);
+      }
+  }
+  stats = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_GT (stats.drops, 0u, "Full size class did not drop");
+  NS_TEST_ASSERT_MSG_LT (stats.recycles, 4u, "Full size class recycled");
+
+  Buffer::SetFreeListLimits (1000, 0);
+  Buffer::FlushFreeList ();
+  Buffer::ResetFreeListStats ();
+  {
+    Buffer b;
+    b.AddAtStart (100);
+  }
+  stats = Buffer::GetFreeListStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.recycles, 0u, "Byte limit exceeded");
+  NS_TEST_ASSERT_MSG_EQ (stats.cachedBytes, 0u, "Byte limit exceeded");
+  NS_TEST_ASSERT_MSG_GT (stats.drops, 0u, "Byte limit did not drop");
+
+  // a request for a small buffer data does not take a large one.
+  Buffer::SetFreeListLimits (1000, 4 * 1024 * 1024);
+  Buffer::FlushFreeList ();
+  {
+    Buffer large1;
+    Buffer large2;
+    large1.AddAtEnd (3000);
+    large2.AddAtEnd (3000);
+  }
+  {
+    // the empty buffer takes one of the large buffer data.
+    Buffer a;
+    a.AddAtEnd (20);
+    Buffer::ResetFreeListStats ();
+    cachedBytes = Buffer::GetFreeListStats ().cachedBytes;
+    Buffer b = a;
+    a.AddAtEnd (10);
+    // b cannot write over the bytes of a in the shared buffer data.
+    b.AddAtEnd (10);
+    stats = Buffer::GetFreeListStats ();
+    NS_TEST_EXPECT_MSG_EQ (stats.misses, 1u, "Small buffer data taken from a larger size class");
+    NS_TEST_EXPECT_MSG_EQ (stats.cachedBytes, cachedBytes, "Small buffer data taken from a larger size class");
+  }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +751,8 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferSlicesTest, TestCase::QUICK);
+  AddTestCase (new BufferFreeListTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
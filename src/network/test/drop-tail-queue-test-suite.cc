@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 
 using namespace ns3;
 
@@ -83,6 +84,80 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * DropTailQueue unit tests with the items stored in a ring buffer.
+ */
+class DropTailQueueRingBufferTestCase : public TestCase
+{
+public:
+  DropTailQueueRingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueRingBufferTestCase::DropTailQueueRingBufferTestCase ()
+  : TestCase ("Check the drop tail queue storing its items in a ring buffer")
+{
+}
+void
+DropTailQueueRingBufferTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", StringValue ("40p")), true,
+                         "Verify that we can actually set the attribute");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("RingBuffer", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute");
+
+  // enqueue and dequeue at different rates, so that the items wrap around
+  // the ring buffer while it grows, up to the maximum size
+  std::vector<Ptr<Packet> > packets;
+  uint32_t next = 0;
+  for (uint32_t round = 0; round < 30; round++)
+    {
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          Ptr<Packet> p = Create<Packet> (100);
+          if (queue->Enqueue (p))
+            {
+              packets.push_back (p);
+            }
+        }
+      Ptr<Packet> packet = queue->Dequeue ();
+      NS_TEST_EXPECT_MSG_EQ (packet->GetUid (), packets[next++]->GetUid (), "Packets should be dequeued in order");
+      NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), packets[next]->GetUid (), "The head should be the next packet");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 39, "The queue should have reached its maximum size");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsBeforeEnqueue (), 90 - packets.size (),
+                         "The packets exceeding the maximum size should be dropped");
+
+  std::vector<Ptr<Packet> > batch;
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (10, batch), 10, "Ten packets should be dequeued");
+  for (uint32_t i = 0; i < batch.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (batch[i]->GetUid (), packets[next++]->GetUid (), "Packets should be dequeued in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->Remove ()->GetUid (), packets[next++]->GetUid (), "The head should be removed");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsAfterDequeue (), 1, "The removed packet should be dropped");
+
+  batch.clear ();
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (100, batch), 28, "The remaining packets should be dequeued");
+  NS_TEST_EXPECT_MSG_EQ (batch.back ()->GetUid (), packets.back ()->GetUid (), "The last packet should be the last one enqueued");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "There should be no packets in there");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "There should be no bytes in there");
+  NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () == 0), true, "There are really no packets in there");
+
+  // a queue limited in bytes grows its ring buffer as needed
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", StringValue ("10000B")), true,
+                         "Verify that we can actually set the attribute");
+  for (uint32_t i = 0; i < 101; i++)
+    {
+      queue->Enqueue (Create<Packet> (100));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 100, "The queue should hold 10000 bytes");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +171,7 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueRingBufferTestCase (), TestCase::QUICK);
   }
 };
 
@@ -318,7 +318,11 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
  */
 class PacketMetadataTest : public TestCase {
 public:
-  PacketMetadataTest ();
+  /**
+   * Constructor
+   * \param lazy Whether the metadata is recorded lazily
+   */
+  PacketMetadataTest (bool lazy);
   virtual ~PacketMetadataTest ();
   /**
    * Checks the packet header and trailer history
@@ -337,10 +341,12 @@ private:
    * \return The packet with the header added.
    */
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
+  bool m_lazy; //!< Whether the metadata is recorded lazily
 };
 
-PacketMetadataTest::PacketMetadataTest ()
-  : TestCase ("Packet metadata")
+PacketMetadataTest::PacketMetadataTest (bool lazy)
+  : TestCase (lazy ? "Packet metadata, lazily recorded" : "Packet metadata"),
+    m_lazy (lazy)
 {
 }
 
@@ -478,6 +484,10 @@ void
 PacketMetadataTest::DoRun (void)
 {
   PacketMetadata::Enable ();
+  if (m_lazy)
+    {
+      PacketMetadata::EnableLazy ();
+    }
 
   Ptr<Packet> p = Create<Packet> (0);
   Ptr<Packet> p1 = Create<Packet> (0);
@@ -900,6 +910,35 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  // a header removed and added back at every hop.
+  p = Create<Packet> (1000);
+  ADD_HEADER (p, 10);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      REM_HEADER (p, 10);
+      ADD_HEADER (p, 10);
+    }
+  CHECK_HISTORY (p, 2, 10, 1000);
+
+  // a packet split in many fragments, and reassembled.
+  p1 = Create<Packet> ();
+  for (uint32_t i = 0; i < 101; i++)
+    {
+      p2 = p->CreateFragment (i * 10, 10);
+      ADD_HEADER (p2, 8);
+      REM_HEADER (p2, 8);
+      p1->AddAtEnd (p2);
+    }
+  CHECK_HISTORY (p1, 2, 10, 1000);
+  ADD_TRAILER (p1, 4);
+  p1->RemoveAtStart (15);
+  CHECK_HISTORY (p1, 2, 995, 4);
+
+  if (m_lazy)
+    {
+      PacketMetadata::DisableLazy ();
+    }
 }
 
 
@@ -918,7 +957,8 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
-  AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (false), TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (true), TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -1035,6 +1035,115 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Tag list inline storage unit tests.
+ */
+class PacketTagListInlineTest : public TestCase
+{
+public:
+  PacketTagListInlineTest ();
+private:
+  void DoRun (void);
+  /**
+   * Lists the packet tags in the order the packet tag iterator visits them.
+   * \param p The packet
+   * \return the data of each test tag, or L for the large test tag
+   */
+  static std::string GetTags (Ptr<const Packet> p);
+};
+
+PacketTagListInlineTest::PacketTagListInlineTest ()
+  : TestCase ("Check inline packet tags")
+{
+}
+
+std::string
+PacketTagListInlineTest::GetTags (Ptr<const Packet> p)
+{
+  std::ostringstream oss;
+  PacketTagIterator i = p->GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      PacketTagIterator::Item item = i.Next ();
+      if (item.GetTypeId () == ALargeTestTag::GetTypeId ())
+        {
+          oss << "L";
+          continue;
+        }
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      ATestTagBase *tag = dynamic_cast<ATestTagBase *> (constructor ());
+      item.GetTag (*tag);
+      oss << tag->GetData ();
+      delete tag;
+    }
+  return oss.str ();
+}
+
+void
+PacketTagListInlineTest::DoRun (void)
+{
+  ATestTag<1> t1 (1);
+  ATestTag<2> t2 (2);
+  ATestTag<3> t3 (3);
+  ATestTag<4> t4 (4);
+  ATestTag<5> t5 (5);
+  ALargeTestTag large;
+
+  // the first two tags are inline, the others are in the list: the
+  // tags are still visited from the most recent one.
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddPacketTag (t1);
+  p->AddPacketTag (t2);
+  p->AddPacketTag (large);
+  p->AddPacketTag (t3);
+  p->AddPacketTag (t4);
+  NS_TEST_EXPECT_MSG_EQ (GetTags (p), "43L21", "Bad tags");
+
+  ATestTag<1> r1;
+  ATestTag<4> r4;
+  ALargeTestTag rl;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (r1), true, "Inline tag not found");
+  NS_TEST_EXPECT_MSG_EQ (r1.GetData (), 1, "Bad inline tag value");
+  NS_TEST_EXPECT_MSG_EQ (r1.m_error, false, "Bad inline tag content");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (r4), true, "Listed tag not found");
+  NS_TEST_EXPECT_MSG_EQ (r4.GetData (), 4, "Bad listed tag value");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (rl), true, "Large tag not found");
+
+  // changing the inline tags of a copy leaves the original alone.
+  Ptr<Packet> c = p->Copy ();
+  ATestTag<2> r2;
+  NS_TEST_EXPECT_MSG_EQ (c->RemovePacketTag (r2), true, "Inline tag not removed");
+  NS_TEST_EXPECT_MSG_EQ (r2.GetData (), 2, "Bad removed tag value");
+  ATestTag<1> n1 (7);
+  NS_TEST_EXPECT_MSG_EQ (c->ReplacePacketTag (n1), true, "Inline tag not replaced");
+  ATestTag<3> n3 (9);
+  NS_TEST_EXPECT_MSG_EQ (c->ReplacePacketTag (n3), true, "Listed tag not replaced");
+  c->AddPacketTag (t5);
+  NS_TEST_EXPECT_MSG_EQ (GetTags (c), "549L7", "Bad tags in the copy");
+  NS_TEST_EXPECT_MSG_EQ (GetTags (p), "43L21", "Original changed");
+
+  // a small tag added once the list is empty again is stored inline
+  // too, and the order of the tags is kept.
+  ATestTag<3> r3;
+  NS_TEST_EXPECT_MSG_EQ (c->RemovePacketTag (r3), true, "Listed tag not removed");
+  c->RemovePacketTag (r4);
+  c->RemovePacketTag (rl);
+  ATestTag<5> r5;
+  c->RemovePacketTag (r5);
+  NS_TEST_EXPECT_MSG_EQ (GetTags (c), "7", "Bad tags after removals");
+  c->AddPacketTag (t2);
+  c->AddPacketTag (t3);
+  NS_TEST_EXPECT_MSG_EQ (GetTags (c), "327", "Bad tags after additions");
+  NS_TEST_EXPECT_MSG_EQ (c->PeekPacketTag (r2), true, "Added tag not found");
+
+  c->RemoveAllPacketTags ();
+  NS_TEST_EXPECT_MSG_EQ (GetTags (c), "", "Tags left after RemoveAllPacketTags");
+  NS_TEST_EXPECT_MSG_EQ (GetTags (p), "43L21", "Original lost its tags");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1161,7 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketTagListInlineTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -20,6 +20,7 @@
 #define DROPTAIL_H
 
 #include "ns3/queue.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -27,6 +28,9 @@ namespace ns3 {
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * The items are stored in a list, or in a ring buffer if the RingBuffer
+ * attribute is set (see Queue).
  */
 template <typename Item>
 class DropTailQueue : public Queue<Item>
@@ -52,8 +56,8 @@ public:
   virtual Ptr<const Item> Peek (void) const;
 
 private:
-  using Queue<Item>::Head;
-  using Queue<Item>::Tail;
+  using Queue<Item>::SetRingBuffer;
+  using Queue<Item>::IsRingBuffer;
   using Queue<Item>::DoEnqueue;
   using Queue<Item>::DoDequeue;
   using Queue<Item>::DoRemove;
@@ -75,6 +79,13 @@ DropTailQueue<Item>::GetTypeId (void)
     .SetParent<Queue<Item> > ()
     .SetGroupName ("Network")
     .template AddConstructor<DropTailQueue<Item> > ()
+    .AddAttribute ("RingBuffer",
+                   "Whether the items are stored in a contiguous ring buffer, "
+                   "growing up to the maximum size of the queue, instead of a list.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DropTailQueue<Item>::SetRingBuffer,
+                                        &DropTailQueue<Item>::IsRingBuffer),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -99,7 +110,7 @@ DropTailQueue<Item>::Enqueue (Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  return DoEnqueue (Tail (), item);
+  return DoEnqueue (item);
 }
 
 template <typename Item>
@@ -108,7 +119,7 @@ DropTailQueue<Item>::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoDequeue (Head ());
+  Ptr<Item> item = DoDequeue ();
 
   NS_LOG_LOGIC ("Popped " << item);
 
@@ -121,7 +132,7 @@ DropTailQueue<Item>::Remove (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoRemove (Head ());
+  Ptr<Item> item = DoRemove ();
 
   NS_LOG_LOGIC ("Removed " << item);
 
@@ -134,7 +145,7 @@ DropTailQueue<Item>::Peek (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  return DoPeek (Head ());
+  return DoPeek ();
 }
 
 } // namespace ns3
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef GSO_TAG_H
+#define GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Marks a super-segment, i.e., a packet carrying the payload of
+ * several wire-size segments of a transport protocol.
+ *
+ * A super-segment crosses the stack as a single packet.  It is split into
+ * segments of SegmentSize bytes of payload, each one carrying a copy of
+ * the HeaderSize bytes of headers of the super-segment, either by the
+ * network layer before a device which does not support segmentation
+ * offload, or virtually by a device which does, which accounts for the
+ * transmission time of all the segments.
+ */
+class GsoTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  GsoTag ();
+
+  /**
+   * Constructs a GsoTag with the given segment size
+   *
+   * \param segmentSize the payload size of the segments
+   */
+  GsoTag (uint16_t segmentSize);
+  /**
+   * \param segmentSize the payload size of the segments
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * \returns the payload size of the segments
+   */
+  uint16_t GetSegmentSize (void) const;
+  /**
+   * \param headerSize the size of the headers repeated in each segment
+   */
+  void SetHeaderSize (uint16_t headerSize);
+  /**
+   * \returns the size of the headers repeated in each segment
+   */
+  uint16_t GetHeaderSize (void) const;
+  /**
+   * \param size the size of the super-segment, headers included
+   * \returns the number of segments of the super-segment
+   */
+  uint32_t GetNSegments (uint32_t size) const;
+private:
+  uint16_t m_segmentSize; //!< payload size of the segments
+  uint16_t m_headerSize;  //!< size of the headers repeated in each segment
+};
+
+} // namespace ns3
+
+#endif /* GSO_TAG_H */
@@ -29,10 +29,13 @@
 #include "ns3/traced-value.h"
 #include "ns3/unused.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/queue-size.h"
 #include <string>
 #include <sstream>
 #include <list>
+#include <vector>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -234,6 +237,13 @@ private:
  * GetSize () method (e.g., Packet, QueueDiscItem, etc.). Subclasses need to
  * implement the DoEnqueue, DoDequeue, DoRemove and DoPeek methods.
  *
+ * The items are stored in a list, so that subclasses can insert and remove
+ * them at any position. Subclasses which only enqueue at the tail and dequeue
+ * at the head (e.g., DropTailQueue) can instead store them in a contiguous ring
+ * buffer (see SetRingBuffer), which does not allocate memory for every item:
+ * the ring buffer doubles its capacity when it is full, up to the maximum size
+ * of the queue if the latter is expressed in packets.
+ *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
  * of the templates included in this file. Thus, do not include queue.h but add
@@ -286,6 +296,15 @@ public:
    */
   virtual Ptr<const Item> Peek (void) const = 0;
 
+  /**
+   * Remove up to n items from the Queue by calling Dequeue, counting them
+   * as dequeued
+   * \param n the maximum number of items to dequeue
+   * \param items the vector to which the dequeued items are appended
+   * \return the number of dequeued items
+   */
+  uint32_t DequeueBatch (uint32_t n, std::vector<Ptr<Item> > &items);
+
   /**
    * Flush the queue.
    */
@@ -293,6 +312,22 @@ public:
 
 protected:
 
+  /**
+   * \brief Choose whether the items are stored in a ring buffer or in a list.
+   *
+   * The queue must be empty. When the ring buffer is used, only the methods
+   * without a position (enqueue at the tail, dequeue, remove and peek at the
+   * head) can be called.
+   *
+   * \param ringBuffer true to store the items in a ring buffer
+   */
+  void SetRingBuffer (bool ringBuffer);
+
+  /**
+   * \return true if the items are stored in a ring buffer
+   */
+  bool IsRingBuffer (void) const;
+
   /// Const iterator.
   typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
 
@@ -357,6 +392,31 @@ protected:
    */
   Ptr<const Item> DoPeek (ConstIterator pos) const;
 
+  /**
+   * Push an item at the tail of the queue
+   * \param item the item to enqueue
+   * \return true if success, false if the packet has been dropped.
+   */
+  bool DoEnqueue (Ptr<Item> item);
+
+  /**
+   * Pull the item at the head of the queue to dequeue it
+   * \return the item.
+   */
+  Ptr<Item> DoDequeue (void);
+
+  /**
+   * Pull the item at the head of the queue to drop it
+   * \return the item.
+   */
+  Ptr<Item> DoRemove (void);
+
+  /**
+   * Peek the item at the head of the queue
+   * \return the item.
+   */
+  Ptr<const Item> DoPeek (void) const;
+
   /**
    * \brief Drop a packet before enqueue
    * \param item item that was dropped
@@ -378,7 +438,28 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  /**
+   * Update the statistics and fire the trace of an item which was just enqueued
+   * \param item the enqueued item
+   */
+  void Enqueued (Ptr<Item> item);
+
+  /**
+   * Update the statistics and fire the trace of an item which was just dequeued
+   * \param item the dequeued item
+   */
+  void Dequeued (Ptr<Item> item);
+
+  /**
+   * Double the capacity of the ring buffer, without exceeding the maximum
+   * size of the queue if it is expressed in packets
+   */
+  void GrowRingBuffer (void);
+
+  std::list<Ptr<Item> > m_packets;          //!< the items in the queue, if no ring buffer is used
+  std::vector<Ptr<Item> > m_ring;           //!< the ring buffer storing the items, if used
+  uint32_t m_ringHead;                      //!< the index of the first item in the ring buffer
+  bool m_ringBuffer;                        //!< true if the items are stored in the ring buffer
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -427,7 +508,9 @@ Queue<Item>::GetTypeId (void)
 
 template <typename Item>
 Queue<Item>::Queue ()
-  : NS_LOG_TEMPLATE_DEFINE ("Queue")
+  : m_ringHead (0),
+    m_ringBuffer (false),
+    NS_LOG_TEMPLATE_DEFINE ("Queue")
 {
 }
 
@@ -441,6 +524,7 @@ bool
 Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
+  NS_ASSERT_MSG (!m_ringBuffer, "A queue using a ring buffer can only enqueue at the tail");
 
   if (GetCurrentSize () + item > GetMaxSize ())
     {
@@ -450,7 +534,49 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
     }
 
   m_packets.insert (pos, item);
+  Enqueued (item);
 
+  return true;
+}
+
+template <typename Item>
+bool
+Queue<Item>::DoEnqueue (Ptr<Item> item)
+{
+  if (!m_ringBuffer)
+    {
+      return DoEnqueue (m_packets.cend (), item);
+    }
+
+  NS_LOG_FUNCTION (this << item);
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
+    }
+
+  uint32_t nPackets = m_nPackets.Get ();
+  if (nPackets == m_ring.size ())
+    {
+      GrowRingBuffer ();
+    }
+  uint32_t index = m_ringHead + nPackets;
+  if (index >= m_ring.size ())
+    {
+      index -= m_ring.size ();
+    }
+  m_ring[index] = item;
+  Enqueued (item);
+
+  return true;
+}
+
+template <typename Item>
+void
+Queue<Item>::Enqueued (Ptr<Item> item)
+{
   uint32_t size = item->GetSize ();
   m_nBytes += size;
   m_nTotalReceivedBytes += size;
@@ -460,8 +586,28 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
+}
 
-  return true;
+template <typename Item>
+void
+Queue<Item>::GrowRingBuffer (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the ring buffer is full: its items are moved to the beginning, in order,
+  // before the new slots are appended
+  std::rotate (m_ring.begin (), m_ring.begin () + m_ringHead, m_ring.end ());
+  m_ringHead = 0;
+
+  uint32_t capacity = m_ring.empty () ? 16 : 2 * m_ring.size ();
+  QueueSize maxSize = GetMaxSize ();
+  if (maxSize.GetUnit () == QueueSizeUnit::PACKETS)
+    {
+      capacity = std::min (capacity, maxSize.GetValue ());
+    }
+  capacity = std::max<uint32_t> (capacity, m_ring.size () + 1);
+  NS_LOG_LOGIC ("Ring buffer capacity " << m_ring.size () << " -> " << capacity);
+  m_ring.resize (capacity);
 }
 
 template <typename Item>
@@ -469,6 +615,7 @@ Ptr<Item>
 Queue<Item>::DoDequeue (ConstIterator pos)
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_ringBuffer, "A queue using a ring buffer can only dequeue at the head");
 
   if (m_nPackets.Get () == 0)
     {
@@ -481,23 +628,62 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
+      Dequeued (item);
+    }
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoDequeue (void)
+{
+  if (!m_ringBuffer)
+    {
+      return DoDequeue (m_packets.cbegin ());
+    }
 
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
+  NS_LOG_FUNCTION (this);
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_ring[m_ringHead];
+  m_ring[m_ringHead] = 0;
+  if (++m_ringHead == m_ring.size ())
+    {
+      m_ringHead = 0;
+    }
 
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+  if (item != 0)
+    {
+      Dequeued (item);
     }
   return item;
 }
 
+template <typename Item>
+void
+Queue<Item>::Dequeued (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
 template <typename Item>
 Ptr<Item>
 Queue<Item>::DoRemove (ConstIterator pos)
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_ringBuffer, "A queue using a ring buffer can only remove at the head");
 
   if (m_nPackets.Get () == 0)
     {
@@ -510,21 +696,67 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
       // packets are first dequeued and then dropped
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      Dequeued (item);
+      DropAfterDequeue (item);
+    }
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoRemove (void)
+{
+  NS_LOG_FUNCTION (this);
 
+  // packets are first dequeued and then dropped
+  Ptr<Item> item = DoDequeue ();
+  if (item != 0)
+    {
       DropAfterDequeue (item);
     }
   return item;
 }
 
+template <typename Item>
+uint32_t
+Queue<Item>::DequeueBatch (uint32_t n, std::vector<Ptr<Item> > &items)
+{
+  NS_LOG_FUNCTION (this << n);
+
+  uint32_t count = 0;
+  while (count < n)
+    {
+      Ptr<Item> item = Dequeue ();
+      if (item == 0)
+        {
+          break;
+        }
+      items.push_back (item);
+      count++;
+    }
+  return count;
+}
+
+template <typename Item>
+void
+Queue<Item>::SetRingBuffer (bool ringBuffer)
+{
+  NS_LOG_FUNCTION (this << ringBuffer);
+  NS_ABORT_MSG_UNLESS (IsEmpty (), "The storage of a queue can only be changed when it is empty");
+
+  m_ringBuffer = ringBuffer;
+  m_ring.clear ();
+  m_ringHead = 0;
+}
+
+template <typename Item>
+bool
+Queue<Item>::IsRingBuffer (void) const
+{
+  return m_ringBuffer;
+}
+
 template <typename Item>
 void
 Queue<Item>::Flush (void)
@@ -541,6 +773,7 @@ Ptr<const Item>
 Queue<Item>::DoPeek (ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_ringBuffer, "A queue using a ring buffer can only peek at the head");
 
   if (m_nPackets.Get () == 0)
     {
@@ -551,15 +784,37 @@ Queue<Item>::DoPeek (ConstIterator pos) const
   return *pos;
 }
 
+template <typename Item>
+Ptr<const Item>
+Queue<Item>::DoPeek (void) const
+{
+  if (!m_ringBuffer)
+    {
+      return DoPeek (m_packets.cbegin ());
+    }
+
+  NS_LOG_FUNCTION (this);
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_ring[m_ringHead];
+}
+
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Head (void) const
 {
+  NS_ASSERT_MSG (!m_ringBuffer, "The items of a queue using a ring buffer cannot be browsed");
   return m_packets.cbegin ();
 }
 
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Tail (void) const
 {
+  NS_ASSERT_MSG (!m_ringBuffer, "The items of a queue using a ring buffer cannot be browsed");
   return m_packets.cend ();
 }
 
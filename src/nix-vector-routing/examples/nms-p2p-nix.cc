@@ -157,11 +157,13 @@ main (int argc, char *argv[])
 
   int nCN = 2, nLANClients = 42;
   bool nix = true;
+  uint32_t precompute = 0;
 
   CommandLine cmd;
   cmd.AddValue ("CN", "Number of total CNs [2]", nCN);
   cmd.AddValue ("LAN", "Number of nodes per LAN [42]", nLANClients);
   cmd.AddValue ("NIX", "Toggle nix-vector routing", nix);
+  cmd.AddValue ("precompute", "Number of threads precomputing the nix-vectors [0: on demand]", precompute);
   cmd.Parse (argc,argv);
 
   if (nCN < 2) 
@@ -528,6 +530,10 @@ main (int argc, char *argv[])
     {
       // Calculate routing tables
       std::cout << "Using Nix-vectors..." << std::endl;
+      if (precompute > 0)
+        {
+          Ipv4NixVectorHelper::PrecomputeNixVectors (precompute);
+        }
     }
   else
     {
@@ -20,6 +20,8 @@
 
 #include "ipv4-nix-vector-helper.h"
 #include "ns3/ipv4-nix-vector-routing.h"
+#include "ns3/ipv4-nix-vector-store.h"
+#include "ns3/simulation-singleton.h"
 
 namespace ns3 {
 
@@ -47,4 +49,11 @@ Ipv4NixVectorHelper::Create (Ptr<Node> node) const
   node->AggregateObject (agent);
   return agent;
 }
+
+void
+Ipv4NixVectorHelper::PrecomputeNixVectors (uint32_t nThreads, uint32_t maxTrees)
+{
+  SimulationSingleton<Ipv4NixVectorStore>::Get ()->Precompute (nThreads, maxTrees);
+}
+
 } // namespace ns3
@@ -66,6 +66,23 @@ public:
   */
   virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
+  /**
+   * \brief Compute the paths of the nodes in advance, and keep them in a
+   * store shared by all the nodes instead of their caches.
+   *
+   * The paths are computed once per source node, as a tree of 4 bytes
+   * per node, and updated when the topology changes.  The trees of the
+   * first maxTrees nodes are computed by the given number of threads; the
+   * other ones are computed when needed, the tree used least recently
+   * being dropped to keep at most maxTrees of them.  This should be
+   * called after the addresses have been assigned.
+   *
+   * \param nThreads the number of threads computing the paths
+   * \param maxTrees the maximum number of trees kept, or 0 to keep the
+   * trees of all the nodes
+   */
+  static void PrecomputeNixVectors (uint32_t nThreads = 1, uint32_t maxTrees = 1024);
+
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
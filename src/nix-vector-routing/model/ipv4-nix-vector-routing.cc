@@ -26,7 +26,10 @@
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
 
+#include "ns3/simulation-singleton.h"
+
 #include "ipv4-nix-vector-routing.h"
+#include "ipv4-nix-vector-store.h"
 
 namespace ns3 {
 
@@ -105,6 +108,11 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
       rp->FlushNixCache ();
       rp->FlushIpv4RouteCache ();
     }
+  Ipv4NixVectorStore *store = SimulationSingleton<Ipv4NixVectorStore>::Get ();
+  if (store->IsEnabled ())
+    {
+      store->Update ();
+    }
 }
 
 void
@@ -402,7 +410,7 @@ Ipv4NixVectorRouting::FindTotalNeighbors (void)
 }
 
 Ptr<BridgeNetDevice>
-Ipv4NixVectorRouting::NetDeviceIsBridged (Ptr<NetDevice> nd) const
+Ipv4NixVectorRouting::NetDeviceIsBridged (Ptr<NetDevice> nd)
 {
   NS_LOG_FUNCTION (nd);
 
@@ -498,19 +506,28 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
   CheckCacheStateAndFlush ();
 
   NS_LOG_DEBUG ("Dest IP from header: " << header.GetDestination ());
-  // check if cache
-  nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
-
-  // not in cache
-  if (!nixVectorInCache)
+  Ipv4NixVectorStore *store = SimulationSingleton<Ipv4NixVectorStore>::Get ();
+  if (store->IsEnabled () && !oif)
     {
-      NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
-      // Build the nix-vector, given this node and the
-      // dest IP address
-      nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
+      // the paths of all the nodes are kept in the shared store
+      nixVectorInCache = store->GetNixVector (m_node, header.GetDestination ());
+    }
+  else
+    {
+      // check if cache
+      nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
 
-      // cache it
-      m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+      // not in cache
+      if (!nixVectorInCache)
+        {
+          NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
+          // Build the nix-vector, given this node and the
+          // dest IP address
+          nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
+
+          // cache it
+          m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+        }
     }
 
   // path exists
@@ -89,6 +89,7 @@ public:
   void FlushGlobalNixRoutingCache (void) const;
 
 private:
+  friend class Ipv4NixVectorStore;
 
   /**
    * Flushes the cache which stores nix-vector based on
@@ -142,7 +143,7 @@ private:
    * \param [in] channel the channel to check
    * \param [out] netDeviceContainer the NetDeviceContainer of the NetDevices in the channel.
    */
-  void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
+  static void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
 
   /**
    * Iterates through the node list and finds the one
@@ -181,7 +182,7 @@ private:
    * \param nd the NetDevice to check
    * \returns the bridging NetDevice (or null if the NetDevice is not bridged)
    */
-  Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd) const;
+  static Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd);
 
 
   /**
@@ -0,0 +1,364 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <thread>
+#endif /* HAVE_PTHREAD_H */
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/ipv4.h"
+
+#include "ipv4-nix-vector-routing.h"
+#include "ipv4-nix-vector-store.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorStore");
+
+/// The parent of the nodes which the search does not reach.
+static const uint32_t NO_PARENT = 0xffffffff;
+
+Ipv4NixVectorStore::Ipv4NixVectorStore ()
+  : m_enabled (false),
+    m_uses (0),
+    m_nTrees (0),
+    m_maxTrees (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4NixVectorStore::~Ipv4NixVectorStore ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+Ipv4NixVectorStore::IsEnabled (void) const
+{
+  return m_enabled;
+}
+
+uint32_t
+Ipv4NixVectorStore::GetNTrees (void) const
+{
+  return m_nTrees;
+}
+
+void
+Ipv4NixVectorStore::BuildGraph (Graph &graph)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t nNodes = NodeList::GetNNodes ();
+  graph.m_neighbours.clear ();
+  graph.m_start.clear ();
+  graph.m_nixIndexes.clear ();
+  graph.m_nixStart.clear ();
+  graph.m_nixNeighbours.clear ();
+  graph.m_addresses.clear ();
+  for (uint32_t id = 0; id < nNodes; id++)
+    {
+      Ptr<Node> node = NodeList::GetNode (id);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+      // the neighbours that Ipv4NixVectorRouting::BFS explores, in the
+      // same order
+      graph.m_start.push_back (graph.m_neighbours.size ());
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          if (ipv4)
+            {
+              int32_t interfaceIndex = ipv4->GetInterfaceForDevice (localNetDevice);
+              if (interfaceIndex < 0 || !ipv4->IsUp (interfaceIndex))
+                {
+                  continue;
+                }
+            }
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (!localNetDevice->IsLinkUp () || channel == 0)
+            {
+              continue;
+            }
+          NetDeviceContainer netDeviceContainer;
+          Ipv4NixVectorRouting::GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+            {
+              graph.m_neighbours.push_back ((*iter)->GetNode ()->GetId ());
+            }
+        }
+
+      // the neighbour indexes of Ipv4NixVectorRouting::BuildNixVector: the
+      // last index of a neighbour reached through several devices is used
+      std::map<uint32_t, uint32_t> indexes;
+      uint32_t totalNeighbors = 0;
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (localNetDevice->IsBridge () || channel == 0)
+            {
+              continue;
+            }
+          NetDeviceContainer netDeviceContainer;
+          Ipv4NixVectorRouting::GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+          for (uint32_t j = 0; j < netDeviceContainer.GetN (); j++)
+            {
+              indexes[netDeviceContainer.Get (j)->GetNode ()->GetId ()] = totalNeighbors + j;
+            }
+          totalNeighbors += netDeviceContainer.GetN ();
+        }
+      graph.m_nixStart.push_back (graph.m_nixIndexes.size ());
+      graph.m_nixIndexes.insert (graph.m_nixIndexes.end (), indexes.begin (), indexes.end ());
+      graph.m_nixNeighbours.push_back (totalNeighbors);
+
+      // the first node with an address is its destination, as in
+      // Ipv4NixVectorRouting::GetNodeByIp
+      if (ipv4)
+        {
+          for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+            {
+              for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+                {
+                  graph.m_addresses.insert (std::make_pair (ipv4->GetAddress (i, j).GetLocal (), id));
+                }
+            }
+        }
+    }
+  graph.m_start.push_back (graph.m_neighbours.size ());
+  graph.m_nixStart.push_back (graph.m_nixIndexes.size ());
+}
+
+void
+Ipv4NixVectorStore::ComputeTree (uint32_t source)
+{
+  uint32_t nNodes = m_graph.m_start.size () - 1;
+  std::vector<uint32_t> &tree = m_trees[source];
+  tree.assign (nNodes, NO_PARENT);
+  std::vector<uint32_t> queue;
+  queue.reserve (nNodes);
+  queue.push_back (source);
+  tree[source] = source;
+  for (uint32_t k = 0; k < queue.size (); k++)
+    {
+      uint32_t node = queue[k];
+      for (uint32_t j = m_graph.m_start[node]; j < m_graph.m_start[node + 1]; j++)
+        {
+          uint32_t neighbour = m_graph.m_neighbours[j];
+          if (tree[neighbour] == NO_PARENT)
+            {
+              tree[neighbour] = node;
+              queue.push_back (neighbour);
+            }
+        }
+    }
+}
+
+void
+Ipv4NixVectorStore::ComputeTrees (const std::vector<uint32_t> *sources, std::atomic<uint32_t> *next)
+{
+  for (uint32_t i = (*next)++; i < sources->size (); i = (*next)++)
+    {
+      ComputeTree ((*sources)[i]);
+    }
+}
+
+void
+Ipv4NixVectorStore::Evict (void)
+{
+  if (m_maxTrees == 0 || m_nTrees < m_maxTrees)
+    {
+      return;
+    }
+  uint32_t oldest = m_trees.size ();
+  for (uint32_t source = 0; source < m_trees.size (); source++)
+    {
+      if (!m_trees[source].empty ()
+          && (oldest == m_trees.size () || m_lastUse[source] < m_lastUse[oldest]))
+        {
+          oldest = source;
+        }
+    }
+  NS_ASSERT (oldest < m_trees.size ());
+  NS_LOG_LOGIC ("Dropping the paths of node " << oldest << ", used least recently");
+  std::vector<uint32_t> ().swap (m_trees[oldest]);
+  m_nTrees--;
+}
+
+void
+Ipv4NixVectorStore::Precompute (uint32_t nThreads, uint32_t maxTrees)
+{
+  NS_LOG_FUNCTION (this << nThreads << maxTrees);
+  m_enabled = true;
+  m_maxTrees = maxTrees;
+  BuildGraph (m_graph);
+  uint32_t nNodes = m_graph.m_start.size () - 1;
+  m_trees.assign (nNodes, std::vector<uint32_t> ());
+  m_lastUse.assign (nNodes, 0);
+  m_uses = 0;
+  std::vector<uint32_t> sources;
+  for (uint32_t source = 0; source < nNodes && (maxTrees == 0 || source < maxTrees); source++)
+    {
+      sources.push_back (source);
+    }
+  m_nTrees = sources.size ();
+  std::atomic<uint32_t> next (0);
+#ifdef HAVE_PTHREAD_H
+  nThreads = std::min (nThreads, m_nTrees);
+  if (nThreads > 1)
+    {
+      std::vector<std::thread> threads;
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads.push_back (std::thread (&Ipv4NixVectorStore::ComputeTrees, this, &sources, &next));
+        }
+      for (uint32_t t = 0; t < nThreads; t++)
+        {
+          threads[t].join ();
+        }
+    }
+#else /* HAVE_PTHREAD_H */
+  nThreads = 1;
+#endif /* HAVE_PTHREAD_H */
+  ComputeTrees (&sources, &next);
+  NS_LOG_INFO ("Computed the paths of " << m_nTrees << " nodes in " << std::max (nThreads, 1u) << " threads");
+}
+
+bool
+Ipv4NixVectorStore::IsAffected (const std::vector<uint32_t> &tree, uint32_t node,
+                                const std::vector<uint32_t> &oldNeighbours,
+                                const std::vector<uint32_t> &newNeighbours)
+{
+  // the search does not reach the node, nor its new neighbours
+  if (tree[node] == NO_PARENT)
+    {
+      return false;
+    }
+  // when the neighbours were only removed, the search still finds the
+  // other nodes in the same order, unless it went through the removed ones
+  std::set<uint32_t> kept (newNeighbours.begin (), newNeighbours.end ());
+  std::vector<uint32_t> filtered;
+  for (uint32_t j = 0; j < oldNeighbours.size (); j++)
+    {
+      if (kept.count (oldNeighbours[j]))
+        {
+          filtered.push_back (oldNeighbours[j]);
+        }
+      else if (tree[oldNeighbours[j]] == node)
+        {
+          return true;
+        }
+    }
+  return filtered != newNeighbours;
+}
+
+void
+Ipv4NixVectorStore::Update (void)
+{
+  NS_LOG_FUNCTION (this);
+  Graph graph;
+  BuildGraph (graph);
+  if (graph.m_start.size () != m_graph.m_start.size ())
+    {
+      NS_LOG_LOGIC ("The number of nodes changed, dropping all the paths");
+      m_trees.assign (graph.m_start.size () - 1, std::vector<uint32_t> ());
+      m_lastUse.assign (graph.m_start.size () - 1, 0);
+      m_nTrees = 0;
+    }
+  else
+    {
+      for (uint32_t node = 0; node + 1 < graph.m_start.size (); node++)
+        {
+          std::vector<uint32_t> oldNeighbours (m_graph.m_neighbours.begin () + m_graph.m_start[node],
+                                               m_graph.m_neighbours.begin () + m_graph.m_start[node + 1]);
+          std::vector<uint32_t> newNeighbours (graph.m_neighbours.begin () + graph.m_start[node],
+                                               graph.m_neighbours.begin () + graph.m_start[node + 1]);
+          if (oldNeighbours == newNeighbours)
+            {
+              continue;
+            }
+          NS_LOG_LOGIC ("The neighbours of node " << node << " changed");
+          for (uint32_t source = 0; source < m_trees.size (); source++)
+            {
+              if (!m_trees[source].empty () && IsAffected (m_trees[source], node, oldNeighbours, newNeighbours))
+                {
+                  NS_LOG_LOGIC ("Dropping the paths of node " << source);
+                  std::vector<uint32_t> ().swap (m_trees[source]);
+                  m_nTrees--;
+                }
+            }
+        }
+    }
+  std::swap (m_graph, graph);
+}
+
+Ptr<NixVector>
+Ipv4NixVectorStore::GetNixVector (Ptr<Node> source, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << source << dest);
+  if (m_trees.size () != NodeList::GetNNodes ())
+    {
+      Update ();
+    }
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_graph.m_addresses.find (dest);
+  if (i == m_graph.m_addresses.end ())
+    {
+      NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
+      return 0;
+    }
+  uint32_t destId = i->second;
+  uint32_t sourceId = source->GetId ();
+  if (sourceId == destId)
+    {
+      NS_LOG_DEBUG ("Do not process packets to self");
+      return 0;
+    }
+  if (m_trees[sourceId].empty ())
+    {
+      NS_LOG_LOGIC ("Computing the paths of node " << sourceId);
+      Evict ();
+      ComputeTree (sourceId);
+      m_nTrees++;
+    }
+  m_lastUse[sourceId] = ++m_uses;
+  const std::vector<uint32_t> &tree = m_trees[sourceId];
+  if (tree[destId] == NO_PARENT)
+    {
+      NS_LOG_ERROR ("No routing path exists");
+      return 0;
+    }
+
+  // the hops are added from the destination, as in
+  // Ipv4NixVectorRouting::BuildNixVector
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  for (uint32_t node = destId; node != sourceId; node = tree[node])
+    {
+      uint32_t parent = tree[node];
+      std::vector<std::pair<uint32_t, uint32_t> >::const_iterator begin = m_graph.m_nixIndexes.begin () + m_graph.m_nixStart[parent];
+      std::vector<std::pair<uint32_t, uint32_t> >::const_iterator end = m_graph.m_nixIndexes.begin () + m_graph.m_nixStart[parent + 1];
+      std::vector<std::pair<uint32_t, uint32_t> >::const_iterator index = std::lower_bound (begin, end, std::make_pair (node, 0u));
+      uint32_t nixIndex = (index != end && index->first == node) ? index->second : 0;
+      nixVector->AddNeighborIndex (nixIndex, nixVector->BitCount (m_graph.m_nixNeighbours[parent]));
+    }
+  return nixVector;
+}
+
+} // namespace ns3
@@ -10,6 +10,7 @@
 cpp_examples = [
     ("nix-simple", "True", "True"),
     ("nms-p2p-nix", "False", "True"), # Takes too long to run
+    ("nms-p2p-nix --LAN=1 --precompute=2", "True", "False"),
 ]
 
 # A list of Python examples to run in order to ensure that they remain
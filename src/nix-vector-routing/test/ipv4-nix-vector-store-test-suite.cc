@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-store.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \defgroup nix-vector-routing-test Nix-vector routing tests
+ */
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Compare the paths of the Ipv4NixVectorStore with the ones built
+ * on demand by Ipv4NixVectorRouting, before and after topology changes.
+ *
+ * The routers 0 to 7 form a ring, with a chord from 0 to 4.  A shared
+ * channel joins the routers 2 and 6 and the hosts 8 and 9, and the
+ * nodes 10 and 11 are only linked to each other.  The nix-vectors of
+ * all the pairs of nodes are first built on demand, with the chord and
+ * then the ring link from 1 to 2 brought down, and up again.  The same
+ * changes are then repeated with the store enabled, which must give the
+ * same nix-vectors, while keeping the trees that the changes do not
+ * affect.
+ */
+class Ipv4NixVectorStoreTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param nThreads the number of threads precomputing the trees
+   * \param maxTrees the maximum number of trees kept by the store
+   */
+  Ipv4NixVectorStoreTestCase (uint32_t nThreads, uint32_t maxTrees);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \param nThreads the number of threads precomputing the trees
+   * \param maxTrees the maximum number of trees kept by the store
+   * \returns the name of the test case
+   */
+  static std::string BuildNameString (uint32_t nThreads, uint32_t maxTrees);
+
+  /**
+   * \returns the output interface and the nix-vector from each node to
+   * each other node, or "none" if there is no route
+   */
+  std::string GetPaths (void);
+
+  /**
+   * \brief Bring an interface down or up.
+   * \param node the node
+   * \param interface the interface of the node
+   * \param up true to bring the interface up
+   */
+  void SetUp (uint32_t node, uint32_t interface, bool up);
+
+  /**
+   * \brief Check the paths with the store enabled.
+   * \param expected the paths built on demand
+   * \param step a description of the topology
+   */
+  void CheckPaths (const std::string &expected, const std::string &step);
+
+  uint32_t m_nThreads; //!< the number of threads precomputing the trees
+  uint32_t m_maxTrees; //!< the maximum number of trees kept by the store
+  NodeContainer m_nodes; //!< the nodes
+};
+
+Ipv4NixVectorStoreTestCase::Ipv4NixVectorStoreTestCase (uint32_t nThreads, uint32_t maxTrees)
+  : TestCase (BuildNameString (nThreads, maxTrees)),
+    m_nThreads (nThreads),
+    m_maxTrees (maxTrees)
+{
+}
+
+std::string
+Ipv4NixVectorStoreTestCase::BuildNameString (uint32_t nThreads, uint32_t maxTrees)
+{
+  std::ostringstream oss;
+  oss << "Nix-vector store with " << nThreads << " threads and at most " << maxTrees << " trees";
+  return oss.str ();
+}
+
+std::string
+Ipv4NixVectorStoreTestCase::GetPaths (void)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4RoutingProtocol> routing = m_nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < m_nodes.GetN (); j++)
+        {
+          if (i == j)
+            {
+              continue;
+            }
+          Ipv4Header header;
+          header.SetDestination (m_nodes.Get (j)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+          Ptr<Packet> packet = Create<Packet> ();
+          Socket::SocketErrno error;
+          Ptr<Ipv4Route> route = routing->RouteOutput (packet, header, 0, error);
+          oss << i << " " << j << " ";
+          if (route)
+            {
+              oss << route->GetOutputDevice ()->GetIfIndex () << " " << *packet->GetNixVector ();
+            }
+          else
+            {
+              oss << "none";
+            }
+          oss << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+void
+Ipv4NixVectorStoreTestCase::SetUp (uint32_t node, uint32_t interface, bool up)
+{
+  Ptr<Ipv4> ipv4 = m_nodes.Get (node)->GetObject<Ipv4> ();
+  if (up)
+    {
+      ipv4->SetUp (interface);
+    }
+  else
+    {
+      ipv4->SetDown (interface);
+    }
+}
+
+void
+Ipv4NixVectorStoreTestCase::CheckPaths (const std::string &expected, const std::string &step)
+{
+  NS_TEST_EXPECT_MSG_EQ (GetPaths (), expected, "the store gives other paths, " << step);
+  if (m_maxTrees > 0)
+    {
+      uint32_t nTrees = SimulationSingleton<Ipv4NixVectorStore>::Get ()->GetNTrees ();
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (nTrees, m_maxTrees, "too many trees, " << step);
+    }
+}
+
+void
+Ipv4NixVectorStoreTestCase::DoRun (void)
+{
+  m_nodes.Create (12);
+  Ipv4NixVectorHelper nixRouting;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (nixRouting);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  // the interface 1 of each node is on the first link of the node, which
+  // gives the destination address of the node
+  uint32_t links[][2] = { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 }, { 5, 6 },
+                          { 6, 7 }, { 7, 0 }, { 0, 4 }, { 10, 11 } };
+  for (uint32_t k = 0; k < 10; k++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices = simpleHelper.Install (m_nodes.Get (links[k][0]), channel);
+      devices.Add (simpleHelper.Install (m_nodes.Get (links[k][1]), channel));
+      ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+    }
+  Ptr<SimpleChannel> lan = CreateObject<SimpleChannel> ();
+  NetDeviceContainer lanDevices;
+  uint32_t lanNodes[] = { 8, 2, 6, 9 };
+  for (uint32_t k = 0; k < 4; k++)
+    {
+      lanDevices.Add (simpleHelper.Install (m_nodes.Get (lanNodes[k]), lan));
+    }
+  ipv4.Assign (lanDevices);
+
+  // the chord is the interface 3 of node 0, the ring link from 1 to 2 the
+  // interface 2 of node 1
+  std::vector<std::string> expected;
+  expected.push_back (GetPaths ());
+  SetUp (0, 3, false);
+  expected.push_back (GetPaths ());
+  SetUp (1, 2, false);
+  expected.push_back (GetPaths ());
+  SetUp (0, 3, true);
+  SetUp (1, 2, true);
+  expected.push_back (GetPaths ());
+  NS_TEST_ASSERT_MSG_NE (expected[0], expected[1], "bringing the chord down does not change the paths");
+  NS_TEST_ASSERT_MSG_NE (expected[1], expected[2], "bringing the ring link down does not change the paths");
+
+  Ipv4NixVectorHelper::PrecomputeNixVectors (m_nThreads, m_maxTrees);
+  Ipv4NixVectorStore *store = SimulationSingleton<Ipv4NixVectorStore>::Get ();
+  uint32_t nTrees = m_maxTrees > 0 ? m_maxTrees : m_nodes.GetN ();
+  NS_TEST_EXPECT_MSG_EQ (store->GetNTrees (), nTrees, "the trees were not all precomputed");
+  CheckPaths (expected[0], "initial topology");
+
+  // the trees which do not go through the chord are kept: the tree of
+  // node 0 is computed again to send the packet
+  SetUp (0, 3, false);
+  Ptr<Packet> packet = Create<Packet> ();
+  Ipv4Header header;
+  header.SetDestination (m_nodes.Get (4)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+  Socket::SocketErrno error;
+  m_nodes.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (packet, header, 0, error);
+  if (m_maxTrees == 0)
+    {
+      NS_TEST_EXPECT_MSG_GT (store->GetNTrees (), 1, "all the trees were dropped");
+      NS_TEST_EXPECT_MSG_LT (store->GetNTrees (), m_nodes.GetN (), "no tree was dropped");
+    }
+  CheckPaths (expected[1], "chord down");
+  SetUp (1, 2, false);
+  CheckPaths (expected[2], "chord and ring link down");
+  SetUp (0, 3, true);
+  SetUp (1, 2, true);
+  CheckPaths (expected[3], "chord and ring link up again");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Ipv4NixVectorStore TestSuite
+ */
+class Ipv4NixVectorStoreTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorStoreTestSuite ();
+};
+
+Ipv4NixVectorStoreTestSuite::Ipv4NixVectorStoreTestSuite ()
+  : TestSuite ("ipv4-nix-vector-store", UNIT)
+{
+  AddTestCase (new Ipv4NixVectorStoreTestCase (1, 0), TestCase::QUICK);
+  AddTestCase (new Ipv4NixVectorStoreTestCase (2, 0), TestCase::QUICK);
+  AddTestCase (new Ipv4NixVectorStoreTestCase (1, 3), TestCase::QUICK);
+}
+
+static Ipv4NixVectorStoreTestSuite g_ipv4NixVectorStoreTestSuite; //!< Static variable for test initialization
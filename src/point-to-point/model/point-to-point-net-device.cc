@@ -24,6 +24,8 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/gso-tag.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
@@ -68,6 +70,13 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("SegmentationOffload",
+                   "Whether the device accepts the super-segments built by the "
+                   "transport protocols, and splits them into frames itself "
+                   "(see GsoTag), instead of having them split by the network layer",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_segmentationOffload),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -286,6 +295,18 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
+  GsoTag gsoTag;
+  if (m_segmentationOffload && p->PeekPacketTag (gsoTag))
+    {
+      // A super-segment is sent as a burst of frames, each one carrying
+      // a copy of the headers and of the PPP header
+      uint32_t pppSize = PppHeader ().GetSerializedSize ();
+      uint32_t nFrames = gsoTag.GetNSegments (p->GetSize () - pppSize);
+      uint32_t wireSize = p->GetSize () + (nFrames - 1) * (gsoTag.GetHeaderSize () + pppSize);
+      NS_LOG_LOGIC ("Super-segment of " << nFrames << " frames, " << wireSize << " bytes on the wire");
+      txTime = m_bps.CalculateBytesTxTime (wireSize) + (nFrames - 1) * m_tInterframeGap;
+      txCompleteTime = txTime + m_tInterframeGap;
+    }
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
   Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
@@ -311,6 +311,12 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * True if the device transmits the super-segments (see GsoTag) as they
+   * are, accounting for the transmission time of all their segments
+   */
+  bool           m_segmentationOffload;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "caching-propagation-loss-model.h"
+#include <ns3/log.h>
+#include <ns3/pointer.h>
+#include <ns3/mobility-model.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CachingPropagationLossModel");
+
+NS_OBJECT_ENSURE_REGISTERED (CachingPropagationLossModel);
+
+/**
+ * \param mobility a mobility model.
+ * \return true if the mobility model has a non-zero velocity.
+ */
+static bool
+IsMoving (Ptr<const MobilityModel> mobility)
+{
+  Vector velocity = mobility->GetVelocity ();
+  return velocity.x != 0 || velocity.y != 0 || velocity.z != 0;
+}
+
+TypeId
+CachingPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachingPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .SetGroupName ("Propagation")
+    .AddConstructor<CachingPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The deterministic loss model whose results are cached "
+                   "for the nodes which do not move.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachingPropagationLossModel::SetModel,
+                                        &CachingPropagationLossModel::GetModel),
+                   MakePointerChecker<PropagationLossModel> ())
+  ;
+  return tid;
+}
+
+CachingPropagationLossModel::CachingPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CachingPropagationLossModel::~CachingPropagationLossModel ()
+{
+  NS_LOG_FUNCTION (this);
+  DoFlush ();
+}
+
+void
+CachingPropagationLossModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  DoFlush ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+void
+CachingPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  DoFlush ();
+}
+
+Ptr<PropagationLossModel>
+CachingPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+CachingPropagationLossModel::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  DoFlush ();
+}
+
+void
+CachingPropagationLossModel::DoFlush (void) const
+{
+  for (std::vector<Node>::const_iterator i = m_nodes.begin (); i != m_nodes.end (); ++i)
+    {
+      i->mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                  MakeCallback (&CachingPropagationLossModel::NotifyCourseChange, this));
+    }
+  m_nodes.clear ();
+  m_nodeIndexes.clear ();
+  m_entries.clear ();
+}
+
+uint32_t
+CachingPropagationLossModel::GetNodeIndex (Ptr<MobilityModel> mobility) const
+{
+  std::unordered_map<const MobilityModel *, uint32_t>::const_iterator i = m_nodeIndexes.find (PeekPointer (mobility));
+  if (i != m_nodeIndexes.end ())
+    {
+      return i->second;
+    }
+  NS_LOG_LOGIC ("register mobility model " << mobility << " as node " << m_nodes.size ());
+  Node node;
+  node.mobility = mobility;
+  node.generation = 0;
+  node.moving = IsMoving (mobility);
+  mobility->TraceConnectWithoutContext ("CourseChange",
+                                        MakeCallback (&CachingPropagationLossModel::NotifyCourseChange, this));
+  m_nodes.push_back (node);
+  m_nodeIndexes[PeekPointer (mobility)] = m_nodes.size () - 1;
+  return m_nodes.size () - 1;
+}
+
+void
+CachingPropagationLossModel::NotifyCourseChange (Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::unordered_map<const MobilityModel *, uint32_t>::const_iterator i = m_nodeIndexes.find (PeekPointer (mobility));
+  NS_ASSERT (i != m_nodeIndexes.end ());
+  Node &node = m_nodes[i->second];
+  node.generation++;
+  node.moving = IsMoving (mobility);
+}
+
+double
+CachingPropagationLossModel::DoCalcRxPower (double txPowerDbm,
+                                            Ptr<MobilityModel> a,
+                                            Ptr<MobilityModel> b) const
+{
+  NS_ASSERT_MSG (m_model != 0, "CachingPropagationLossModel has no Model to cache");
+  uint32_t aIndex = GetNodeIndex (a);
+  uint32_t bIndex = GetNodeIndex (b);
+  const Node &aNode = m_nodes[aIndex];
+  const Node &bNode = m_nodes[bIndex];
+  if (aNode.moving || bNode.moving)
+    {
+      return m_model->CalcRxPower (txPowerDbm, a, b);
+    }
+  Entry &entry = m_entries[(static_cast<uint64_t> (aIndex) << 32) | bIndex];
+  if (entry.aGeneration == aNode.generation + 1
+      && entry.bGeneration == bNode.generation + 1
+      && entry.txPowerDbm == txPowerDbm)
+    {
+      NS_LOG_LOGIC ("cached rx power from node " << aIndex << " to node " << bIndex << ": " << entry.rxPowerDbm);
+      return entry.rxPowerDbm;
+    }
+  // the generations are stored plus one, so that a new entry, which is
+  // zeroed, never matches.
+  entry.aGeneration = aNode.generation + 1;
+  entry.bGeneration = bNode.generation + 1;
+  entry.txPowerDbm = txPowerDbm;
+  entry.rxPowerDbm = m_model->CalcRxPower (txPowerDbm, a, b);
+  return entry.rxPowerDbm;
+}
+
+int64_t
+CachingPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  if (m_model == 0)
+    {
+      return 0;
+    }
+  return m_model->AssignStreams (stream);
+}
+
+} // namespace ns3
@@ -22,7 +22,9 @@
 #include "ns3/config.h"
 #include "ns3/double.h"
 #include "ns3/propagation-loss-model.h"
+#include "ns3/caching-propagation-loss-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/simulator.h"
 
 using namespace ns3;
@@ -436,6 +438,82 @@ RangePropagationLossModelTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class CachingPropagationLossModelTestCase : public TestCase
+{
+public:
+  CachingPropagationLossModelTestCase ();
+  virtual ~CachingPropagationLossModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CachingPropagationLossModelTestCase::CachingPropagationLossModelTestCase ()
+  : TestCase ("Test CachingPropagationLossModel")
+{
+}
+
+CachingPropagationLossModelTestCase::~CachingPropagationLossModelTestCase ()
+{
+}
+
+void
+CachingPropagationLossModelTestCase::DoRun (void)
+{
+  Ptr<MobilityModel> m[2];
+  for (int i = 0; i < 2; ++i)
+    {
+      m[i] = CreateObject<ConstantPositionMobilityModel> ();
+    }
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetVelocity (Vector (1, 0, 0));
+
+  // the matrix model is changed behind the back of the cache, to tell
+  // the cached results from the computed ones.
+  Ptr<MatrixPropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel> ();
+  matrix->SetDefaultLoss (0);
+  matrix->SetLoss (m[0], m[1], 10, /*symmetric = */ false);
+  matrix->SetLoss (m[0], moving, 10);
+  Ptr<MatrixPropagationLossModel> next = CreateObject<MatrixPropagationLossModel> ();
+  next->SetDefaultLoss (1);
+
+  Ptr<CachingPropagationLossModel> loss = CreateObject<CachingPropagationLossModel> ();
+  loss->SetModel (matrix);
+  loss->SetNext (next);
+
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[0], m[1]), -11, "Loss 0 -> 1 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[1], m[0]), -1, "Loss 1 -> 0 incorrect");
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[0], moving), -11, "Loss 0 -> moving incorrect");
+
+  matrix->SetLoss (m[0], m[1], 20, /*symmetric = */ false);
+  matrix->SetLoss (m[0], moving, 20);
+  next->SetDefaultLoss (2);
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[0], m[1]), -12, "Loss 0 -> 1 not cached");
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[0], moving), -22, "Loss 0 -> moving cached");
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (10, m[0], m[1]), -12, "Loss 0 -> 1 cached for another tx power");
+
+  // moving either node invalidates the cached results.
+  matrix->SetLoss (m[0], m[1], 30, /*symmetric = */ false);
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (10, m[0], m[1]), -12, "Loss 0 -> 1 not cached");
+  m[1]->SetPosition (Vector (1, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (10, m[0], m[1]), -22, "Loss 0 -> 1 cached after a course change");
+  matrix->SetLoss (m[0], m[1], 40, /*symmetric = */ false);
+  m[0]->SetPosition (Vector (1, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (10, m[0], m[1]), -32, "Loss 0 -> 1 cached after a course change");
+
+  matrix->SetLoss (m[0], m[1], 50, /*symmetric = */ false);
+  loss->Flush ();
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (10, m[0], m[1]), -42, "Loss 0 -> 1 cached after a flush");
+
+  // the node stops: its results are cached from now on.
+  moving->SetVelocity (Vector (0, 0, 0));
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[0], moving), -22, "Loss 0 -> stopped incorrect");
+  matrix->SetLoss (m[0], moving, 30);
+  NS_TEST_ASSERT_MSG_EQ (loss->CalcRxPower (0, m[0], moving), -22, "Loss 0 -> stopped not cached");
+
+  Simulator::Destroy ();
+}
+
 class PropagationLossModelsTestSuite : public TestSuite
 {
 public:
@@ -450,6 +528,7 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite ()
   AddTestCase (new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new MatrixPropagationLossModelTestCase, TestCase::QUICK);
   AddTestCase (new RangePropagationLossModelTestCase, TestCase::QUICK);
+  AddTestCase (new CachingPropagationLossModelTestCase, TestCase::QUICK);
 }
 
 static PropagationLossModelsTestSuite propagationLossModelsTestSuite;
@@ -82,6 +82,7 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_spatialIndex (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -95,6 +96,8 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  m_spatialIndex.Clear ();
+  m_indexedPhys.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -119,6 +122,16 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The maximum distance in meters between the transmitter and "
+                   "the receivers to which the signals are passed, or 0 for "
+                   "no limit. The receivers in range are found through a grid "
+                   "of their positions, so that the signals are not computed "
+                   "for the receivers which are far away. Like MaxLossDb, "
+                   "tune this value with care.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -161,6 +174,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   // we need to scan for all rxSpectrumModel values since we don't
   // know which spectrum model the phy had when it was previously added
   // (it's probably different than the current one)
+  bool known = false;
   for (RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator !=  m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -170,11 +184,16 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
         {
           rxInfoIterator->second.m_rxPhySet.erase (phyIt);
           --m_numDevices;
+          known = true;
           break; // there should be at most one entry
         }       
     }
 
   ++m_numDevices;
+  if (!known)
+    {
+      m_indexedPhys.push_back (phy);
+    }
 
   RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.find (rxSpectrumModelUid);
 
@@ -282,6 +301,33 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  // with a maximum range, only the receivers in range are looked at,
+  // grouped by RX SpectrumModel like in m_rxSpectrumModelInfoMap.
+  bool inRangeOnly = m_maxRange > 0 && txMobility != 0;
+  std::map<SpectrumModelUid_t, std::set<Ptr<SpectrumPhy> > > rxPhySetsInRange;
+  if (inRangeOnly)
+    {
+      m_spatialIndex.SetCellSize (m_maxRange);
+      // the mobility of a phy might be set after it is added.
+      while (m_spatialIndex.GetN () < m_indexedPhys.size ())
+        {
+          m_spatialIndex.Add (m_indexedPhys[m_spatialIndex.GetN ()]->GetMobility ());
+        }
+      std::vector<uint32_t> candidates;
+      m_spatialIndex.GetCandidates (txMobility->GetPosition (), m_maxRange, candidates);
+      for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); ++i)
+        {
+          Ptr<SpectrumPhy> rxPhy = m_indexedPhys[*i];
+          Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility ();
+          if (receiverMobility && txMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+            {
+              continue;
+            }
+          rxPhySetsInRange[rxPhy->GetRxSpectrumModel ()->GetUid ()].insert (rxPhy);
+        }
+      NS_LOG_LOGIC (candidates.size () << " receivers may be in range out of " << m_indexedPhys.size ());
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -308,8 +354,10 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
 
 
-      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+      const std::set<Ptr<SpectrumPhy> > &rxPhySet = inRangeOnly ? rxPhySetsInRange[rxSpectrumModelUid]
+        : rxInfoIterator->second.m_rxPhySet;
+      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxPhySet.begin ();
+           rxPhyIterator != rxPhySet.end ();
            ++rxPhyIterator)
         {
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
@@ -27,8 +27,10 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/spatial-index.h>
 #include <map>
 #include <set>
+#include <vector>
 
 namespace ns3 {
 
@@ -102,6 +104,10 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * When the MaxRange attribute is set, the signals are only passed to
+ * the receivers within that distance of the transmitter, which are
+ * found through a SpatialIndex of their positions.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -207,6 +213,22 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Maximum distance [m] of the receivers, or 0 if unlimited.
+   */
+  double m_maxRange;
+
+  /**
+   * The SpectrumPhy instances connected to the channel, in the order
+   * they were first added.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_indexedPhys;
+
+  /**
+   * Positions of the receivers, by index in m_indexedPhys.
+   */
+  SpatialIndex m_spatialIndex;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -45,6 +45,12 @@ NS_LOG_COMPONENT_DEFINE ("SingleModelSpectrumChannel");
 NS_OBJECT_ENSURE_REGISTERED (SingleModelSpectrumChannel);
 
 SingleModelSpectrumChannel::SingleModelSpectrumChannel ()
+  : m_spatialIndex (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SingleModelSpectrumChannel::~SingleModelSpectrumChannel ()
 {
   NS_LOG_FUNCTION (this);
 }
@@ -53,6 +59,7 @@ void
 SingleModelSpectrumChannel::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_spatialIndex.Clear ();
   m_phyList.clear ();
   m_spectrumModel = 0;
   m_propagationDelay = 0;
@@ -83,6 +90,16 @@ SingleModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&SingleModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The maximum distance in meters between the transmitter and "
+                   "the receivers to which the signals are passed, or 0 for "
+                   "no limit. The receivers in range are found through a grid "
+                   "of their positions, so that the signals are not computed "
+                   "for the receivers which are far away. Like MaxLossDb, "
+                   "tune this value with care.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&SingleModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -134,15 +151,34 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility ();
 
-  for (PhyList::const_iterator rxPhyIterator = m_phyList.begin ();
-       rxPhyIterator != m_phyList.end ();
-       ++rxPhyIterator)
+  bool inRangeOnly = m_maxRange > 0 && senderMobility != 0;
+  std::vector<uint32_t> candidates;
+  if (inRangeOnly)
     {
-      if ((*rxPhyIterator) != txParams->txPhy)
+      m_spatialIndex.SetCellSize (m_maxRange);
+      // the mobility of a phy might be set after it is added.
+      while (m_spatialIndex.GetN () < m_phyList.size ())
+        {
+          m_spatialIndex.Add (m_phyList[m_spatialIndex.GetN ()]->GetMobility ());
+        }
+      m_spatialIndex.GetCandidates (senderMobility->GetPosition (), m_maxRange, candidates);
+      NS_LOG_LOGIC (candidates.size () << " receivers may be in range out of " << m_phyList.size ());
+    }
+  std::size_t nReceivers = inRangeOnly ? candidates.size () : m_phyList.size ();
+
+  for (std::size_t k = 0; k < nReceivers; k++)
+    {
+      Ptr<SpectrumPhy> rxPhy = m_phyList[inRangeOnly ? candidates[k] : k];
+      if (rxPhy != txParams->txPhy)
         {
           Time delay  = MicroSeconds (0);
 
-          Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+          Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility ();
+          if (inRangeOnly && receiverMobility
+              && senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+            {
+              continue;
+            }
           NS_LOG_LOGIC ("copying signal parameters " << txParams);
           Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
 
@@ -156,7 +192,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
                   pathLossDb -= txAntennaGain;
                 }
-              Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
+              Ptr<AntennaModel> rxAntenna = rxPhy->GetRxAntenna ();
               if (rxAntenna != 0)
                 {
                   Angles rxAngles (senderMobility->GetPosition (), receiverMobility->GetPosition ());
@@ -171,7 +207,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
                   pathLossDb -= propagationGainDb;
                 }                    
               NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-              m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
+              m_pathLossTrace (txParams->txPhy, rxPhy, pathLossDb);
               if ( pathLossDb > m_maxLossDb)
                 {
                   // beyond range
@@ -192,18 +228,18 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
             }
 
 
-          Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
+          Ptr<NetDevice> netDev = rxPhy->GetDevice ();
           if (netDev)
             {
               // the receiver has a NetDevice, so we expect that it is attached to a Node
               uint32_t dstNode =  netDev->GetNode ()->GetId ();
-              Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, *rxPhyIterator);
+              Simulator::ScheduleWithContext (dstNode, delay, &SingleModelSpectrumChannel::StartRx, this, rxParams, rxPhy);
             }
           else
             {
               // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
               Simulator::Schedule (delay, &SingleModelSpectrumChannel::StartRx, this,
-                                   rxParams, *rxPhyIterator);
+                                   rxParams, rxPhy);
             }
         }
     }
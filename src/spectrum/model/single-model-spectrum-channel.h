@@ -25,6 +25,7 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-model.h>
 #include <ns3/traced-callback.h>
+#include <ns3/spatial-index.h>
 
 namespace ns3 {
 
@@ -36,12 +37,17 @@ namespace ns3 {
  * @brief SpectrumChannel implementation which handles a single spectrum model
  *
  * All SpectrumPhy layers attached to this SpectrumChannel
+ *
+ * When the MaxRange attribute is set, the signals are only passed to
+ * the receivers within that distance of the transmitter, which are
+ * found through a SpatialIndex of their positions.
  */
 class SingleModelSpectrumChannel : public SpectrumChannel
 {
 
 public:
   SingleModelSpectrumChannel ();
+  virtual ~SingleModelSpectrumChannel ();
 
   /**
    * \brief Get the type ID.
@@ -116,6 +122,16 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Maximum distance [m] of the receivers, or 0 if unlimited.
+   */
+  double m_maxRange;
+
+  /**
+   * Positions of the receivers, by index in m_phyList.
+   */
+  SpatialIndex m_spatialIndex;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compare the cost of the queues storing their items in a list (the
+ * default) and in a ring buffer (the RingBuffer attribute of DropTailQueue):
+ *
+ * - FqCoDelQueueDisc: packets of several flows are enqueued in and dequeued
+ *   from a FqCoDelQueueDisc holding a standing backlog, whose flows use
+ *   DropTailQueue internal queues;
+ *
+ * - PointToPointNetDevice: UDP flows are sent at a rate higher than the one
+ *   of a point-to-point link, so that the DropTailQueue of the device and the
+ *   FqCoDelQueueDisc installed on it stay busy.
+ *
+ * ./waf --run "queue-ring-buffer-benchmark --operations=1000000 --backlog=1000 --duration=10"
+ */
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/traffic-control-module.h"
+
+using namespace ns3;
+
+/**
+ * Build a packet of a UDP flow, with its IPv4 header.
+ * \param flow the index of the flow
+ * \param size the size of the payload
+ * \return the queue disc item
+ */
+Ptr<QueueDiscItem>
+CreateItem (uint32_t flow, uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (1000 + flow);
+  udpHeader.SetDestinationPort (9);
+  p->AddHeader (udpHeader);
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address ("10.0.0.1"));
+  ipHeader.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipHeader.SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  ipHeader.SetPayloadSize (p->GetSize ());
+  return Create<Ipv4QueueDiscItem> (p, Mac48Address::GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER, ipHeader);
+}
+
+/**
+ * Enqueue and dequeue packets in a FqCoDelQueueDisc holding a backlog.
+ * \param ringBuffer whether the internal queues use a ring buffer
+ * \param operations the number of packets enqueued and dequeued
+ * \param backlog the number of packets kept in the queue disc
+ * \param flows the number of flows
+ * \return the time taken (ms)
+ */
+int64_t
+RunQueueDisc (bool ringBuffer, uint32_t operations, uint32_t backlog, uint32_t flows)
+{
+  Config::SetDefault ("ns3::DropTailQueue<QueueDiscItem>::RingBuffer", BooleanValue (ringBuffer));
+  Ptr<QueueDisc> queueDisc = CreateObject<FqCoDelQueueDisc> ();
+  queueDisc->SetAttribute ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, backlog + 1)));
+  queueDisc->SetNetDevice (CreateObject<SimpleNetDevice> ());
+  queueDisc->Initialize ();
+
+  // the items are built beforehand, so that only the queue disc is measured
+  std::vector<Ptr<QueueDiscItem> > items;
+  for (uint32_t i = 0; i < backlog + operations; i++)
+    {
+      items.push_back (CreateItem (i % flows, 1000));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < backlog; i++)
+    {
+      queueDisc->Enqueue (items[i]);
+    }
+  for (uint32_t i = 0; i < operations; i++)
+    {
+      queueDisc->Enqueue (items[backlog + i]);
+      queueDisc->Dequeue ();
+    }
+  while (queueDisc->Dequeue ())
+    {
+    }
+  int64_t elapsed = clock.End ();
+
+  NS_ABORT_MSG_UNLESS (queueDisc->GetStats ().nTotalDroppedPackets == 0, "No packet should be dropped");
+  queueDisc->Dispose ();
+  return elapsed;
+}
+
+/**
+ * Send UDP flows faster than a point-to-point link.
+ * \param ringBuffer whether the queues use a ring buffer
+ * \param duration the simulated time (s)
+ * \param flows the number of flows
+ * \param received the number of packets received
+ * \return the time taken (ms)
+ */
+int64_t
+RunPointToPoint (bool ringBuffer, double duration, uint32_t flows, uint64_t &received)
+{
+  Config::SetDefault ("ns3::DropTailQueue<QueueDiscItem>::RingBuffer", BooleanValue (ringBuffer));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  p2p.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("100p"),
+                "RingBuffer", BooleanValue (ringBuffer));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FqCoDelQueueDisc");
+  tch.Install (devices);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  // the flows send 20% more than the link rate
+  ApplicationContainer sources;
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (interfaces.GetAddress (1), 9));
+      onoff.SetConstantRate (DataRate (1200000000 / flows), 1000);
+      sources.Add (onoff.Install (nodes.Get (0)));
+    }
+  sources.Start (Seconds (0));
+  sources.Stop (Seconds (duration));
+
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), 9));
+  ApplicationContainer sink = sinkHelper.Install (nodes.Get (1));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (duration + 0.1));
+  Simulator::Run ();
+  int64_t elapsed = clock.End ();
+
+  received = DynamicCast<PacketSink> (sink.Get (0))->GetTotalRx () / 1000;
+  Simulator::Destroy ();
+  return elapsed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t operations = 1000000;
+  uint32_t backlog = 1000;
+  uint32_t flows = 16;
+  double duration = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("operations", "Number of packets enqueued and dequeued in the queue disc", operations);
+  cmd.AddValue ("backlog", "Number of packets kept in the queue disc", backlog);
+  cmd.AddValue ("flows", "Number of flows", flows);
+  cmd.AddValue ("duration", "Simulated time of the point-to-point test (s)", duration);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (24) << std::left << "test"
+            << std::setw (12) << "list (ms)" << std::setw (18) << "ring buffer (ms)" << std::endl;
+
+  int64_t list = RunQueueDisc (false, operations, backlog, flows);
+  int64_t ring = RunQueueDisc (true, operations, backlog, flows);
+  std::cout << std::setw (24) << "FqCoDelQueueDisc"
+            << std::setw (12) << list << std::setw (18) << ring << std::endl;
+
+  uint64_t listReceived, ringReceived;
+  list = RunPointToPoint (false, duration, flows, listReceived);
+  ring = RunPointToPoint (true, duration, flows, ringReceived);
+  std::cout << std::setw (24) << "PointToPointNetDevice"
+            << std::setw (12) << list << std::setw (18) << ring << std::endl;
+  NS_ABORT_MSG_UNLESS (listReceived == ringReceived, "Both runs should deliver the same packets");
+  std::cout << "packets received: " << ringReceived << std::endl;
+
+  return 0;
+}
@@ -87,6 +87,16 @@ QueueDiscClass::SetQueueDisc (Ptr<QueueDisc> qd)
   m_queueDisc = qd;
 }
 
+QueueDisc::ReasonStats::ReasonStats ()
+  : nDroppedPacketsBeforeEnqueue (0),
+    nDroppedBytesBeforeEnqueue (0),
+    nDroppedPacketsAfterDequeue (0),
+    nDroppedBytesAfterDequeue (0),
+    nMarkedPackets (0),
+    nMarkedBytes (0)
+{
+}
+
 QueueDisc::Stats::Stats ()
   : nTotalReceivedPackets (0),
     nTotalReceivedBytes (0),
@@ -355,13 +365,11 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   // the packet is dropped.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DoDropBeforeEnqueue (item, GetReasonIndex (r, true));
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      return DoDropAfterDequeue (item, GetReasonIndex (r, true));
     };
 }
 
@@ -433,6 +441,33 @@ QueueDisc::GetStats (void)
   m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - (m_requeued ? m_requeued->GetSize () : 0)
                             - m_stats.nTotalDroppedBytesAfterDequeue;
 
+  // the counters for each reason are only copied here, so that dropping or
+  // marking a packet does not need to look up the reason in the maps
+  m_stats.nDroppedPacketsBeforeEnqueue.clear ();
+  m_stats.nDroppedBytesBeforeEnqueue.clear ();
+  m_stats.nDroppedPacketsAfterDequeue.clear ();
+  m_stats.nDroppedBytesAfterDequeue.clear ();
+  m_stats.nMarkedPackets.clear ();
+  m_stats.nMarkedBytes.clear ();
+  for (std::deque<ReasonStats>::const_iterator it = m_reasons.begin (); it != m_reasons.end (); it++)
+    {
+      if (it->nDroppedPacketsBeforeEnqueue > 0)
+        {
+          m_stats.nDroppedPacketsBeforeEnqueue[it->name] = it->nDroppedPacketsBeforeEnqueue;
+          m_stats.nDroppedBytesBeforeEnqueue[it->name] = it->nDroppedBytesBeforeEnqueue;
+        }
+      if (it->nDroppedPacketsAfterDequeue > 0)
+        {
+          m_stats.nDroppedPacketsAfterDequeue[it->name] = it->nDroppedPacketsAfterDequeue;
+          m_stats.nDroppedBytesAfterDequeue[it->name] = it->nDroppedBytesAfterDequeue;
+        }
+      if (it->nMarkedPackets > 0)
+        {
+          m_stats.nMarkedPackets[it->name] = it->nMarkedPackets;
+          m_stats.nMarkedBytes[it->name] = it->nMarkedBytes;
+        }
+    }
+
   return m_stats;
 }
 
@@ -708,75 +743,88 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
     }
 }
 
+uint32_t
+QueueDisc::GetReasonIndex (const char* reason, bool child)
+{
+  std::vector<std::pair<const char*, uint32_t> > &indexes = child ? m_childReasonIndexes : m_reasonIndexes;
+  for (std::vector<std::pair<const char*, uint32_t> >::const_iterator it = indexes.begin ();
+       it != indexes.end (); it++)
+    {
+      if (it->first == reason)
+        {
+          return it->second;
+        }
+    }
+
+  // first time this string is seen: strings with the same contents share
+  // the same counters
+  std::string name = child ? std::string (CHILD_QUEUE_DISC_DROP) + reason : std::string (reason);
+  uint32_t index = 0;
+  while (index < m_reasons.size () && m_reasons[index].name != name)
+    {
+      index++;
+    }
+  if (index == m_reasons.size ())
+    {
+      NS_LOG_LOGIC ("New reason " << name);
+      m_reasons.push_back (ReasonStats ());
+      m_reasons.back ().name = name;
+    }
+  indexes.push_back (std::make_pair (reason, index));
+  return index;
+}
+
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 {
   NS_LOG_FUNCTION (this << item << reason);
+  DoDropBeforeEnqueue (item, GetReasonIndex (reason, false));
+}
+
+void
+QueueDisc::DoDropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t index)
+{
+  NS_LOG_FUNCTION (this << item << index);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  ReasonStats &reason = m_reasons[index];
+  reason.nDroppedPacketsBeforeEnqueue++;
+  reason.nDroppedBytesBeforeEnqueue += item->GetSize ();
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
                 << m_stats.nTotalDroppedBytesBeforeEnqueue);
   NS_LOG_LOGIC ("m_traceDropBeforeEnqueue (p)");
   m_traceDrop (item);
-  m_traceDropBeforeEnqueue (item, reason);
+  m_traceDropBeforeEnqueue (item, reason.name.c_str ());
 }
 
 void
 QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
 {
   NS_LOG_FUNCTION (this << item << reason);
+  DoDropAfterDequeue (item, GetReasonIndex (reason, false));
+}
+
+void
+QueueDisc::DoDropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t index)
+{
+  NS_LOG_FUNCTION (this << item << index);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  ReasonStats &reason = m_reasons[index];
+  reason.nDroppedPacketsAfterDequeue++;
+  reason.nDroppedBytesAfterDequeue += item->GetSize ();
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -794,7 +842,7 @@ QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
                 << m_stats.nTotalDroppedBytesAfterDequeue);
   NS_LOG_LOGIC ("m_traceDropAfterDequeue (p)");
   m_traceDrop (item);
-  m_traceDropAfterDequeue (item, reason);
+  m_traceDropAfterDequeue (item, reason.name.c_str ());
 }
 
 bool
@@ -812,31 +860,15 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes marked for the given reason
+  ReasonStats &stats = m_reasons[GetReasonIndex (reason, false)];
+  stats.nMarkedPackets++;
+  stats.nMarkedBytes += item->GetSize ();
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
                 << m_stats.nTotalMarkedBytes);
-  m_traceMark (item, reason);
+  m_traceMark (item, stats.name.c_str ());
   return true;
 }
 
@@ -27,6 +27,7 @@
 #include "ns3/queue-item.h"
 #include "ns3/queue-size.h"
 #include <vector>
+#include <deque>
 #include <map>
 #include <functional>
 #include <string>
@@ -167,7 +168,10 @@ enum QueueDiscSizePolicy
  * When a packet is dropped by an internal queue, e.g., because the queue is full,
  * the reason is "Dropped by internal queue". When a packet is dropped by a child
  * queue disc, the reason is "(Dropped by child queue disc) " followed by the
- * reason why the child queue disc dropped the packet.
+ * reason why the child queue disc dropped the packet.  The counters are kept
+ * in an array indexed by reason, each reason string being looked up only the
+ * first time it is seen; the per-reason maps of the statistics are filled
+ * when GetStats is called.
  *
  * The QueueDisc base class provides the SojournTime trace source, which provides
  * the sojourn time of every packet dequeued from a queue disc, including packets
@@ -205,21 +209,21 @@ public:
     uint32_t nTotalDroppedPackets;
     /// Total packets dropped before enqueue
     uint32_t nTotalDroppedPacketsBeforeEnqueue;
-    /// Packets dropped before enqueue, for each reason
+    /// Packets dropped before enqueue, for each reason -- this value is not kept up to date, call GetStats first
     std::map<std::string, uint32_t> nDroppedPacketsBeforeEnqueue;
     /// Total packets dropped after dequeue
     uint32_t nTotalDroppedPacketsAfterDequeue;
-    /// Packets dropped after dequeue, for each reason
+    /// Packets dropped after dequeue, for each reason -- this value is not kept up to date, call GetStats first
     std::map<std::string, uint32_t> nDroppedPacketsAfterDequeue;
     /// Total dropped bytes
     uint64_t nTotalDroppedBytes;
     /// Total bytes dropped before enqueue
     uint64_t nTotalDroppedBytesBeforeEnqueue;
-    /// Bytes dropped before enqueue, for each reason
+    /// Bytes dropped before enqueue, for each reason -- this value is not kept up to date, call GetStats first
     std::map<std::string, uint64_t> nDroppedBytesBeforeEnqueue;
     /// Total bytes dropped after dequeue
     uint64_t nTotalDroppedBytesAfterDequeue;
-    /// Bytes dropped after dequeue, for each reason
+    /// Bytes dropped after dequeue, for each reason -- this value is not kept up to date, call GetStats first
     std::map<std::string, uint64_t> nDroppedBytesAfterDequeue;
     /// Total requeued packets
     uint32_t nTotalRequeuedPackets;
@@ -227,11 +231,11 @@ public:
     uint64_t nTotalRequeuedBytes;
     /// Total marked packets
     uint32_t nTotalMarkedPackets;
-    /// Marked packets, for each reason
+    /// Marked packets, for each reason -- this value is not kept up to date, call GetStats first
     std::map<std::string, uint32_t> nMarkedPackets;
     /// Total marked bytes
     uint32_t nTotalMarkedBytes;
-    /// Marked bytes, for each reason
+    /// Marked bytes, for each reason -- this value is not kept up to date, call GetStats first
     std::map<std::string, uint64_t> nMarkedBytes;
 
     /// constructor
@@ -515,7 +519,10 @@ protected:
    *  \param item item that was dropped
    *  \param reason the reason why the item was dropped
    *  This method must be called by subclasses to record that a packet was
-   *  dropped before enqueue for the specified reason
+   *  dropped before enqueue for the specified reason. After the first call,
+   *  the reason is identified by its address, hence the string must not be
+   *  modified during the lifetime of the queue disc (the reasons are usually
+   *  static constants of the subclasses)
    */
   void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
 
@@ -525,7 +532,8 @@ protected:
    *  \param item item that was dropped
    *  \param reason the reason why the item was dropped
    *  This method must be called by subclasses to record that a packet was
-   *  dropped after dequeue for the specified reason
+   *  dropped after dequeue for the specified reason. As for DropBeforeEnqueue,
+   *  the string must not be modified during the lifetime of the queue disc
    */
   void DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason);
 
@@ -535,10 +543,52 @@ protected:
    *  \param item item that has to be marked
    *  \param reason the reason why the item has to be marked
    *  \return true if the item was successfully marked, false otherwise
+   *  As for DropBeforeEnqueue, the string must not be modified during the
+   *  lifetime of the queue disc
    */
   bool Mark (Ptr<QueueDiscItem> item, const char* reason);
 
 private:
+  /// The counters kept for a reason to drop or mark packets
+  struct ReasonStats
+  {
+    /// constructor
+    ReasonStats ();
+
+    std::string name;                      //!< The reason
+    uint32_t nDroppedPacketsBeforeEnqueue; //!< Packets dropped before enqueue
+    uint64_t nDroppedBytesBeforeEnqueue;   //!< Bytes dropped before enqueue
+    uint32_t nDroppedPacketsAfterDequeue;  //!< Packets dropped after dequeue
+    uint64_t nDroppedBytesAfterDequeue;    //!< Bytes dropped after dequeue
+    uint32_t nMarkedPackets;               //!< Marked packets
+    uint64_t nMarkedBytes;                 //!< Marked bytes
+  };
+
+  /**
+   *  \brief Get the index of the counters of a reason, adding them the first
+   *         time the reason is seen
+   *  \param reason the reason why a packet was dropped or marked
+   *  \param child true if the reason was given by a child queue disc
+   *  \return the index of the counters in m_reasons
+   */
+  uint32_t GetReasonIndex (const char* reason, bool child);
+
+  /**
+   *  \brief Update the statistics and fire the traces for a packet dropped
+   *         before enqueue
+   *  \param item item that was dropped
+   *  \param index the index of the reason in m_reasons
+   */
+  void DoDropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t index);
+
+  /**
+   *  \brief Update the statistics and fire the traces for a packet dropped
+   *         after dequeue
+   *  \param item item that was dropped
+   *  \param index the index of the reason in m_reasons
+   */
+  void DoDropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t index);
+
   /**
    * \brief Copy constructor
    * \param o object to copy
@@ -676,7 +726,12 @@ private:
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
+  /// The counters of the reasons seen so far, whose names keep their address
+  std::deque<ReasonStats> m_reasons;
+  /// The index in m_reasons of each reason string given by this queue disc
+  std::vector<std::pair<const char*, uint32_t> > m_reasonIndexes;
+  /// The index in m_reasons of each reason string given by the child queue discs
+  std::vector<std::pair<const char*, uint32_t> > m_childReasonIndexes;
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
 
@@ -387,6 +387,18 @@ QueueDiscTracesTestCase::CheckDroppedBeforeEnqueue (Ptr<QueueDisc> qd, uint32_t
                          "Verify that the number of bytes dropped before enqueue is computed correctly");
   NS_TEST_EXPECT_MSG_EQ (m_counter[qd].m_nDbeBytes, nDbeBytes,
                          "Verify that the number of bytes dropped before enqueue is computed correctly");
+
+  uint32_t nReasonPackets = 0;
+  uint64_t nReasonBytes = 0;
+  for (auto it = stats.nDroppedPacketsBeforeEnqueue.begin (); it != stats.nDroppedPacketsBeforeEnqueue.end (); it++)
+    {
+      nReasonPackets += it->second;
+      nReasonBytes += stats.nDroppedBytesBeforeEnqueue[it->first];
+    }
+  NS_TEST_EXPECT_MSG_EQ (nReasonPackets, nDbePackets,
+                         "Verify that the packets dropped before enqueue are counted for their reason");
+  NS_TEST_EXPECT_MSG_EQ (nReasonBytes, nDbeBytes,
+                         "Verify that the bytes dropped before enqueue are counted for their reason");
 }
 
 void
@@ -403,6 +415,18 @@ QueueDiscTracesTestCase::CheckDroppedAfterDequeue (Ptr<QueueDisc> qd, uint32_t n
                          "Verify that the number of bytes dropped after dequeue is computed correctly");
   NS_TEST_EXPECT_MSG_EQ (m_counter[qd].m_nDadBytes, nDadBytes,
                          "Verify that the number of bytes dropped after dequeue is computed correctly");
+
+  uint32_t nReasonPackets = 0;
+  uint64_t nReasonBytes = 0;
+  for (auto it = stats.nDroppedPacketsAfterDequeue.begin (); it != stats.nDroppedPacketsAfterDequeue.end (); it++)
+    {
+      nReasonPackets += it->second;
+      nReasonBytes += stats.nDroppedBytesAfterDequeue[it->first];
+    }
+  NS_TEST_EXPECT_MSG_EQ (nReasonPackets, nDadPackets,
+                         "Verify that the packets dropped after dequeue are counted for their reason");
+  NS_TEST_EXPECT_MSG_EQ (nReasonBytes, nDadBytes,
+                         "Verify that the bytes dropped after dequeue are counted for their reason");
 }
 
 void
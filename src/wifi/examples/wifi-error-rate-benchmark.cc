@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compare the cost and the results of the analytical error rate models
+ * (NistErrorRateModel and YansErrorRateModel) with the ones of an
+ * InterpolatedErrorRateModel wrapping them, over random chunks of the
+ * OFDM, HT, VHT, HE and DSSS modes.
+ *
+ * ./waf --run "wifi-error-rate-benchmark --chunks=1000000 --resolution=0.05"
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/interpolated-error-rate-model.h"
+
+using namespace ns3;
+
+/// A chunk whose success rate is computed.
+struct Chunk
+{
+  WifiMode mode;         //!< the mode of the chunk
+  WifiTxVector txVector; //!< the TXVECTOR of the transmission
+  double snr;            //!< the SNR of the chunk (linear)
+  uint64_t nbits;        //!< the size of the chunk
+};
+
+/**
+ * Compute the success rates of all the chunks.
+ * \param model the error rate model
+ * \param chunks the chunks
+ * \param rates the success rates
+ * \return the time taken (ms)
+ */
+int64_t
+Run (Ptr<ErrorRateModel> model, const std::vector<Chunk> &chunks, std::vector<double> &rates)
+{
+  rates.resize (chunks.size ());
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (std::size_t i = 0; i < chunks.size (); i++)
+    {
+      rates[i] = model->GetChunkSuccessRate (chunks[i].mode, chunks[i].txVector, chunks[i].snr, chunks[i].nbits);
+    }
+  return clock.End ();
+}
+
+/**
+ * Benchmark an analytical model against its interpolated version.
+ * \param name the name of the model
+ * \param model the analytical model
+ * \param chunks the chunks
+ * \param resolution the resolution of the tables (dB)
+ */
+void
+Compare (std::string name, Ptr<ErrorRateModel> model, const std::vector<Chunk> &chunks, double resolution)
+{
+  Ptr<InterpolatedErrorRateModel> interpolated = CreateObject<InterpolatedErrorRateModel> ();
+  interpolated->SetAttribute ("Resolution", DoubleValue (resolution));
+  interpolated->SetModel (model);
+
+  std::vector<double> exact;
+  std::vector<double> approximate;
+  int64_t analyticalMs = Run (model, chunks, exact);
+  // the first run also samples the tables.
+  int64_t firstMs = Run (interpolated, chunks, approximate);
+  int64_t interpolatedMs = Run (interpolated, chunks, approximate);
+
+  double maxError = 0;
+  for (std::size_t i = 0; i < chunks.size (); i++)
+    {
+      maxError = std::max (maxError, std::abs (exact[i] - approximate[i]));
+    }
+  double n = static_cast<double> (chunks.size ());
+  std::cout << std::left << std::setw (6) << name << std::right << std::fixed
+            << "  analytical " << std::setprecision (1) << std::setw (8) << analyticalMs * 1e6 / n << " ns/chunk"
+            << "  interpolated " << std::setw (6) << interpolatedMs * 1e6 / n << " ns/chunk"
+            << " (first run " << firstMs << " ms)"
+            << "  speedup " << std::setprecision (1) << (interpolatedMs > 0 ? double (analyticalMs) / interpolatedMs : 0) << "x"
+            << "  max error " << std::scientific << std::setprecision (2) << maxError
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nChunks = 1000000;
+  double resolution = 0.05;
+
+  CommandLine cmd;
+  cmd.AddValue ("chunks", "number of chunks (default 1E6)", nChunks);
+  cmd.AddValue ("resolution", "resolution of the tables in dB (default 0.05)", resolution);
+  cmd.Parse (argc, argv);
+
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate2Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate5_5Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate12Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+  modes.push_back (WifiPhy::GetHtMcs0 ());
+  modes.push_back (WifiPhy::GetHtMcs4 ());
+  modes.push_back (WifiPhy::GetHtMcs7 ());
+  modes.push_back (WifiPhy::GetVhtMcs8 ());
+  modes.push_back (WifiPhy::GetVhtMcs9 ());
+  modes.push_back (WifiPhy::GetHeMcs11 ());
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  std::vector<Chunk> chunks (nChunks);
+  for (uint32_t i = 0; i < nChunks; i++)
+    {
+      Chunk &chunk = chunks[i];
+      chunk.mode = modes[rng->GetInteger (0, modes.size () - 1)];
+      chunk.txVector.SetMode (chunk.mode);
+      switch (chunk.mode.GetModulationClass ())
+        {
+        case WIFI_MOD_CLASS_DSSS:
+        case WIFI_MOD_CLASS_HR_DSSS:
+          chunk.txVector.SetChannelWidth (22);
+          break;
+        case WIFI_MOD_CLASS_VHT:
+        case WIFI_MOD_CLASS_HE:
+          chunk.txVector.SetChannelWidth (40);
+          break;
+        default:
+          chunk.txVector.SetChannelWidth (20);
+          break;
+        }
+      chunk.snr = std::pow (10.0, rng->GetValue (-5, 40) / 10.0);
+      chunk.nbits = rng->GetInteger (1, 1500) * 8;
+    }
+
+  std::cout << nChunks << " chunks, tables every " << resolution << " dB" << std::endl;
+  Compare ("Nist", CreateObject<NistErrorRateModel> (), chunks, resolution);
+  Compare ("Yans", CreateObject<YansErrorRateModel> (), chunks, resolution);
+  return 0;
+}
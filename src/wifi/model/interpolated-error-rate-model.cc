@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "interpolated-error-rate-model.h"
+#include "wifi-tx-vector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("InterpolatedErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (InterpolatedErrorRateModel);
+
+TypeId
+InterpolatedErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::InterpolatedErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<InterpolatedErrorRateModel> ()
+    .AddAttribute ("Model",
+                   "The error rate model whose success rates are sampled.",
+                   PointerValue (),
+                   MakePointerAccessor (&InterpolatedErrorRateModel::SetModel,
+                                        &InterpolatedErrorRateModel::GetModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The lowest SNR (dB) of the tables; "
+                   "the lower SNRs are passed to the model.",
+                   DoubleValue (-20.0),
+                   MakeDoubleAccessor (&InterpolatedErrorRateModel::m_minSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The highest SNR (dB) of the tables; "
+                   "the higher SNRs are passed to the model.",
+                   DoubleValue (60.0),
+                   MakeDoubleAccessor (&InterpolatedErrorRateModel::m_maxSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Resolution",
+                   "The SNR step (dB) between the samples of the tables.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&InterpolatedErrorRateModel::m_resolution),
+                   MakeDoubleChecker<double> (0.0001))
+  ;
+  return tid;
+}
+
+InterpolatedErrorRateModel::InterpolatedErrorRateModel ()
+  : m_lastKey (0),
+    m_lastTable (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+InterpolatedErrorRateModel::~InterpolatedErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+InterpolatedErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tables.clear ();
+  m_lastTable = 0;
+  m_model = 0;
+  ErrorRateModel::DoDispose ();
+}
+
+void
+InterpolatedErrorRateModel::SetModel (Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  m_tables.clear ();
+  m_lastTable = 0;
+}
+
+Ptr<ErrorRateModel>
+InterpolatedErrorRateModel::GetModel (void) const
+{
+  return m_model;
+}
+
+void
+InterpolatedErrorRateModel::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tables.clear ();
+  m_lastTable = 0;
+}
+
+const std::vector<double> &
+InterpolatedErrorRateModel::GetTable (WifiMode mode, WifiTxVector txVector) const
+{
+  uint64_t key = (static_cast<uint64_t> (mode.GetUid ()) << 32)
+    | (static_cast<uint64_t> (txVector.GetChannelWidth () & 0xff) << 24)
+    | (static_cast<uint64_t> (txVector.GetGuardInterval ()) << 8)
+    | txVector.GetNss ();
+  if (m_lastTable != 0 && key == m_lastKey)
+    {
+      return *m_lastTable;
+    }
+  m_lastKey = key;
+  std::unordered_map<uint64_t, std::vector<double> >::const_iterator it = m_tables.find (key);
+  if (it != m_tables.end ())
+    {
+      m_lastTable = &it->second;
+      return it->second;
+    }
+  NS_LOG_LOGIC ("sample " << mode << " width=" << txVector.GetChannelWidth ()
+                << " gi=" << txVector.GetGuardInterval () << " nss=" << +txVector.GetNss ());
+  std::vector<double> &table = m_tables[key];
+  m_lastTable = &table;
+  // the error rates which underflow are kept finite, so that they can
+  // be interpolated.
+  double minLogBer = std::log (std::numeric_limits<double>::min ());
+  uint32_t n = static_cast<uint32_t> ((m_maxSnr - m_minSnr) / m_resolution) + 1;
+  table.reserve (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double snr = std::pow (10.0, (m_minSnr + i * m_resolution) / 10.0);
+      double ber = 1 - m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+      table.push_back (ber > 0 ? std::max (std::log (ber), minLogBer) : minLogBer);
+    }
+  return table;
+}
+
+double
+InterpolatedErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  NS_ASSERT_MSG (m_model != 0, "InterpolatedErrorRateModel has no Model to sample");
+  const std::vector<double> &table = GetTable (mode, txVector);
+  double x = (10.0 * std::log10 (snr) - m_minSnr) / m_resolution;
+  // the comparison is false for a NaN
+  if (x >= 0 && x < table.size () - 1)
+    {
+      uint32_t i = static_cast<uint32_t> (x);
+      double ber = std::exp (table[i] + (x - i) * (table[i + 1] - table[i]));
+      return std::pow (1 - ber, static_cast<double> (nbits));
+    }
+  return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+}
+
+} //namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef INTERPOLATED_ERROR_RATE_MODEL_H
+#define INTERPOLATED_ERROR_RATE_MODEL_H
+
+#include <unordered_map>
+#include <vector>
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * \brief Answers the chunk success rates of another error rate model
+ * from tables sampled over a grid of SNRs.
+ *
+ * The wrapped model, set with the Model attribute, is sampled once
+ * for each combination of WifiMode, channel width, guard interval and
+ * number of spatial streams, the first time the combination is seen:
+ * its success rate for a single bit is computed every Resolution dB
+ * from MinSnr to MaxSnr.  The bits of a chunk are assumed to be
+ * received independently, as in the NistErrorRateModel, the
+ * YansErrorRateModel and the DsssErrorRateModel, so that the success
+ * rate of a chunk of n bits is the success rate of a bit raised to the
+ * power n, and a single table covers all the chunk sizes.
+ *
+ * The table holds the logarithm of the bit error rate, which varies
+ * smoothly with the SNR in dB and is interpolated linearly between the
+ * samples.  With the default resolution of 0.05 dB, the success rates
+ * differ from the ones of the wrapped model by less than 1e-3 (see the
+ * wifi-error-rate-models test suite and the wifi-error-rate-benchmark
+ * example).  The SNRs outside the grid are passed to the wrapped model.
+ */
+class InterpolatedErrorRateModel : public ErrorRateModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  InterpolatedErrorRateModel ();
+  virtual ~InterpolatedErrorRateModel ();
+
+  /**
+   * \param model the error rate model to sample.
+   */
+  void SetModel (Ptr<ErrorRateModel> model);
+  /**
+   * \return the error rate model which is sampled.
+   */
+  Ptr<ErrorRateModel> GetModel (void) const;
+
+  /**
+   * Forget all the tables, for instance after the attributes of this
+   * model or of the wrapped model have been changed.
+   */
+  void Flush (void);
+
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * Return the table of a mode, which is built the first time it is
+   * needed.
+   *
+   * \param mode the Wi-Fi mode of the chunk
+   * \param txVector TXVECTOR of the overall transmission
+   *
+   * \return the logarithms of the bit error rates, every m_resolution
+   * dB from m_minSnr
+   */
+  const std::vector<double> & GetTable (WifiMode mode, WifiTxVector txVector) const;
+
+  Ptr<ErrorRateModel> m_model; //!< the sampled error rate model
+  double m_minSnr;             //!< the SNR of the first sample (dB)
+  double m_maxSnr;             //!< the highest SNR sampled (dB)
+  double m_resolution;         //!< the SNR step between the samples (dB)
+  /// the tables, by mode, channel width, guard interval and number of streams
+  mutable std::unordered_map<uint64_t, std::vector<double> > m_tables;
+  mutable uint64_t m_lastKey;                          //!< the key of the last table used
+  mutable const std::vector<double> *m_lastTable;      //!< the last table used
+};
+
+} //namespace ns3
+
+#endif /* INTERPOLATED_ERROR_RATE_MODEL_H */
@@ -2353,10 +2353,10 @@ WifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, MpduType m
 }
 
 void
-WifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet, double rxPowerW, Time rxDuration)
+WifiPhy::StartReceivePreambleAndHeader (Ptr<const Packet> packet, double rxPowerW, Time rxDuration)
 {
   WifiPhyTag tag;
-  bool found = packet->RemovePacketTag (tag);
+  bool found = packet->PeekPacketTag (tag);
   if (!found)
     {
       NS_FATAL_ERROR ("Received Wi-Fi Signal with no WifiPhyTag");
@@ -3613,7 +3613,7 @@ WifiPhy::AbortCurrentReception ()
 }
 
 void
-WifiPhy::StartRx (Ptr<Packet> packet, WifiTxVector txVector, MpduType mpdutype, double rxPowerW, Time rxDuration, Ptr<Event> event)
+WifiPhy::StartRx (Ptr<const Packet> packet, WifiTxVector txVector, MpduType mpdutype, double rxPowerW, Time rxDuration, Ptr<Event> event)
 {
   NS_LOG_FUNCTION (this << packet << txVector << +mpdutype << rxPowerW << rxDuration);
   if (rxPowerW > m_edThresholdW) //checked here, no need to check in the payload reception (current implementation assumes constant rx power over the packet duration)
@@ -3660,10 +3660,15 @@ WifiPhy::StartRx (Ptr<Packet> packet, WifiTxVector txVector, MpduType mpdutype,
         }
 
       NS_LOG_DEBUG ("sync to signal (power=" << rxPowerW << "W)");
+      //the packet may be shared with the other receivers, so only the
+      //packet we sync to is copied, to be handed to the MAC.
+      Ptr<Packet> rxPacket = packet->Copy ();
+      WifiPhyTag tag;
+      rxPacket->RemovePacketTag (tag);
       m_currentEvent = event;
       m_state->SwitchToRx (rxDuration);
       NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
-      NotifyRxBegin (packet);
+      NotifyRxBegin (rxPacket);
       m_interference.NotifyRxStart ();
 
       if (preamble != WIFI_PREAMBLE_NONE)
@@ -3671,12 +3676,12 @@ WifiPhy::StartRx (Ptr<Packet> packet, WifiTxVector txVector, MpduType mpdutype,
           NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
           Time preambleAndHeaderDuration = CalculatePlcpPreambleAndHeaderDuration (txVector);
           m_endPlcpRxEvent = Simulator::Schedule (preambleAndHeaderDuration, &WifiPhy::StartReceivePacket, this,
-                                                  packet, txVector, mpdutype, event);
+                                                  rxPacket, txVector, mpdutype, event);
         }
 
       NS_ASSERT (m_endRxEvent.IsExpired ());
       m_endRxEvent = Simulator::Schedule (rxDuration, &WifiPhy::EndReceive, this,
-                                          packet, preamble, mpdutype, event);
+                                          rxPacket, preamble, mpdutype, event);
     }
   else
     {
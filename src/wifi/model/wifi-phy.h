@@ -22,6 +22,7 @@
 #ifndef WIFI_PHY_H
 #define WIFI_PHY_H
 
+#include <map>
 #include "ns3/event-id.h"
 #include "wifi-mpdu-type.h"
 #include "wifi-phy-standard.h"
@@ -107,11 +108,14 @@ public:
   /**
    * Starting receiving the plcp of a packet (i.e. the first bit of the preamble has arrived).
    *
+   * The packet may be shared with the other receivers of the
+   * transmission: it is only copied if the PHY syncs to it.
+   *
    * \param packet the arriving packet
    * \param rxPowerW the receive power in W
    * \param rxDuration the duration needed for the reception of the packet
    */
-  void StartReceivePreambleAndHeader (Ptr<Packet> packet,
+  void StartReceivePreambleAndHeader (Ptr<const Packet> packet,
                                       double rxPowerW,
                                       Time rxDuration);
 
@@ -1623,7 +1627,7 @@ private:
    * \param rxDuration the duration needed for the reception of the packet
    * \param event the corresponding event of the first time the packet arrives
    */
-  void StartRx (Ptr<Packet> packet,
+  void StartRx (Ptr<const Packet> packet,
                 WifiTxVector txVector,
                 MpduType mpdutype,
                 double rxPowerW,
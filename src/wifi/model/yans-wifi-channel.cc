@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -52,11 +53,24 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "The maximum distance, in meters, of the receivers to which "
+                   "the packets are delivered, or 0 to deliver them to all the "
+                   "receivers. The receivers in range are found through a grid "
+                   "of their positions, which saves the computation of the "
+                   "signals which are too weak to be received: the range "
+                   "must be larger than the reception and interference range "
+                   "of the propagation loss model.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maxRange (0),
+    m_spatialIndex (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -67,6 +81,14 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_spatialIndex.Clear ();
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -87,23 +109,40 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  std::vector<uint32_t> candidates;
+  if (m_maxRange > 0)
+    {
+      m_spatialIndex.SetCellSize (m_maxRange);
+      // the mobility models are only known once the nodes are set up.
+      while (m_spatialIndex.GetN () < m_phyList.size ())
+        {
+          m_spatialIndex.Add (m_phyList[m_spatialIndex.GetN ()]->GetMobility ());
+        }
+      m_spatialIndex.GetCandidates (senderMobility->GetPosition (), m_maxRange, candidates);
+      NS_LOG_LOGIC (candidates.size () << " receivers may be in range out of " << m_phyList.size ());
+    }
+  uint32_t nReceivers = (m_maxRange > 0) ? candidates.size () : m_phyList.size ();
+  for (uint32_t k = 0; k < nReceivers; k++)
     {
-      if (sender != (*i))
+      Ptr<YansWifiPhy> receiver = m_phyList[(m_maxRange > 0) ? candidates[k] : k];
+      if (sender != receiver)
         {
           //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
             {
               continue;
             }
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+          if (m_maxRange > 0 && senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+            {
+              continue;
+            }
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
+          Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
           uint32_t dstNode;
           if (dstNetDevice == 0)
             {
@@ -116,13 +155,13 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+                                          receiver, packet, rxPowerDbm, duration);
         }
     }
 }
 
 void
-YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+YansWifiChannel::Receive (Ptr<YansWifiPhy> phy, Ptr<const Packet> packet, double rxPowerDbm, Time duration)
 {
   NS_LOG_FUNCTION (phy << packet << rxPowerDbm << duration.GetSeconds ());
   phy->StartReceivePreambleAndHeader (packet, DbmToW (rxPowerDbm + phy->GetRxGain ()), duration);
@@ -22,6 +22,7 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/spatial-index.h"
 
 namespace ns3 {
 
@@ -40,6 +41,12 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the MaxRange attribute is set, the channel only delivers the
+ * packets to the YansWifiPhy objects within that distance of the
+ * sender, and finds them through a SpatialIndex of their positions,
+ * so that the cost of a transmission depends on the number of nearby
+ * receivers rather than on the total number of receivers.
  */
 class YansWifiChannel : public Channel
 {
@@ -99,6 +106,8 @@ public:
 
 
 private:
+  virtual void DoDispose (void);
+
   /**
    * A vector of pointers to YansWifiPhy.
    */
@@ -110,15 +119,18 @@ private:
    * bit of the packet has arrived.
    *
    * \param receiver the device to which the packet is destined
-   * \param packet the packet being sent
+   * \param packet the packet being sent, shared by all the receivers
    * \param txPowerDbm the tx power associated to the packet being sent (dBm)
    * \param duration the transmission duration associated with the packet being sent
    */
-  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double txPowerDbm, Time duration);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<const Packet> packet, double txPowerDbm, Time duration);
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxRange;                   //!< Maximum distance of the receivers, or 0 if unlimited
+  /// Positions of the YansWifiPhys, by index in m_phyList
+  mutable SpatialIndex m_spatialIndex;
 };
 
 } //namespace ns3
@@ -22,6 +22,9 @@
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
 #include "ns3/dsss-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/interpolated-error-rate-model.h"
+#include "ns3/wifi-phy.h"
 #include "ns3/wifi-tx-vector.h"
 
 using namespace ns3;
@@ -291,6 +294,87 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Check the success rates of the InterpolatedErrorRateModel
+ * against the ones of the models it wraps.
+ */
+class WifiErrorRateModelsTestCaseInterpolated : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseInterpolated ();
+  virtual ~WifiErrorRateModelsTestCaseInterpolated ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the interpolated success rates of a model.
+   * \param model the analytical model
+   */
+  void CheckModel (Ptr<ErrorRateModel> model);
+};
+
+WifiErrorRateModelsTestCaseInterpolated::WifiErrorRateModelsTestCaseInterpolated ()
+  : TestCase ("WifiErrorRateModel test case interpolated")
+{
+}
+
+WifiErrorRateModelsTestCaseInterpolated::~WifiErrorRateModelsTestCaseInterpolated ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseInterpolated::CheckModel (Ptr<ErrorRateModel> model)
+{
+  Ptr<InterpolatedErrorRateModel> interpolated = CreateObject<InterpolatedErrorRateModel> ();
+  interpolated->SetModel (model);
+
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate18Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate36Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+  modes.push_back (WifiPhy::GetHtMcs7 ());
+  modes.push_back (WifiPhy::GetVhtMcs8 ());
+  uint64_t sizes[] = {1, 800, 12000, 524280};
+
+  for (std::vector<WifiMode>::const_iterator mode = modes.begin (); mode != modes.end (); ++mode)
+    {
+      WifiTxVector txVector;
+      txVector.SetMode (*mode);
+      txVector.SetChannelWidth (mode->GetModulationClass () == WIFI_MOD_CLASS_DSSS
+                                || mode->GetModulationClass () == WIFI_MOD_CLASS_HR_DSSS ? 22 : 20);
+      // the SNRs fall between the samples of the tables
+      for (double snr = -10.0; snr < 45.0; snr += 0.123)
+        {
+          for (uint32_t i = 0; i < 4; i++)
+            {
+              double exact = model->GetChunkSuccessRate (*mode, txVector, std::pow (10.0, snr / 10.0), sizes[i]);
+              double ps = interpolated->GetChunkSuccessRate (*mode, txVector, std::pow (10.0, snr / 10.0), sizes[i]);
+              NS_TEST_ASSERT_MSG_EQ_TOL (ps, exact, 1e-3, "Not equal within tolerance for " << *mode << " at " << snr << " dB");
+            }
+        }
+      // the SNRs out of the tables are passed to the model
+      for (double snr = -40.0; snr < 100.0; snr += 85.0)
+        {
+          double exact = model->GetChunkSuccessRate (*mode, txVector, std::pow (10.0, snr / 10.0), 12000);
+          double ps = interpolated->GetChunkSuccessRate (*mode, txVector, std::pow (10.0, snr / 10.0), 12000);
+          NS_TEST_ASSERT_MSG_EQ (ps, exact, "Not equal for " << *mode << " at " << snr << " dB");
+        }
+    }
+}
+
+void
+WifiErrorRateModelsTestCaseInterpolated::DoRun (void)
+{
+  CheckModel (CreateObject<NistErrorRateModel> ());
+  CheckModel (CreateObject<YansErrorRateModel> ());
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -308,6 +392,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseInterpolated, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
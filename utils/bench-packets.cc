@@ -239,6 +239,37 @@ benchA (uint32_t n)
   NS_ASSERT_MSG (ipv4.IsOk () == true, "IsOk() should be true after deserialization");
 }
 
+/**
+ * Copy a packet which carries three small packet tags several times, as
+ * a shared medium does for its receivers, and remove the headers of the
+ * copies.
+ * \param n The number of packets.
+ */
+static void
+benchATags (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+  BenchTag<4> tag1;
+  BenchTag<8> tag2;
+  BenchTag<12> tag3;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (2000);
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    p->AddPacketTag (tag1);
+    p->AddPacketTag (tag2);
+    p->AddPacketTag (tag3);
+    for (uint32_t j = 0; j < 4; j++) {
+      Ptr<Packet> o = p->Copy ();
+      o->RemoveHeader (ipv4);
+      o->RemoveHeader (udp);
+      o->PeekPacketTag (tag2);
+    }
+  }
+}
+
 static void 
 benchB (uint32_t n)
 {
@@ -310,6 +341,38 @@ benchFragment (uint32_t n)
   }
 }
 
+/**
+ * Add four packet tags of sizes A, B, C and D to a packet, peek at
+ * them in a copy of the packet, and remove them from both packets, as
+ * the LTE and Wi-Fi devices do along the path of a packet.
+ * \param n The number of packets.
+ */
+template <int A, int B, int C, int D>
+static void
+benchPacketTags (uint32_t n)
+{
+  BenchTag<A> tagA;
+  BenchTag<B> tagB;
+  BenchTag<C> tagC;
+  BenchTag<D> tagD;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (2000);
+      p->AddPacketTag (tagA);
+      p->AddPacketTag (tagB);
+      p->AddPacketTag (tagC);
+      p->AddPacketTag (tagD);
+      Ptr<Packet> o = p->Copy ();
+      o->PeekPacketTag (tagA);
+      o->PeekPacketTag (tagD);
+      o->RemovePacketTag (tagB);
+      o->RemovePacketTag (tagC);
+      p->RemovePacketTag (tagD);
+      p->RemovePacketTag (tagA);
+    }
+}
+
 static void
 benchByteTags (uint32_t n)
 {
@@ -362,14 +425,25 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool enableLazyPrinting = false;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("enable-lazy-printing", "enable packet printing, with lazily recorded metadata", enableLazyPrinting);
   cmd.Parse (argc, argv);
 
+  if (enableLazyPrinting)
+    {
+      Packet::EnableLazyPrinting ();
+    }
+  else if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
   if (n == 0)
     {
       std::cerr << "Error-- number of packets must be specified " <<
@@ -380,11 +454,15 @@ int main (int argc, char *argv[])
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
   runBench (&benchA, n, minIterations, "Copy packet, remove headers");
+  runBench (&benchATags, n, minIterations, "Copy packet, remove headers, with 3 packet tags");
   runBench (&benchB, n, minIterations, "Just add headers");
   runBench (&benchC, n, minIterations, "Remove by func call");
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  // the small tags are stored inline, the large ones in the list of TagData.
+  runBench (&benchPacketTags<3, 4, 8, 10>, n, minIterations, "Small packet tags (inline)");
+  runBench (&benchPacketTags<20, 24, 28, 32>, n, minIterations, "Large packet tags (list)");
 
   return 0;
 }
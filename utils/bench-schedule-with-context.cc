@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Stress Simulator::ScheduleWithContext from several threads foreign
+ * to the simulator, as done by the emulation and tap devices, and
+ * report how many cross-thread events per second the simulator takes.
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <list>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/// Number of events processed so far; only touched by the simulator thread.
+uint64_t g_received = 0;
+/// Total number of events to schedule.
+uint64_t g_total = 0;
+
+/// The cross-thread event.
+void
+Receive (void)
+{
+  g_received++;
+}
+
+/**
+ * Keep the simulator busy until all events are received.
+ * The foreign events are merged into the event list between two events.
+ */
+void
+Poll (void)
+{
+  if (g_received < g_total)
+    {
+      Simulator::Schedule (NanoSeconds (1), &Poll);
+    }
+}
+
+/**
+ * The body of a producer thread.
+ * \param events The number of events to schedule.
+ */
+void
+Produce (uint32_t events)
+{
+  for (uint32_t i = 0; i < events; ++i)
+    {
+      Simulator::ScheduleWithContext (i % 16, Time (0), &Receive);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t threads = 4;
+  uint32_t events = 1000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("threads", "number of producer threads (default 4)",     threads);
+  cmd.AddValue ("events",  "number of events per thread (default 1E6)", events);
+  cmd.Parse (argc, argv);
+
+  g_total = static_cast<uint64_t> (threads) * events;
+
+  // create the simulator on this thread, so the producers are foreign.
+  Simulator::Now ();
+  Simulator::Schedule (NanoSeconds (1), &Poll);
+
+  std::list<Ptr<SystemThread> > producers;
+  for (uint32_t i = 0; i < threads; ++i)
+    {
+      producers.push_back (Create<SystemThread> (MakeBoundCallback (&Produce, events)));
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::list<Ptr<SystemThread> >::iterator i = producers.begin (); i != producers.end (); ++i)
+    {
+      (*i)->Start ();
+    }
+  Simulator::Run ();
+  uint64_t ms = time.End ();
+  for (std::list<Ptr<SystemThread> >::iterator i = producers.begin (); i != producers.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  Simulator::Destroy ();
+
+  double seconds = ms / 1000.0;
+  std::cout << "threads: " << threads
+            << ", events: " << g_received
+            << ", wall time: " << std::fixed << std::setprecision (3) << seconds << " s"
+            << ", rate: " << std::setprecision (0)
+            << (seconds > 0 ? g_received / seconds : 0) << " events/s"
+            << std::endl;
+  return (g_received == g_total) ? 0 : 1;
+}